@@ -45,6 +45,7 @@
 
 #include "qucslib.h"
 #include "qucslib_common.h"
+#include "qucslib_index.h"
 #include "librarydialog.h"
 #include "displaydialog.h"
 #include "symbolwidget.h"
@@ -190,13 +191,36 @@ QucsLib::~QucsLib()
 {
 }
 
+// ----------------------------------------------------
+// Refresh the library index: user libraries with full path first, then
+// system libraries with relative path. Returns the number of user libraries.
+static int updateLibraryIndex()
+{
+    QStringList LibPaths;
+
+    // user libraries
+    QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
+    foreach(QString s, UserLibFiles) { // build list with full path
+      s = UserLibDir.absoluteFilePath(s);
+      s.chop(4); // remove extension
+      LibPaths.append(s);
+    }
+
+    // system libraries
+    QStringList SysLibFiles = SysLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
+    foreach(QString s, SysLibFiles) { // build list with relative path
+      s.chop(4);
+      LibPaths.append(s);
+    }
+
+    componentLibraryIndex().update(LibPaths);
+    return UserLibFiles.count();
+}
+
 // ----------------------------------------------------
 // Put all available libraries into ComboBox.
 void QucsLib::putLibrariesIntoCombobox()
 {
-    QList<QPair<QString, bool> > LibFiles;
-    ComponentLibrary parsedlib;
-    QString libPath;
     libInfoStruct lineLibInfo;
     QVariant v;
 
@@ -204,43 +228,33 @@ void QucsLib::putLibrariesIntoCombobox()
     QPixmap sysLibPixmap = QPixmap(":/bitmaps/big.qucs.xpm");
 
     Library->clear();
-    UserLibCount = 0;
-
-    // user libraries
-    QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-    UserLibCount = UserLibFiles.count();
-    foreach(QString s, UserLibFiles) // build list with full path
-      LibFiles.append(qMakePair(UserLibDir.absoluteFilePath(s), false));
+    UserLibCount = updateLibraryIndex();
 
-    // system libraries
-    QStringList SysLibFiles = SysLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-    foreach(QString s, SysLibFiles) // build list with relative path
-      LibFiles.append(qMakePair(s, true));
-
-    for (int i = 0; i < LibFiles.count(); ++i ) {
-      libPath = LibFiles[i].first;
-      libPath.chop(4); // remove extension
-      int result = parseComponentLibrary(libPath, parsedlib, QUCS_COMP_LIB_HEADER_ONLY); // need just the library name
-      switch (result) {
+    QList<IndexedLibrary> const& Libs = componentLibraryIndex().libraries();
+    for (int i = 0; i < Libs.count(); ++i ) {
+      switch (Libs[i].result) {
       case QUCS_COMP_LIB_IO_ERROR:
       {
-        QString filename = getLibAbsPath(LibFiles[i].first);
+        QString filename = getLibAbsPath(Libs[i].libPath);
         QMessageBox::critical(0, tr ("Error"), tr("Cannot open \"%1\".").arg (filename));
         return;
       }
       case QUCS_COMP_LIB_CORRUPT:
-        QMessageBox::critical(0, tr("Error"), tr("Library is corrupt."));
-        return;
+        if (Libs[i].name.isEmpty()) { // the header, else a component is broken
+          QMessageBox::critical(0, tr("Error"), tr("Library is corrupt."));
+          return;
+        }
+        break;
       default:
         break;
       }
 
-      lineLibInfo = libInfoStruct{libPath};
+      lineLibInfo = libInfoStruct{Libs[i].libPath};
       v.setValue(lineLibInfo);
-      if (LibFiles[i].second) { // it's a system library ?
-        Library->addItem(sysLibPixmap, parsedlib.name, v);
+      if (i >= UserLibCount) { // it's a system library ?
+        Library->addItem(sysLibPixmap, Libs[i].name, v);
       } else {
-        Library->addItem(userLibPixmap, parsedlib.name, v);
+        Library->addItem(userLibPixmap, Libs[i].name, v);
       }
     }
     if (UserLibCount > 0) {
@@ -363,8 +377,9 @@ void QucsLib::slotSelectLibrary(int Index)
     v = Library->itemData(Index, Qt::UserRole);
     lineLibInfo = v.value<libInfoStruct>();
 
-    ComponentLibrary parsedlib;
-    int result = parseComponentLibrary (lineLibInfo.libPath, parsedlib);
+    ComponentLibraryPtr Lib = getComponentLibrary (lineLibInfo.libPath);
+    ComponentLibrary const& parsedlib = Lib->library;
+    int result = Lib->result;
 
     switch (result)
     {
@@ -399,8 +414,6 @@ void QucsLib::slotSelectLibrary(int Index)
 // ----------------------------------------------------
 void QucsLib::slotSearchComponent(const QString &searchText)
 {
-  QList<QPair<QString, bool> > LibFiles;
-  QString libPath;
   compInfoStruct lineCompInfo;
   QVariant v;
 
@@ -414,71 +427,25 @@ void QucsLib::slotSearchComponent(const QString &searchText)
     // insert "Search results" at the beginning, so that it is visible
     Library->insertItem(-1, tr("Search results"));
     Library->setCurrentIndex(0);
+    // pick up libraries changed since, once per search
+    updateLibraryIndex();
   }
 
   if(searchText.isEmpty()) {
     return;
   }
 
-  bool findComponent = false;
-
-  // user libraries
-  QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, UserLibFiles) // build list with full path
-    LibFiles.append(qMakePair(UserLibDir.absoluteFilePath(s), false));
-
-  // system libraries
-  QStringList SysLibFiles = SysLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, SysLibFiles) // build list with relative path
-    LibFiles.append(qMakePair(s, true));
-
-  QFile File;
-  QTextStream ReadWhole;
-  QString LibraryString, LibName, CompName;
-  int Start, End, NameStart, NameEnd;
-  for(auto it = LibFiles.begin(); it != LibFiles.end(); it++) { // all library files
-    QString libPath = (*it).first;
-    libPath.chop(4); // remove extension
-    File.setFileName(getLibAbsPath(libPath));
-    if(!File.open(QIODevice::ReadOnly))  continue;
-
-    ReadWhole.setDevice(&File);
-    LibraryString = ReadWhole.readAll();
-    File.close();
-
-    Start = LibraryString.indexOf("<Qucs Library ");
-    if(Start < 0)  continue;
-    End = LibraryString.indexOf('>', Start);
-    if(End < 0)  continue;
-    LibName = LibraryString.mid(Start, End-Start).section('"', 1, 1);
-
-    // check all components of the current library
-    while((Start=LibraryString.indexOf("\n<Component ", Start)) > 0) {
-      Start++;
-      NameStart = Start + 11;
-      NameEnd = LibraryString.indexOf('>', NameStart);
-      if(NameEnd < 0)  continue;
-      CompName = LibraryString.mid(NameStart, NameEnd-NameStart);
-
-      End = LibraryString.indexOf("\n</Component>", NameEnd);
-      if(End < 0)  continue;
-      End += 13;
-
-      // does search criterion match ?
-      if(CompName.indexOf(searchText, 0, Qt::CaseInsensitive) >= 0) {
-        if(!findComponent) {
-	  CompList->clear();
-        }
-        findComponent = true;
-        QListWidgetItem *CompItem = new QListWidgetItem(CompName);
-
-        lineCompInfo = compInfoStruct{LibName, libPath, LibraryString.mid(Start, End-Start)};
-        v.setValue(lineCompInfo);
-        CompItem->setData(Qt::UserRole, v);
-        CompList->addItem(CompItem);
-      }
-      Start = End;
-    }
+  // the definition is looked up when the component is shown
+  QList<ComponentSearchHit> Hits = componentLibraryIndex().search(searchText);
+  foreach(ComponentSearchHit const& Hit, Hits) {
+    QString CompName = Hit.library->components.at(Hit.component).name;
+    QListWidgetItem *CompItem = new QListWidgetItem(CompName);
+
+    lineCompInfo = compInfoStruct{Hit.library->name, Hit.library->libPath, QString()};
+    v.setValue(lineCompInfo);
+    CompItem->setData(Qt::UserRole, v);
+    CompItem->setToolTip(Hit.library->components.at(Hit.component).description);
+    CompList->addItem(CompItem);
   }
 }
 
@@ -509,6 +476,15 @@ void QucsLib::slotShowComponent(QListWidgetItem *Item)
     // get component info
     v = Item->data(Qt::UserRole);
     lineCompInfo = v.value<compInfoStruct>();
+    if (lineCompInfo.compDef.isEmpty()) { // a search result
+      ComponentLibraryPtr Lib = getComponentLibrary (lineCompInfo.libPath);
+      ComponentLibraryItem const* Comp = Lib->find(Item->text());
+      if (!Comp) {
+        QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
+        return;
+      }
+      lineCompInfo.compDef = Comp->definition;
+    }
 
     CompDescr->setText("Name: " + Item->text());
     CompDescr->append("Library: " + lineCompInfo.libName);
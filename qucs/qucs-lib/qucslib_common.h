@@ -20,6 +20,11 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
 #include <QTextStream>
 #include <QDebug>
 
@@ -32,19 +37,24 @@ enum LIB_PARSE_RESULT { QUCS_COMP_LIB_OK,
                         QUCS_COMP_LIB_EMPTY };
 
 enum LIB_PARSE_WHAT { QUCS_COMP_LIB_HEADER_ONLY,
-                      QUCS_COMP_LIB_FULL };
+                      QUCS_COMP_LIB_FULL,
+                      QUCS_COMP_LIB_ALL };  // FULL, also keep the corrupt components
 
 struct ComponentLibraryItem
 {
+    ComponentLibraryItem() : result(QUCS_COMP_LIB_OK) {}
+
     QString name;
     QString definition;
     QString symbol;
     QString modelString;
+    int result;   // LIB_PARSE_RESULT of the model string
 } ;
 
 struct ComponentLibrary
 {
     QString name;
+    QString version;
     QString defaultSymbol;
     QList<ComponentLibraryItem> components;
 } ;
@@ -258,8 +268,9 @@ inline int parseComponentLibrary (QString libPath, ComponentLibrary &library, LI
 
         return QUCS_COMP_LIB_CORRUPT;
     }
-    // Still ok, so try to extract the library name
+    // Still ok, so try to extract the library name and version
     library.name = LibraryString.mid(Start, End-Start).section('"', 1, 1);
+    library.version = LibraryString.mid(Start+14, End-Start-14).section(' ', 0, 0);
     // look for nex opening brace of a tag sequence
     Start = LibraryString.indexOf("\n<", End);
 
@@ -290,6 +301,7 @@ inline int parseComponentLibrary (QString libPath, ComponentLibrary &library, LI
 
     // Now go through the rest of the component library, extracting each
     // component name
+    int firstError = QUCS_COMP_LIB_OK;
     while((Start=LibraryString.indexOf("\n<Component ", Start)) > 0)
     {
         Start++;
@@ -308,15 +320,73 @@ inline int parseComponentLibrary (QString libPath, ComponentLibrary &library, LI
 
         // construct model string
         int result = makeModelString (libPath, component.name, component.definition, component.modelString, library.defaultSymbol);
-        if (result != QUCS_COMP_LIB_OK) return result;
+        if (result != QUCS_COMP_LIB_OK)
+        {
+            if (what != QUCS_COMP_LIB_ALL) return result;
+            // keep the component and go on with the next one
+            component.result = result;
+            if (firstError == QUCS_COMP_LIB_OK) firstError = result;
+        }
 
         library.components.append (component);
 
         Start = End;
     }
 
-    return QUCS_COMP_LIB_OK;
+    return firstError;
+
+}
+
+// a library parsed by parseComponentLibrary() together with an index of
+// its components, as returned by getComponentLibrary()
+struct IndexedComponentLibrary
+{
+    int result;                  // LIB_PARSE_RESULT of the parse
+    ComponentLibrary library;
+    QHash<QString, int> index;   // component name -> library.components
+    QDateTime lastModified;
+    qint64 size;
+
+    ComponentLibraryItem const* find(const QString& compname) const
+    {
+        QHash<QString, int>::const_iterator it = index.constFind(compname);
+        if(it == index.constEnd())  return 0;
+        return &library.components.at(it.value());
+    }
+} ;
+
+typedef QSharedPointer<const IndexedComponentLibrary> ComponentLibraryPtr;
+
+// returns the fully parsed library, parsing the file only if it was not
+// requested before or has changed on disk since. the result is shared
+// by all callers, e.g. every library component of a schematic.
+inline ComponentLibraryPtr getComponentLibrary (QString libPath)
+{
+    static QMutex mutex;
+    static QHash<QString, ComponentLibraryPtr> cache;
+
+    QFileInfo info(getLibAbsPath(libPath));
+    QString key = info.absoluteFilePath();
+    {
+        QMutexLocker lock(&mutex);
+        ComponentLibraryPtr lib = cache.value(key);
+        if(lib && (lib->lastModified == info.lastModified())
+               && (lib->size == info.size()))
+            return lib;
+    }
 
+    IndexedComponentLibrary *lib = new IndexedComponentLibrary;
+    lib->lastModified = info.lastModified();
+    lib->size = info.size();
+    // a corrupt component must not hide the ones after it
+    lib->result = parseComponentLibrary (libPath, lib->library, QUCS_COMP_LIB_ALL);
+    for (int i = lib->library.components.count()-1; i >= 0; i--)
+        lib->index.insert(lib->library.components.at(i).name, i); // first wins
+
+    ComponentLibraryPtr ptr(lib);
+    QMutexLocker lock(&mutex);
+    cache.insert(key, ptr);
+    return ptr;
 }
 
 #endif // _QUCSLIB_COMMON_H_
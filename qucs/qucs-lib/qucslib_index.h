@@ -0,0 +1,314 @@
+/*
+ * qucslib_index.h - persistent search index of the component libraries
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _QUCSLIB_INDEX_H_
+#define _QUCSLIB_INDEX_H_
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QMap>
+#include <QRegExp>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QtAlgorithms>
+
+#include "qucslib_common.h"
+
+// what the index knows about a library component, enough to list and
+// find it without reading the library file
+struct IndexedComponent
+{
+    QString name;
+    QString description;
+    QString modelString;    // as built by makeModelString()
+    QStringList keywords;   // lower case words of description and model
+} ;
+
+struct IndexedLibrary
+{
+    QString libPath;        // as passed to getLibAbsPath()
+    QString name;           // library name from the header
+    int result;             // LIB_PARSE_RESULT of the last parse
+    QDateTime lastModified;
+    qint64 size;
+    QList<IndexedComponent> components;
+} ;
+
+struct ComponentSearchHit
+{
+    const IndexedLibrary *library;
+    int component;          // index into library->components
+} ;
+
+inline QDataStream& operator<<(QDataStream& s, const IndexedComponent& c)
+{
+    return s << c.name << c.description << c.modelString << c.keywords;
+}
+
+inline QDataStream& operator>>(QDataStream& s, IndexedComponent& c)
+{
+    return s >> c.name >> c.description >> c.modelString >> c.keywords;
+}
+
+inline QDataStream& operator<<(QDataStream& s, const IndexedLibrary& l)
+{
+    return s << l.libPath << l.name << qint32(l.result) << l.lastModified
+             << l.size << l.components;
+}
+
+inline QDataStream& operator>>(QDataStream& s, IndexedLibrary& l)
+{
+    qint32 result;
+    s >> l.libPath >> l.name >> result >> l.lastModified
+      >> l.size >> l.components;
+    l.result = result;
+    return s;
+}
+
+// the distinct words of a text, lower case, without pure numbers
+inline QStringList indexKeywords(const QString& text)
+{
+    QSet<QString> words;
+    foreach(QString w, text.toLower().split(QRegExp("[^a-z0-9_]+"),
+                                            QString::SkipEmptyParts))
+        if((w.length() > 1) && w.contains(QRegExp("[a-z]")))
+            words.insert(w);
+    return words.toList();
+}
+
+/*!
+ * an index of the components of all libraries, kept in a file between
+ * sessions. update() stats the library files and reparses only those
+ * whose modification time or size changed, so opening the library
+ * browser or the library dock does not read the libraries at all.
+ *
+ * search() looks up every word of the search text as a substring of the
+ * component names and of the keywords (description and first line of
+ * the model). both are kept in one sorted list of distinct terms, so a
+ * search touches every term once rather than every library file.
+ */
+class ComponentLibraryIndex
+{
+public:
+    ComponentLibraryIndex(const QString& fileName) : FileName(fileName),
+                                                     Loaded(false) {}
+
+    // brings the index up to date for exactly these libraries, in this
+    // order. returns true if anything changed.
+    bool update(const QStringList& libPaths)
+    {
+        if(!Loaded)  load();
+
+        bool changed = (libPaths.count() != Libraries.count());
+        QList<IndexedLibrary> libraries;
+        foreach(QString libPath, libPaths) {
+            QFileInfo info(getLibAbsPath(libPath));
+            int i = indexOf(libPath);
+            if((i >= 0) && (Libraries.at(i).lastModified == info.lastModified())
+                        && (Libraries.at(i).size == info.size())) {
+                if(i != libraries.count())  changed = true;  // reordered
+                libraries.append(Libraries.at(i));
+                continue;
+            }
+            libraries.append(parse(libPath, info));
+            changed = true;
+        }
+        if(!changed)  return false;
+
+        Libraries = libraries;
+        buildTerms();
+        save();
+        return true;
+    }
+
+    const QList<IndexedLibrary>& libraries() const { return Libraries; }
+
+    int indexOf(const QString& libPath) const
+    {
+        for(int i = 0; i < Libraries.count(); i++)
+            if(Libraries.at(i).libPath == libPath)
+                return i;
+        return -1;
+    }
+
+    const IndexedLibrary* library(const QString& libPath) const
+    {
+        int i = indexOf(libPath);
+        return (i < 0) ? 0 : &Libraries.at(i);
+    }
+
+    // components matching all words of the text, those matching by name
+    // first, each group in library order
+    QList<ComponentSearchHit> search(const QString& text) const
+    {
+        QList<ComponentSearchHit> hits;
+        QStringList words = text.toLower().split(' ', QString::SkipEmptyParts);
+        if(words.isEmpty())  return hits;
+
+        QMap<qint64, bool> found;   // component -> matched by name
+        bool first = true;
+        foreach(QString word, words) {
+            QMap<qint64, bool> matches;
+            for(int t = 0; t < Terms.count(); t++) {
+                if(!Terms.at(t).contains(word))  continue;
+                foreach(qint64 key, Postings.at(t)) {
+                    bool byName = NameTerms.contains(key) &&
+                                  NameTerms.value(key) == Terms.at(t);
+                    matches[key] = matches.value(key) || byName;
+                }
+            }
+            if(first) {
+                found = matches;
+                first = false;
+                continue;
+            }
+            QMap<qint64, bool> both;
+            QMap<qint64, bool>::const_iterator it;
+            for(it = found.constBegin(); it != found.constEnd(); ++it)
+                if(matches.contains(it.key()))
+                    both.insert(it.key(), it.value() && matches.value(it.key()));
+            found = both;
+        }
+
+        QList<ComponentSearchHit> others;
+        QMap<qint64, bool>::const_iterator it;
+        for(it = found.constBegin(); it != found.constEnd(); ++it) {
+            ComponentSearchHit hit = { &Libraries.at(int(it.key() >> 32)),
+                                       int(it.key() & 0xffffffff) };
+            if(it.value())  hits.append(hit);
+            else  others.append(hit);
+        }
+        return hits + others;
+    }
+
+private:
+    static const quint32 Magic = 0x51434c49;  // "QCLI"
+    static const qint32 Version = 1;
+
+    static IndexedLibrary parse(const QString& libPath, const QFileInfo& info)
+    {
+        ComponentLibrary parsed;
+        IndexedLibrary lib;
+        lib.libPath = libPath;
+        lib.lastModified = info.lastModified();
+        lib.size = info.size();
+        // corrupt components are still listed, like in the library view
+        lib.result = parseComponentLibrary (libPath, parsed, QUCS_COMP_LIB_ALL);
+        lib.name = parsed.name;
+        foreach(ComponentLibraryItem const& item, parsed.components) {
+            IndexedComponent comp;
+            comp.name = item.name;
+            comp.modelString = item.modelString;
+            QString definition = item.definition, model;
+            getSection("Description", definition, comp.description);
+            getSection("Model", definition, model);
+            comp.keywords = indexKeywords(comp.description + ' ' +
+                                          model.section('\n', 0, 0));
+            lib.components.append(comp);
+        }
+        return lib;
+    }
+
+    void load()
+    {
+        Loaded = true;
+        QFile file(FileName);
+        if(!file.open(QIODevice::ReadOnly))  return;
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_4_6);
+        quint32 magic;
+        qint32 version;
+        stream >> magic >> version;
+        if((magic != Magic) || (version != Version))  return;
+
+        QList<IndexedLibrary> libraries;
+        stream >> libraries;
+        if(stream.status() != QDataStream::Ok)  return;  // rebuilt then
+        Libraries = libraries;
+        buildTerms();
+    }
+
+    // written under another name first, a concurrent reader (qucs and
+    // qucs-lib share the file) sees the old or the new index. the name
+    // is unique per process, so concurrent writers do not collide.
+    void save() const
+    {
+        if(FileName.isEmpty())  return;
+        QString tmpName = FileName + "." +
+            QString::number(QCoreApplication::applicationPid()) + ".new";
+        QFile file(tmpName);
+        if(!file.open(QIODevice::WriteOnly))  return;
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_4_6);
+        stream << Magic << Version << Libraries;
+        file.close();
+        if(stream.status() != QDataStream::Ok) {
+            QFile::remove(tmpName);
+            return;
+        }
+        QFile::remove(FileName);
+        QFile::rename(tmpName, FileName);
+    }
+
+    // term -> components, a component being (library << 32 | number)
+    void buildTerms()
+    {
+        QMap<QString, QVector<qint64> > terms;
+        NameTerms.clear();
+        for(int l = 0; l < Libraries.count(); l++) {
+            QList<IndexedComponent> const& comps = Libraries.at(l).components;
+            for(int c = 0; c < comps.count(); c++) {
+                qint64 key = (qint64(l) << 32) | c;
+                QString name = comps.at(c).name.toLower();
+                NameTerms.insert(key, name);
+                terms[name].append(key);
+                foreach(QString w, comps.at(c).keywords)
+                    if(w != name)  terms[w].append(key);
+            }
+        }
+
+        Terms = terms.keys().toVector();
+        Postings = terms.values().toVector();
+    }
+
+    QString FileName;
+    bool Loaded;
+    QList<IndexedLibrary> Libraries;
+    QVector<QString> Terms;                 // sorted, distinct
+    QVector<QVector<qint64> > Postings;     // components per term
+    QHash<qint64, QString> NameTerms;       // component -> its name term
+};
+
+// the index shared by everything in this process, kept in the user's
+// qucs directory
+inline ComponentLibraryIndex& componentLibraryIndex()
+{
+    static ComponentLibraryIndex index(
+        QucsSettings.QucsHomeDir.absoluteFilePath("complib.idx"));
+    return index;
+}
+
+#endif // _QUCSLIB_INDEX_H_
@@ -0,0 +1,250 @@
+/*
+ * batch.cpp - netlist or print many schematics from the command line
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "batch.h"
+
+#include <stdio.h>
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QTextStream>
+
+// ---------------------------------------------------------------------
+// appends the job(s) of one manifest line.
+bool Batch::parseLine(const QString& line, QList<BatchJob>& jobs,
+                      QString& error)
+{
+  QString Line = line.trimmed();
+  if(Line.isEmpty() || Line.at(0) == '#')  return true;
+
+  QStringList Fields;
+  if(Line.contains('\t'))
+    Fields = Line.split('\t', QString::SkipEmptyParts);
+  else
+    Fields = Line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+  if(Fields.size() != 2) {
+    error = QObject::tr("Expected input and output file: %1").arg(Line);
+    return false;
+  }
+
+  BatchJob Job;
+  Job.Input = Fields.at(0).trimmed();
+  Job.Output = Fields.at(1).trimmed();
+  QFileInfo Info(Job.Input);
+  QString Pattern = Info.fileName();
+  int Star = Pattern.indexOf('*');
+  if(Star < 0) {
+    jobs.append(Job);
+    return true;
+  }
+
+  // expand the wildcard
+  if((Pattern.count('*') != 1) || (Job.Output.count('*') != 1)) {
+    error = QObject::tr("Expected one '*' in input and output: %1").arg(Line);
+    return false;
+  }
+  int Tail = Pattern.length() - Star - 1;
+  QString Dir = Job.Input.left(Job.Input.length() - Pattern.length());
+  QStringList Files = Info.dir().entryList(QStringList(Pattern),
+                                           QDir::Files, QDir::Name);
+  foreach(QString File, Files) {
+    BatchJob J;
+    J.Input = Dir + File;
+    J.Output = Job.Output;
+    J.Output.replace('*', File.mid(Star, File.length() - Star - Tail));
+    jobs.append(J);
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------
+bool Batch::readManifest(const QString& fileName, QList<BatchJob>& jobs,
+                         QString& error)
+{
+  QFile File(fileName);
+  if(!File.open(QIODevice::ReadOnly)) {
+    error = QObject::tr("Cannot open manifest %1").arg(fileName);
+    return false;
+  }
+
+  QTextStream Stream(&File);
+  while(!Stream.atEnd())
+    if(!parseLine(Stream.readLine(), jobs, error))
+      return false;
+  return true;
+}
+
+// ---------------------------------------------------------------------
+// "ok       12 ms  a.sch -> a.net", parsed again by BatchRunner.
+QString Batch::statusLine(bool ok, int msecs, const BatchJob& job)
+{
+  return QString("%1 %2 ms  %3 -> %4\n").arg(ok ? "ok  " : "FAIL")
+         .arg(msecs, 8).arg(job.Input).arg(job.Output);
+}
+
+// ---------------------------------------------------------------------
+BatchRunner::BatchRunner(const QString& program, const QStringList& arguments,
+                         QObject *parent)
+  : QObject(parent), Program(program), Arguments(arguments),
+    Running(0), Failed(0)
+{
+}
+
+// ---------------------------------------------------------------------
+BatchRunner::~BatchRunner()
+{
+  foreach(QProcess *p, Processes) {
+    p->disconnect(this);
+    if(p->state() != QProcess::NotRunning) {
+      p->kill();
+      p->waitForFinished(1000);
+    }
+  }
+  qDeleteAll(Processes);
+}
+
+// ---------------------------------------------------------------------
+// runs all jobs, prints their status lines and returns the number of
+// failed jobs.
+int BatchRunner::run(const QList<BatchJob>& jobs, int workers)
+{
+  Queue = jobs;
+  Failed = 0;
+  if(workers > Queue.size())  workers = Queue.size();
+
+  for(int i=0; i<workers; i++) {
+    QProcess *p = new QProcess();
+    connect(p, SIGNAL(readyReadStandardOutput()), SLOT(slotReadOutput()));
+    connect(p, SIGNAL(readyReadStandardError()), SLOT(slotReadError()));
+    connect(p, SIGNAL(finished(int, QProcess::ExitStatus)),
+               SLOT(slotFinished(int, QProcess::ExitStatus)));
+    connect(p, SIGNAL(error(QProcess::ProcessError)),
+               SLOT(slotError(QProcess::ProcessError)));
+    Processes.append(p);
+    Pending.append(QList<BatchJob>());
+    Running++;
+    p->start(Program, Arguments);
+
+    // two jobs each, so that no worker waits for its next one
+    feed(p);
+    feed(p);
+  }
+
+  QEventLoop Loop;
+  while(Running > 0)
+    Loop.processEvents(QEventLoop::WaitForMoreEvents);
+  return Failed;
+}
+
+// ---------------------------------------------------------------------
+// sends the next job to a worker, or tells it there is none left.
+void BatchRunner::feed(QProcess *p)
+{
+  if(p->state() == QProcess::NotRunning)  return;
+  if(Queue.isEmpty()) {
+    p->closeWriteChannel();
+    return;
+  }
+
+  BatchJob Job = Queue.takeFirst();
+  Pending[Processes.indexOf(p)].append(Job);
+  p->write((Job.Input + '\t' + Job.Output + '\n').toLocal8Bit());
+}
+
+// ---------------------------------------------------------------------
+// passes the status lines of a worker on and sends it the next jobs.
+void BatchRunner::readOutput(QProcess *p)
+{
+  QList<BatchJob>& Jobs = Pending[Processes.indexOf(p)];
+  while(p->canReadLine()) {
+    QByteArray Line = p->readLine();
+    fputs(Line.constData(), stdout);
+    if(Line.startsWith("FAIL"))  Failed++;
+    else if(!Line.startsWith("ok"))  continue;
+
+    if(!Jobs.isEmpty())  Jobs.removeFirst();
+    feed(p);
+  }
+  fflush(stdout);
+}
+
+// ---------------------------------------------------------------------
+void BatchRunner::slotReadOutput()
+{
+  QProcess *p = qobject_cast<QProcess*>(sender());
+  if(p)  readOutput(p);
+}
+
+// ---------------------------------------------------------------------
+void BatchRunner::slotReadError()
+{
+  QProcess *p = qobject_cast<QProcess*>(sender());
+  if(p)
+    fputs(p->readAllStandardError().constData(), stderr);
+}
+
+// ---------------------------------------------------------------------
+void BatchRunner::slotFinished(int, QProcess::ExitStatus)
+{
+  QProcess *p = qobject_cast<QProcess*>(sender());
+  if(p)  done(p);
+}
+
+// ---------------------------------------------------------------------
+// a process that failed to start never emits finished().
+void BatchRunner::slotError(QProcess::ProcessError error)
+{
+  QProcess *p = qobject_cast<QProcess*>(sender());
+  if(p && (error == QProcess::FailedToStart)) {
+    fprintf(stderr, "Error: Cannot start %s\n", Program.toLocal8Bit().data());
+    done(p);
+  }
+}
+
+// ---------------------------------------------------------------------
+// jobs a worker did not report on, e.g. because it crashed, failed.
+void BatchRunner::done(QProcess *p)
+{
+  readOutput(p);
+  QList<BatchJob>& Jobs = Pending[Processes.indexOf(p)];
+  foreach(BatchJob const& Job, Jobs) {
+    fputs(Batch::statusLine(false, 0, Job).toLocal8Bit().data(), stdout);
+    Failed++;
+  }
+  Jobs.clear();
+  fflush(stdout);
+
+  // the jobs not sent yet are left to the other workers, if any
+  Running--;
+  if(Running == 0 && !Queue.isEmpty()) {
+    foreach(BatchJob const& Job, Queue) {
+      fputs(Batch::statusLine(false, 0, Job).toLocal8Bit().data(), stdout);
+      Failed++;
+    }
+    Queue.clear();
+  }
+}
+
+// vim:ts=8:sw=2:et
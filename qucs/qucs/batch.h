@@ -0,0 +1,87 @@
+/*
+ * batch.h - netlist or print many schematics from the command line
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_ value
+
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+struct BatchJob {
+  QString Input, Output;
+};
+
+/*!
+ * reads the list of files for batch mode. every line of a manifest
+ * names an input schematic and an output file, separated by a tab or,
+ * if there is no tab, by blanks. empty lines and lines starting with
+ * '#' are skipped. an input file name may contain one '*', matching any
+ * files in its directory. the '*' of the output is then replaced by what
+ * it matched, e.g. "rc/rc*.sch  out/rc*.net".
+ */
+class Batch {
+public:
+  static bool readManifest(const QString& fileName, QList<BatchJob>& jobs,
+                           QString& error);
+  static bool parseLine(const QString& line, QList<BatchJob>& jobs,
+                        QString& error);
+  static QString statusLine(bool ok, int msecs, const BatchJob& job);
+};
+
+/*!
+ * distributes batch jobs over several worker processes, each one being
+ * this program reading its jobs from standard input ("--batch -") and
+ * answering with a statusLine() per job. a worker gets its next job as
+ * soon as it reported one, so slow files do not hold up the others.
+ */
+class BatchRunner : public QObject {
+Q_OBJECT
+public:
+  BatchRunner(const QString& program, const QStringList& arguments,
+              QObject *parent=0);
+ ~BatchRunner();
+
+  int run(const QList<BatchJob>& jobs, int workers);
+
+private slots:
+  void slotReadOutput();
+  void slotReadError();
+  void slotFinished(int, QProcess::ExitStatus);
+  void slotError(QProcess::ProcessError);
+
+private:
+  void feed(QProcess*);
+  void readOutput(QProcess*);
+  void done(QProcess*);
+
+  QString Program;
+  QStringList Arguments;
+  QList<BatchJob> Queue;
+  QList<QProcess*> Processes;
+  QList<QList<BatchJob> > Pending;  // sent to a worker, not yet reported
+  int Running, Failed;
+};
+
+#endif
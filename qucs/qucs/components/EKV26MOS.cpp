@@ -270,24 +270,24 @@ void EKV26MOS::createSymbol()
   x2 =  20; y2 =  30;
 }
 
-QString EKV26MOS::netlist()
+void EKV26MOS::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output type npn/pnp property
   Property *p2 = Props.first();
   if(p2->Value == "nmos")
-    s += " nmos=\"1\"";
+    s << " nmos=\"1\"";
   else
-    s += " pmos=\"1\"";
+    s << " pmos=\"1\"";
 
   // output all remaining properties
   for(p2 = Props.next(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
@@ -91,18 +91,18 @@ void BJT::createSymbol()
 }
 
 // -------------------------------------------------------
-QString BJT::netlist()
+void BJT::netlist(QTextStream& s)
 {
-  QString s = "BJT:"+Name;
+  s << "BJT:" << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
-  s += " "+Ports.at(1)->Connection->Name;  // connect substrate to collector
+    s << ' ' << p1->Connection->Name;   // node names
+  s << ' ' << Ports.at(1)->Connection->Name;  // connect substrate to collector
 
   // output all properties
   for(Property *p2 = Props.first(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
@@ -31,7 +31,7 @@ public:
 
 protected:
   void createSymbol();
-  QString netlist();
+  void netlist(QTextStream&);
 };
 
 #endif
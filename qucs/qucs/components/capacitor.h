@@ -26,6 +26,9 @@ public:
   Capacitor();
  ~Capacitor() {};
   Component* newOne();
+  // the symbol only depends on the "Symbol" property
+  QByteArray symbolKey()
+    { return Component::symbolKey() + Props.getLast()->Value.toUtf8(); }
   static Element* info(QString&, char* &, bool getNewOne=false);
 
 protected:
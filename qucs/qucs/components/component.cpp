@@ -28,6 +28,9 @@
 
 #include <QPen>
 #include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QMessageBox>
 #include <QPainter>
 #include <QDebug>
@@ -51,6 +54,7 @@ Component::Component()
   isSelected = false;
   isActive = COMP_IS_ACTIVE;
   showName = true;
+  sharedSymbol = 0;
 
   cx = 0;
   cy = 0;
@@ -62,6 +66,12 @@ Component::Component()
   containingSchematic = NULL;
 }
 
+// -------------------------------------------------------
+Component::~Component()
+{
+  releaseSymbol();
+}
+
 // -------------------------------------------------------
 Component* Component::newOne()
 {
@@ -392,6 +402,8 @@ void Component::rotate()
     if(Ports.count() < 1) return;  // do not rotate components without ports
   int tmp, dx, dy;
 
+  detachSymbol();
+
   // rotate all lines
   foreach(Line *p1, Lines) {
     tmp = -p1->x1;
@@ -483,6 +495,174 @@ void Component::rotate()
   rotated &= 3;
 }
 
+// -------------------------------------------------------
+// Immutable symbol geometry, shared by all components that look alike.
+struct SymbolGeometry {
+  QByteArray  Key;
+  int         Refs;   // number of components using it
+  QList<Line *>        Lines;
+  QList<struct Arc *>  Arcs;
+  QList<Area *>        Rects;
+  QList<Area *>        Ellips;
+};
+
+static QMutex SymbolMutex;
+static QHash<QByteArray, SymbolGeometry*> SymbolCache;
+
+static void appendKey(QByteArray& Key, int i)
+{
+  Key.append((const char*)&i, sizeof(int));
+}
+
+static void appendKey(QByteArray& Key, const QPen& Pen)
+{
+  appendKey(Key, int(Pen.color().rgba()));
+  appendKey(Key, Pen.width());
+  appendKey(Key, int(Pen.style()));
+}
+
+static void appendKey(QByteArray& Key, const QBrush& Brush)
+{
+  appendKey(Key, int(Brush.color().rgba()));
+  appendKey(Key, int(Brush.style()));
+}
+
+static void appendKey(QByteArray& Key, const QString& s)
+{
+  Key.append(s.toUtf8());
+  Key.append('\0');
+}
+
+/*!
+ * Returns what the symbol of this component is made of before rotating
+ * and mirroring: the model and the font (some symbols measure their
+ * labels). Components that build their symbol from their properties
+ * add those (see MultiViewComponent), components that read it from a
+ * file return an empty key.
+ */
+QByteArray Component::symbolKey()
+{
+  QByteArray Key;
+  appendKey(Key, Model);
+  appendKey(Key, QucsSettings.font.toString());
+  return Key;
+}
+
+/*!
+ * Replaces the lines, arcs, rectangles and ellipses of this component
+ * by those of an identical symbol loaded before, so that e.g. thousands
+ * of resistors keep only one copy of their geometry. The cache is looked
+ * up by symbolKey(), thus without comparing the geometry; only symbols
+ * read from files are compared line by line. An entry lives as long as
+ * components use it.
+ */
+void Component::shareSymbol()
+{
+  if(sharedSymbol)  return;
+
+  QByteArray Key = symbolKey();
+  if(Key.isEmpty()) {
+    Key.append('G');
+    appendKey(Key, Lines.count());
+    foreach(Line *p1, Lines) {
+      appendKey(Key, p1->x1);  appendKey(Key, p1->y1);
+      appendKey(Key, p1->x2);  appendKey(Key, p1->y2);
+      appendKey(Key, p1->style);
+    }
+    appendKey(Key, Arcs.count());
+    foreach(Arc *p3, Arcs) {
+      appendKey(Key, p3->x);  appendKey(Key, p3->y);
+      appendKey(Key, p3->w);  appendKey(Key, p3->h);
+      appendKey(Key, p3->angle);  appendKey(Key, p3->arclen);
+      appendKey(Key, p3->style);
+    }
+    appendKey(Key, Rects.count());
+    foreach(Area *pa, Rects) {
+      appendKey(Key, pa->x);  appendKey(Key, pa->y);
+      appendKey(Key, pa->w);  appendKey(Key, pa->h);
+      appendKey(Key, pa->Pen);  appendKey(Key, pa->Brush);
+    }
+    appendKey(Key, Ellips.count());
+    foreach(Area *pa, Ellips) {
+      appendKey(Key, pa->x);  appendKey(Key, pa->y);
+      appendKey(Key, pa->w);  appendKey(Key, pa->h);
+      appendKey(Key, pa->Pen);  appendKey(Key, pa->Brush);
+    }
+  }
+  else {
+    Key.prepend('M');
+    appendKey(Key, int(mirroredX));
+    appendKey(Key, rotated);
+  }
+
+  QMutexLocker lock(&SymbolMutex);
+  SymbolGeometry *pg = SymbolCache.value(Key);
+  if(!pg) {   // first of its kind, its geometry becomes the shared one
+    pg = new SymbolGeometry;
+    pg->Key    = Key;
+    pg->Refs   = 0;
+    pg->Lines  = Lines;
+    pg->Arcs   = Arcs;
+    pg->Rects  = Rects;
+    pg->Ellips = Ellips;
+    SymbolCache.insert(Key, pg);
+  }
+  else {
+    qDeleteAll(Lines);
+    qDeleteAll(Arcs);
+    qDeleteAll(Rects);
+    qDeleteAll(Ellips);
+    Lines  = pg->Lines;
+    Arcs   = pg->Arcs;
+    Rects  = pg->Rects;
+    Ellips = pg->Ellips;
+  }
+  pg->Refs++;
+  sharedSymbol = pg;
+}
+
+// -------------------------------------------------------
+// Gives the component its own copy of a shared symbol before changing it.
+void Component::detachSymbol()
+{
+  if(!sharedSymbol)  return;
+
+  QList<Line *> L;
+  foreach(Line *p1, Lines)  L.append(new Line(*p1));
+  QList<struct Arc *> A;
+  foreach(Arc *p3, Arcs)  A.append(new Arc(*p3));
+  QList<Area *> R;
+  foreach(Area *pa, Rects)  R.append(new Area(*pa));
+  QList<Area *> E;
+  foreach(Area *pa, Ellips)  E.append(new Area(*pa));
+
+  releaseSymbol();
+  Lines  = L;
+  Arcs   = A;
+  Rects  = R;
+  Ellips = E;
+}
+
+// -------------------------------------------------------
+// Stops using the shared symbol, the last user deletes it. The lists
+// still point to it and must be replaced or cleared by the caller.
+void Component::releaseSymbol()
+{
+  if(!sharedSymbol)  return;
+
+  QMutexLocker lock(&SymbolMutex);
+  SymbolGeometry *pg = sharedSymbol;
+  sharedSymbol = 0;
+  if(--pg->Refs > 0)  return;
+
+  SymbolCache.remove(pg->Key);
+  qDeleteAll(pg->Lines);
+  qDeleteAll(pg->Arcs);
+  qDeleteAll(pg->Rects);
+  qDeleteAll(pg->Ellips);
+  delete pg;
+}
+
 // -------------------------------------------------------
 // Mirrors the component about the x-axis.
 void Component::mirrorX()
@@ -491,6 +671,8 @@ void Component::mirrorX()
   if ((Model != "Sub") && (Model !="VHDL") && (Model != "Verilog")) // skip port count
     if(Ports.count() < 1) return;  // do not rotate components without ports
 
+  detachSymbol();
+
   // mirror all lines
   foreach(Line *p1, Lines) {
     p1->y1 = -p1->y1;
@@ -553,6 +735,8 @@ void Component::mirrorY()
   if ((Model != "Sub") && (Model !="VHDL") && (Model != "Verilog")) // skip port count
     if(Ports.count() < 1) return;  // do not rotate components without ports
 
+  detachSymbol();
+
   // mirror all lines
   foreach(Line *p1, Lines) {
     p1->x1 = -p1->x1;
@@ -612,42 +796,70 @@ void Component::mirrorY()
 }
 
 // -------------------------------------------------------
-QString Component::netlist()
+void Component::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
-  int i=-1;
+  s << Model << ':' << Name;
   // output all node names
   // This only works in cases where the resistor would be a series
   // with the component, as for the other components, they're accounted
   // as a resistor as well, and the changes were made to their .cpp
-  foreach(Port *p1, Ports){
-    i++;
-    s += " " + p1->Connection->Name;   // node names
-  }
+  foreach(Port *p1, Ports)
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output all properties
   for (Property *p2 = Props.first(); p2 != 0; p2 = Props.next()){
     if (p2->Name != "Symbol"){
-      s += " " + p2->Name + "=\"" + p2->Value + "\"";
+      s << ' ' << p2->Name << "=\"" << p2->Value << '"';
     }else{
       // BUG: what is this?
       // doing name dependent stuff
     }
   }
 
-  s += '\n';
+  s << '\n';
+}
 
+// -------------------------------------------------------
+QString Component::getNetlist()
+{
+  QString s;
+  QTextStream stream(&s);
+  getNetlist(stream);
   return s;
 }
 
 // -------------------------------------------------------
-QString Component::getNetlist()
+void Component::getNetlist(QTextStream& s)
 {
   switch(isActive) {
     case COMP_IS_ACTIVE:
-      return netlist();
+      if(Model.at(0) == '.') {  // simulations may create files (ASCO)
+        netlist(s);
+        return;
+      }
+      if(!NetlistCache.isNull() && NetlistNodes.count() == Ports.count()) {
+        int i = 0;
+        foreach(Port *pp, Ports)
+          if(pp->Connection->Name != NetlistNodes.at(i++)) {
+            NetlistCache = QString();   // node names changed
+            break;
+          }
+      }
+      else NetlistCache = QString();
+
+      if(NetlistCache.isNull()) {
+        NetlistCache = "";
+        QTextStream str(&NetlistCache);
+        netlist(str);
+        str.flush();
+        NetlistNodes.clear();
+        foreach(Port *pp, Ports)
+          NetlistNodes.append(pp->Connection->Name);
+      }
+      s << NetlistCache;
+      return;
     case COMP_IS_OPEN:
-      return QString("");
+      return;
   }
 
   // Component is shortened.
@@ -655,11 +867,9 @@ QString Component::getNetlist()
   QListIterator<Port *> iport(Ports);
   Port *pp = iport.next();
   QString Node1 = pp->Connection->Name;
-  QString s = "";
   while (iport.hasNext())
-    s += "R:" + Name + "." + QString::number(z++) + " " +
-      Node1 + " " + iport.next()->Connection->Name + " R=\"0\"\n";
-  return s;
+    s << "R:" << Name << '.' << z++ << ' ' << Node1 << ' '
+      << iport.next()->Connection->Name << " R=\"0\"\n";
 }
 
 // -------------------------------------------------------
@@ -1291,6 +1501,12 @@ void Component::copyComponent(Component *pc)
 
   Props  = pc->Props;
   Ports  = pc->Ports;
+  releaseSymbol();
+  sharedSymbol = pc->sharedSymbol;
+  if(sharedSymbol) {
+    QMutexLocker lock(&SymbolMutex);
+    sharedSymbol->Refs++;
+  }
   Lines  = pc->Lines;
   Arcs   = pc->Arcs;
   Rects  = pc->Rects;
@@ -1311,6 +1527,7 @@ void MultiViewComponent::recreate(Schematic *Doc)
     Doc->deleteComp(this);
   }
 
+  releaseSymbol();
   Ellips.clear();
   Texts.clear();
   Ports.clear();
@@ -1339,6 +1556,16 @@ void MultiViewComponent::recreate(Schematic *Doc)
   }
 }
 
+// -------------------------------------------------------
+// The symbol may depend on any property, subclasses know better.
+QByteArray MultiViewComponent::symbolKey()
+{
+  QByteArray Key = Component::symbolKey();
+  for(Property *pp = Props.first(); pp != 0; pp = Props.next())
+    appendKey(Key, pp->Value);
+  return Key;
+}
+
 
 // ***********************************************************************
 // ********                                                       ********
@@ -1366,22 +1593,21 @@ GateComponent::GateComponent()
 }
 
 // -------------------------------------------------------
-QString GateComponent::netlist()
+void GateComponent::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *pp, Ports)
-    s += " "+pp->Connection->Name;   // node names
+    s << ' ' << pp->Connection->Name;   // node names
 
   // output all properties
   Property *p = Props.at(1);
-  s += " " + p->Name + "=\"" + p->Value + "\"";
+  s << ' ' << p->Name << "=\"" << p->Value << '"';
   p = Props.next();
-  s += " " + p->Name + "=\"" + p->Value + "\"";
+  s << ' ' << p->Name << "=\"" << p->Value << '"';
   p = Props.next();
-  s += " " + p->Name + "=\"" + p->Value + "\"\n";
-  return s;
+  s << ' ' << p->Name << "=\"" << p->Value << "\"\n";
 }
 
 // -------------------------------------------------------
@@ -1666,6 +1892,7 @@ Component* getComponentFromName(QString& Line, Schematic* p)
   c->recreate(0);
   c->obsolete_name_override_hack(cstr);
   c->tx = x;  c->ty = y;
+  c->shareSymbol();
   return c;
 }
 
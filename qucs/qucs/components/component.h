@@ -19,6 +19,8 @@
 #define COMPONENT_H
 
 #include <Q3PtrList>
+#include <QStringList>
+#include <QTextStream>
 
 #include "element.h"
 
@@ -31,11 +33,13 @@ class ComponentDialog;
 class Component : public Element {
 public:
   Component();
-  virtual ~Component() {};
+  virtual ~Component();
 
   virtual Component* newOne();
   virtual void recreate(Schematic*) {};
   QString getNetlist();
+  void getNetlist(QTextStream&);
+  void invalidateNetlist() { NetlistCache = QString(); }
   QString get_VHDL_Code(int);
   QString get_Verilog_Code(int);
   void    paint(ViewPainter*);
@@ -52,6 +56,11 @@ public:
   void    mirrorX();  // mirror about X axis
   void    mirrorY();  // mirror about Y axis
   bool    load(const QString&);
+  void    shareSymbol();
+  void    detachSymbol();
+  // names the symbol drawn by the constructor resp. createSymbol(), empty
+  // if it is read from a file and thus only known by its geometry
+  virtual QByteArray symbolKey();
 
   // to hold track of the component appearance for saving and copying
   bool mirroredX;   // is it mirrored about X axis or not
@@ -71,6 +80,9 @@ public:
   QList<Port *>     Ports;
   QList<Text *>     Texts;
   Q3PtrList<Property> Props;
+  // Lines, Arcs, Rects and Ellips are shared with other components with
+  // the same symbol and must not be changed without detachSymbol()
+  struct SymbolGeometry *sharedSymbol;
 
   #define COMP_IS_OPEN    0
   #define COMP_IS_ACTIVE  1
@@ -113,7 +125,7 @@ protected: // BUG => Element.
 protected: // BUG
   QString  Description;
 protected:
-  virtual QString netlist();
+  virtual void netlist(QTextStream&);
   virtual QString vhdlCode(int);
   virtual QString verilogCode(int);
 
@@ -124,8 +136,15 @@ protected:
   bool getBrush(const QString&, QBrush&, int);
 
   void copyComponent(Component*);
+  void releaseSymbol();
   Property * getProperty(const QString&);
   Schematic* containingSchematic;
+
+private:
+  // netlist of the last run and the node names it was made for, to be
+  // used again unless invalidateNetlist() was called in between
+  QString NetlistCache;
+  QStringList NetlistNodes;
 };
 
 
@@ -135,6 +154,7 @@ public:
   virtual ~MultiViewComponent() {};
 
   void recreate(Schematic*);
+  QByteArray symbolKey();
 
 protected:
   virtual void createSymbol() {};
@@ -144,7 +164,7 @@ protected:
 class GateComponent : public MultiViewComponent {
 public:
   GateComponent();
-  QString netlist();
+  void netlist(QTextStream&);
   QString vhdlCode(int);
   QString verilogCode(int);
 
@@ -1037,6 +1037,7 @@ void ComponentDialog::slotApplyInput()
  } // end if (item !=0)
 
   if(changed) {
+    Comp->invalidateNetlist();
     int dx, dy;
     Comp->textSize(dx, dy);
     if(tx_Dist != 0) {
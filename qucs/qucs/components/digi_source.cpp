@@ -80,23 +80,21 @@ Element* Digi_Source::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString Digi_Source::netlist()
+void Digi_Source::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output node names
-  s += " "+Ports.first()->Connection->Name;
-  
+  s << ' ' << Ports.first()->Connection->Name;
+
   // output all properties
   Props.first();   // first property not needed
   Property *pp = Props.next();
-  s += " "+pp->Name+"=\""+pp->Value+"\"";
+  s << ' ' << pp->Name << "=\"" << pp->Value << '"';
   pp = Props.next();
-  s += " "+pp->Name+"=\"["+pp->Value+"]\"";
+  s << ' ' << pp->Name << "=\"[" << pp->Value << "]\"";
   pp = Props.next();
-  s += " "+pp->Name+"=\""+pp->Value+"\"\n";
-
-  return s;
+  s << ' ' << pp->Name << "=\"" << pp->Value << "\"\n";
 }
 
 // -------------------------------------------------------
@@ -29,7 +29,7 @@ public:
   static Element* info(QString&, char* &, bool getNewOne=false);
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   QString vhdlCode(int);
   QString verilogCode(int);
 };
@@ -90,18 +90,18 @@ Element* ecvs::info(QString& Name, char* &BitmapFile, bool getNewOne)
 
 
 // -------------------------------------------------------
-QString ecvs::netlist()
+void ecvs::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output all properties
   for(Property *p2 = Props.first(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + "\n";
+  s << '\n';
 }
 
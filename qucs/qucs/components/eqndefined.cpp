@@ -69,25 +69,24 @@ Element* EqnDefined::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString EqnDefined::netlist()
+void EqnDefined::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
-  QString e = "\n";
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output all properties
-  Property *p2 = Props.at(2);
-  while(p2) {
-    s += " "+p2->Name+"=\""+Name+"."+p2->Name+"\"";
-    e += "  Eqn:Eqn"+Name+p2->Name+" "+
-      Name+"."+p2->Name+"=\""+p2->Value+"\" Export=\"no\"\n";
-    p2 = Props.next();
-  }
-
-  return s+e;
+  Property *p2;
+  for(p2 = Props.at(2); p2 != 0; p2 = Props.next())
+    s << ' ' << p2->Name << "=\"" << Name << '.' << p2->Name << '"';
+  s << '\n';
+
+  // output the equations
+  for(p2 = Props.at(2); p2 != 0; p2 = Props.next())
+    s << "  Eqn:Eqn" << Name << p2->Name << ' ' << Name << '.' << p2->Name
+      << "=\"" << p2->Value << "\" Export=\"no\"\n";
 }
 
 // -------------------------------------------------------
@@ -61,7 +61,6 @@ Element* Ground::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString Ground::netlist()
+void Ground::netlist(QTextStream&)
 {
-  return QString("");
 }
@@ -27,6 +27,8 @@
 #include <QRegExp>
 #include <QDebug>
 
+#include "../../qucs-lib/qucslib_common.h"
+
 LibComp::LibComp()
 {
   Type = isComponent;   // both analog and digital
@@ -81,52 +83,36 @@ void LibComp::createSymbol()
 
 // ---------------------------------------------------------------------
 // Loads the section with name "Name" from library file into "Section".
+// The library is parsed only once and shared by all library components,
+// see getComponentLibrary().
 int LibComp::loadSection(const QString& Name, QString& Section,
 			 QStringList *Includes)
 {
-  QDir Directory(QucsSettings.LibDir);
-  QFile file(Directory.absoluteFilePath(Props.first()->Value + ".lib"));
-  if(!file.open(QIODevice::ReadOnly))
+  ComponentLibraryPtr Lib = getComponentLibrary(Props.first()->Value);
+  if(Lib->result == QUCS_COMP_LIB_IO_ERROR)
     return -1;
-
-  QString libDefaultSymbol;
-
-  QTextStream ReadWhole(&file);
-  Section = ReadWhole.readAll();
-  file.close();
-
-
-  if(Section.left(14) != "<Qucs Library ")  // wrong file type ?
+  // a component whose model string is corrupt does not matter here, its
+  // definition is still there (see ComponentLibraryItem::result)
+  if(Lib->library.version.isEmpty())  // wrong file type ?
     return -2;
 
-  int Start, End = Section.indexOf(' ', 14);
-  if(End < 15) return -3;
-  QString Line = Section.mid(14, End-14); // extract version string
-  VersionTriplet LibVersion = VersionTriplet(Line);
+  VersionTriplet LibVersion = VersionTriplet(Lib->library.version);
   if (LibVersion > QucsVersion) // wrong version number ?
     return -3;
 
-  if(Name == "Symbol") {
-    Start = Section.indexOf("\n<", 14); // library has default symbol
-    if(Start > 0)
-      if(Section.mid(Start+2, 14) == "DefaultSymbol>") {
-        Start += 16;
-        End = Section.indexOf("\n</DefaultSymbol>", Start);
-        if(End < 0)  return -9;
-        libDefaultSymbol = Section.mid(Start, End-Start);
-      }
-  }
+  QString libDefaultSymbol;
+  if(Name == "Symbol")  // library has default symbol ?
+    libDefaultSymbol = Lib->library.defaultSymbol;
 
   // search component
-  Line = "\n<Component " + Props.next()->Value + ">";
-  Start = Section.indexOf(Line);
-  if(Start < 0)  return -4;  // component not found
-  Start = Section.indexOf('\n', Start);
+  ComponentLibraryItem const* Item = Lib->find(Props.next()->Value);
+  if(!Item)  return -4;  // component not found
+  int Start = Item->definition.indexOf('\n');
   if(Start < 0)  return -5;  // file corrupt
   Start++;
-  End = Section.indexOf("\n</Component>", Start);
+  int End = Item->definition.lastIndexOf("\n</Component>");
   if(End < 0)  return -6;  // file corrupt
-  Section = Section.mid(Start, End-Start+1);
+  Section = Item->definition.mid(Start, End-Start+1);
   
   // search model includes
   if(Includes) {
@@ -250,17 +236,9 @@ bool LibComp::createSubNetlist(QTextStream *stream, QStringList &FileList,
     if(FileList.indexOf(s) >= 0) continue;
     FileList.append(s);
 
-    // load file and stuff into stream
-    QFile file(s);
-    if(!file.open(QIODevice::ReadOnly)) {
+    // pass file through into stream
+    if(!misc::streamFile(*stream, s))
       error++;
-    } else {
-      QByteArray FileContent = file.readAll();
-      file.close();
-      //?stream->writeRawBytes(FileContent.value(), FileContent.size());
-      (*stream) << FileContent.data();
-      qDebug() << "hi from libcomp";
-    }
   }
 
   (*stream) << "\n" << FileString << "\n";
@@ -275,22 +253,22 @@ QString LibComp::createType()
 }
 
 // -------------------------------------------------------
-QString LibComp::netlist()
+void LibComp::netlist(QTextStream& s)
 {
-  QString s = "Sub:"+Name;   // output as subcircuit
+  s << "Sub:" << Name;   // output as subcircuit
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output property
-  s += " Type=\""+createType()+"\"";   // type for subcircuit
+  s << " Type=\"" << createType() << '"';   // type for subcircuit
 
   // output user defined parameters
   for(Property *pp = Props.at(2); pp != 0; pp = Props.next())
-    s += " "+pp->Name+"=\""+pp->Value+"\"";
+    s << ' ' << pp->Name << "=\"" << pp->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
 
 // -------------------------------------------------------
@@ -32,9 +32,10 @@ public:
 
   bool createSubNetlist(QTextStream *, QStringList&, int type=1);
   QString getSubcircuitFile();
+  QByteArray symbolKey() { return QByteArray(); }  // read from file
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   QString vhdlCode(int);
   QString verilogCode(int);
   void createSymbol();
@@ -120,18 +120,18 @@ void MOSFET::createSymbol()
 }
 
 // -------------------------------------------------------
-QString MOSFET::netlist()
+void MOSFET::netlist(QTextStream& s)
 {
-  QString s = "MOSFET:"+Name;
+  s << "MOSFET:" << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
-  s += " "+Ports.at(2)->Connection->Name;  // connect substrate to source
+    s << ' ' << p1->Connection->Name;   // node names
+  s << ' ' << Ports.at(2)->Connection->Name;  // connect substrate to source
 
   // output all properties
   for(Property *p2 = Props.first(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
@@ -32,7 +32,7 @@ public:
 
 protected:
   void createSymbol();
-  QString netlist();
+  void netlist(QTextStream&);
 };
 
 #endif
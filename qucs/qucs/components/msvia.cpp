@@ -70,16 +70,16 @@ Element* MSvia::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString MSvia::netlist()
+void MSvia::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output node name and add ground node
-  s += " " + Ports.first()->Connection->Name + " gnd";
+  s << ' ' << Ports.first()->Connection->Name << " gnd";
 
   // output all properties
   for(Property *p2 = Props.first(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
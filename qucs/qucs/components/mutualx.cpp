@@ -72,13 +72,13 @@ Component* MutualX::newOne()
     return p;
 }
 
-QString MutualX::netlist()
+void MutualX::netlist(QTextStream& s)
 {
-    QString s = Model + ":" + Name;
+    s << Model << ':' << Name;
 
     // output all node names
     foreach(Port *p1, Ports) {
-      s += " "+p1->Connection->Name;   // node names
+      s << ' ' << p1->Connection->Name;   // node names
     }
 
     int coils = Props.at(0)->Value.toInt();
@@ -125,9 +125,7 @@ QString MutualX::netlist()
     delete [] k_matrix;
 
 
-    s += QString(" L=\"[%1]\" k=\"[%2]\"\n").arg(L,k);
-
-    return s;
+    s << " L=\"[" << L << "]\" k=\"[" << k << "]\"\n";
 }
 
 // --------------------------------------------------------
@@ -33,7 +33,7 @@ public:
 
 protected:
   void createSymbol();
-  QString netlist();
+  void netlist(QTextStream&);
 };
 
 #endif
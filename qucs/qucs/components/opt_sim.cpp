@@ -62,16 +62,15 @@ Element* Optimize_Sim::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString Optimize_Sim::netlist()
+void Optimize_Sim::netlist(QTextStream& s)
 {
-  QString s = "#\n";
+  s << "#\n";
   if (createASCOFiles()) {
-    s += "# ASCO configuration file(s) created\n";
+    s << "# ASCO configuration file(s) created\n";
   } else {
-    s += "# Failed to create ASCO configuration file(s)\n";
+    s << "# Failed to create ASCO configuration file(s)\n";
   }
-  s += "#\n\n";
-  return s;
+  s << "#\n\n";
 }
 
  
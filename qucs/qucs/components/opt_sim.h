@@ -32,7 +32,7 @@ public:
   bool loadASCOout();
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
 };
 
 #endif
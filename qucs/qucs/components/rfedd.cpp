@@ -77,33 +77,29 @@ Element* RFedd::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString RFedd::netlist()
+void RFedd::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
-  QString e = "\n";
-  QString n, p;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output all properties
   Property *p2;
   p2 = Props.at(0);
-  s += " "+p2->Name+"=\""+p2->Value+"\"";
-  p = p2->Value;
+  s << ' ' << p2->Name << "=\"" << p2->Value << '"';
+  QString p = p2->Value;
   p2 = Props.at(2);
-  s += " "+p2->Name+"=\""+p2->Value+"\"";
-  p2 = Props.at(3);
-  while(p2) {
-    n = p2->Name.mid(1);
-    s += " "+p2->Name+"=\""+Name+"."+p+n+"\"";
-    e += "  Eqn:Eqn"+Name+p2->Name+" "+
-      Name+"."+p+n+"=\""+p2->Value+"\" Export=\"no\"\n";
-    p2 = Props.next();
-  }
-
-  return s+e;
+  s << ' ' << p2->Name << "=\"" << p2->Value << '"';
+  for(p2 = Props.at(3); p2 != 0; p2 = Props.next())
+    s << ' ' << p2->Name << "=\"" << Name << '.' << p << p2->Name.mid(1) << '"';
+  s << '\n';
+
+  // output the equations
+  for(p2 = Props.at(3); p2 != 0; p2 = Props.next())
+    s << "  Eqn:Eqn" << Name << p2->Name << ' ' << Name << '.' << p
+      << p2->Name.mid(1) << "=\"" << p2->Value << "\" Export=\"no\"\n";
 }
 
 // -------------------------------------------------------
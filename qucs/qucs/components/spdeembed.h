@@ -39,7 +39,7 @@ public:
   QString getSubcircuitFile();
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   void createSymbol();
 };
 
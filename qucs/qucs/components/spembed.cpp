@@ -107,31 +107,29 @@ QString SPEmbed::getSubcircuitFile()
 }
 
 // -------------------------------------------------------
-QString SPEmbed::netlist()
+void SPEmbed::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output all properties
   Property *p2 = Props.first();
-  s += " "+p2->Name+"=\"{"+getSubcircuitFile()+"}\"";
+  s << ' ' << p2->Name << "=\"{" << getSubcircuitFile() << "}\"";
 
   // data type
   p2 = Props.next();
-  s += " "+p2->Name+"=\""+p2->Value+"\"";
+  s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
   // interpolator type
   p2 = Props.next();
-  s += " "+p2->Name+"=\""+p2->Value+"\"";
+  s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
   // DC property
   p2 = Props.next();
-  s += " "+p2->Name+"=\""+p2->Value+"\"\n";
-
-  return s;
+  s << ' ' << p2->Name << "=\"" << p2->Value << "\"\n";
 }
 
 // -------------------------------------------------------
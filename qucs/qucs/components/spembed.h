@@ -33,7 +33,7 @@ public:
   QString getSubcircuitFile();
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   void createSymbol();
 };
 
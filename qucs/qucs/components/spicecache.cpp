@@ -0,0 +1,356 @@
+/*
+ * spicecache.cpp - cache of converted SPICE files
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spicecache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStatusBar>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "qucs.h"
+
+// bump this if the format of the cached files changes
+#define SPICE_CACHE_VERSION 2
+
+namespace {
+
+// the hash of a SPICE file as long as it is not modified, so that the
+// file is read only once per session
+struct SourceDigest {
+  SourceDigest() : Size(-1) {}
+
+  QDateTime Modified;
+  qint64 Size;
+  QByteArray Hash;
+};
+
+QHash<QString, SourceDigest> SourceDigests;
+
+// creates a file of a unique name next to the cache entry, so that
+// several Qucs instances sharing the cache do not write the same file
+QString temporaryFile(const QString& Entry)
+{
+  QTemporaryFile File(Entry + ".XXXXXX");
+  File.setAutoRemove(false);
+  if(!File.open())  return Entry + ".new";
+  return File.fileName();
+}
+
+// sorts the output of qucsconv into the components and the simulation
+// commands, leaving out comments.
+bool splitConversion(const QString& From, const QString& Out,
+                     const QString& Sim, bool Subcircuit)
+{
+  QFile InFile(From), OutFile(Out), SimFile(Sim);
+  if(!InFile.open(QIODevice::ReadOnly))  return false;
+  if(!OutFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  if(!SimFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QTextStream In(&InFile), OutStream(&OutFile), SimStream(&SimFile);
+  while(!In.atEnd()) {
+    QString s = In.readLine().trimmed();
+    if(s.isEmpty() || s.at(0) == '#')
+      continue;
+    if(s.at(0) == '.' && s.left(5) != ".Def:") {
+      SimStream << s << '\n';
+      continue;
+    }
+    if(Subcircuit)  OutStream << "  ";
+    OutStream << s << '\n';
+  }
+  OutStream.flush();
+  SimStream.flush();
+  return (OutFile.error() == QFile::NoError) &&
+         (SimFile.error() == QFile::NoError);
+}
+
+}
+
+// ---------------------------------------------------------------------
+// "cache/spice" in the qucs home directory, a directory in the temporary
+// directory if that cannot be created.
+QString SpiceCache::directory()
+{
+  static QString Dir;
+  if(!Dir.isEmpty())  return Dir;
+
+  QDir Home(QucsSettings.QucsHomeDir);
+  if(Home.mkpath("cache/spice")) {
+    Dir = Home.absoluteFilePath("cache/spice");
+    return Dir;
+  }
+
+  QDir Temp = QDir::temp();
+  Temp.mkpath("qucs-spice-cache");
+  Dir = Temp.absoluteFilePath("qucs-spice-cache");
+  return Dir;
+}
+
+// ---------------------------------------------------------------------
+// computes the key of a conversion. returns false if the source cannot
+// be read.
+bool SpiceCache::prepare(SpiceConversion& c, QString& error)
+{
+  QFileInfo Info(c.Source);
+  SourceDigest Digest = SourceDigests.value(c.Source);
+  if(Digest.Hash.isEmpty() || (Digest.Modified != Info.lastModified())
+                           || (Digest.Size != Info.size())) {
+    QFile File(c.Source);
+    if(!File.open(QIODevice::ReadOnly)) {
+      error += QObject::tr("ERROR: Cannot open SPICE file \"%1\".").
+        arg(c.Source);
+      return false;
+    }
+
+    QCryptographicHash Hash(QCryptographicHash::Sha1);
+    while(!File.atEnd())
+      Hash.addData(File.read(1 << 16));
+    Digest.Modified = Info.lastModified();
+    Digest.Size = Info.size();
+    Digest.Hash = Hash.result();
+    SourceDigests.insert(c.Source, Digest);
+  }
+
+  // a different qucsconv may convert differently
+  QFileInfo Conv(QucsSettings.Qucsconv);
+  QCryptographicHash Key(QCryptographicHash::Sha1);
+  Key.addData(QByteArray::number(SPICE_CACHE_VERSION) + '\n');
+  Key.addData(Digest.Hash);
+  Key.addData(c.Preprocessor.toUtf8() + '\n');
+  Key.addData(c.Subcircuit ? "-g _ref\n" : "\n");
+  Key.addData(Conv.absoluteFilePath().toUtf8() + '\n');
+  Key.addData(Conv.lastModified().toString(Qt::ISODate).toUtf8());
+  c.Key = QString::fromLatin1(Key.result().toHex());
+  return true;
+}
+
+// ---------------------------------------------------------------------
+QString SpiceCache::entry(const SpiceConversion& c)
+{
+  return directory() + "/" + c.Key + ".lst";
+}
+
+// ---------------------------------------------------------------------
+QString SpiceCache::simulations(const SpiceConversion& c)
+{
+  return directory() + "/" + c.Key + ".sim";
+}
+
+// ---------------------------------------------------------------------
+bool SpiceCache::contains(const SpiceConversion& c)
+{
+  return !c.Key.isEmpty() && QFile::exists(entry(c)) &&
+         QFile::exists(simulations(c));
+}
+
+// ---------------------------------------------------------------------
+SpiceConverter::SpiceConverter(QObject *parent)
+  : QObject(parent), Failed(0)
+{
+}
+
+// ---------------------------------------------------------------------
+SpiceConverter::~SpiceConverter()
+{
+  foreach(QProcess *p, Active.keys()) {
+    if(p->state() != QProcess::NotRunning) {
+      p->kill();
+      p->waitForFinished(1000);
+    }
+    delete p;
+  }
+}
+
+// ---------------------------------------------------------------------
+// converts all files (their keys must be prepared) and returns the
+// number of failed conversions. the messages of the tools are collected
+// in errorText().
+//
+// the caller is in the middle of creating a netlist, so no events are
+// processed meanwhile: the processes are waited for in turn, the others
+// keep running in the background.
+int SpiceConverter::run(const QList<SpiceConversion>& jobs, int workers)
+{
+  Queue = jobs;
+  Failed = 0;
+  ErrText = "";
+  if(workers < 1)  workers = 1;
+
+  while(!Queue.isEmpty() || !Active.isEmpty()) {
+    while((Active.size() < workers) && startNext()) ;
+
+    foreach(QProcess *p, Active.keys()) {
+      // a short wait for each of several, so that all of them are read
+      int Wait = (Active.size() > 1) ? 100 : -1;
+      if((p->state() != QProcess::NotRunning) && !p->waitForFinished(Wait))
+        continue;
+      finished(p);
+    }
+  }
+  return Failed;
+}
+
+// ---------------------------------------------------------------------
+bool SpiceConverter::startNext()
+{
+  if(Queue.isEmpty())  return false;
+
+  Task t;
+  t.Job = Queue.takeFirst();
+  QString Prep = t.Job.Preprocessor;
+  t.Preprocessing = (Prep == "ps2sp") || (Prep == "spicepp") ||
+                    (Prep == "spiceprm");
+  if(!t.Preprocessing)  t.Job.Preprocessor = "none";
+  QString Entry = SpiceCache::entry(t.Job);
+  if(t.Preprocessing)  t.Pre = temporaryFile(Entry);
+  t.New = temporaryFile(Entry);
+  t.Out = temporaryFile(Entry);
+  t.Sim = temporaryFile(Entry);
+  launch(t);
+  return true;
+}
+
+// ---------------------------------------------------------------------
+// starts the next step of a conversion: the preprocessor and qucsconv
+// write files of their own next to the cache entry, the result of
+// qucsconv is renamed to the entry once it is complete.
+void SpiceConverter::launch(const Task& t)
+{
+  QProcess *p = new QProcess(this);
+  p->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+  Active.insert(p, t);
+
+  QString Program;
+  QStringList Args;
+  if(t.Preprocessing) {
+#ifdef __MINGW32__
+    Program = "tinyperl.exe";
+#else
+    Program = "perl";
+#endif
+    QString Prep = t.Job.Preprocessor;
+    if(Prep == "ps2sp")  Args << "ps2sp";
+    else if(Prep == "spicepp")  Args << "spicepp.pl";
+    else  Args << "spiceprm";
+    Args << t.Job.Source;
+    if(Prep == "spiceprm")
+      Args << t.Pre;
+    else
+      p->setStandardOutputFile(t.Pre);
+
+    if(QucsMain)
+      QucsMain->statusBar()->showMessage(tr("Preprocessing SPICE file \"%1\".").
+                                         arg(t.Job.Source), 2000);
+  }
+  else {
+    Program = QucsSettings.Qucsconv;
+    if(t.Job.Subcircuit)  Args << "-g" << "_ref";
+    Args << "-if" << "spice" << "-of" << "qucs";
+    if(t.Job.Preprocessor == "none")
+      Args << "-i" << t.Job.Source;
+    else
+      Args << "-i" << t.Pre;
+    p->setStandardOutputFile(t.New);
+
+    qDebug() << "SpiceConverter::launch :Command:" << QucsSettings.Qucsconv
+             << Args.join(" ");
+    // only interact with the GUI if it was launched
+    if(QucsMain)
+      QucsMain->statusBar()->showMessage(tr("Converting SPICE file \"%1\".").
+                                         arg(t.Job.Source), 2000);
+    else
+      qDebug() << tr("Converting SPICE file \"%1\".").arg(t.Job.Source);
+  }
+
+  p->start(Program, Args);
+  if(p->waitForStarted())  return;
+
+  Task& Failing = Active[p];
+  if(Failing.Preprocessing)
+    Failing.Error += tr("ERROR: Cannot execute SPICE preprocessor \"%1\".").
+      arg(Failing.Job.Preprocessor);
+  else
+    Failing.Error += tr("COMP ERROR: Cannot start QucsConv!");
+  done(p, false);
+}
+
+// ---------------------------------------------------------------------
+// a step of a conversion has ended, starts the next one or stores the
+// result.
+void SpiceConverter::finished(QProcess *p)
+{
+  Active[p].Error += QString(p->readAllStandardError());
+  Task t = Active.value(p);
+  if(p->exitStatus() != QProcess::NormalExit) {
+    done(p, false);
+    return;
+  }
+
+  if(t.Preprocessing) {
+    Active.remove(p);
+    delete p;
+    t.Preprocessing = false;
+    launch(t);
+    return;
+  }
+
+  // a failed conversion is not cached, it is tried again next time.
+  // the entry only ever appears complete, after the simulation commands:
+  // if a rename fails, another instance has just stored the same files.
+  QString Entry = SpiceCache::entry(t.Job);
+  QString SimEntry = SpiceCache::simulations(t.Job);
+  bool ok = (p->exitCode() == 0) &&
+            splitConversion(t.New, t.Out, t.Sim, t.Job.Subcircuit);
+  if(ok && !QFile::rename(t.Sim, SimEntry))
+    ok = QFile::exists(SimEntry);
+  if(ok && !QFile::rename(t.Out, Entry))
+    ok = QFile::exists(Entry);
+  done(p, ok);
+}
+
+// ---------------------------------------------------------------------
+void SpiceConverter::done(QProcess *p, bool ok)
+{
+  Task t = Active.take(p);
+  delete p;
+
+  if(!t.Pre.isEmpty())  QFile::remove(t.Pre);
+  QFile::remove(t.New);
+  QFile::remove(t.Out);
+  QFile::remove(t.Sim);
+  ErrText += t.Error;
+  if(!ok) {
+    ErrText += tr("ERROR: Cannot convert SPICE file \"%1\".\n").
+      arg(t.Job.Source);
+    Failed++;
+  }
+}
+
+// vim:ts=8:sw=2:et
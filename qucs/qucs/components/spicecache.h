@@ -0,0 +1,102 @@
+/*
+ * spicecache.h - cache of converted SPICE files
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SPICECACHE_H_
+#define SPICECACHE_H_ value
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+
+/*!
+ * one SPICE file to be converted. the contents of the source, the
+ * preprocessor, whether qucsconv generates a subcircuit ("-g _ref") and
+ * the qucsconv binary make up the key of the result in the cache. port
+ * names and whether the simulation commands are used are applied when
+ * the result is read, so they do not take part.
+ */
+struct SpiceConversion {
+  SpiceConversion() : Subcircuit(false) {}
+
+  QString Source;         // absolute file name
+  QString Preprocessor;   // "none", "ps2sp", "spicepp" or "spiceprm"
+  bool Subcircuit;
+  QString Key;            // set by SpiceCache::prepare()
+};
+
+/*!
+ * the output of qucsconv, stored per user in the cache directory under
+ * the key of the conversion. a file is converted once and then read
+ * from the cache by every schematic (in every project) using it.
+ *
+ * the output is stored ready to be copied into a netlist: entry() holds
+ * the components (indented if a subcircuit), simulations() the
+ * simulation commands, comments are left out.
+ */
+class SpiceCache {
+public:
+  static QString directory();
+  static bool prepare(SpiceConversion&, QString& error);
+  static QString entry(const SpiceConversion&);
+  static QString simulations(const SpiceConversion&);
+  static bool contains(const SpiceConversion& c);
+};
+
+/*!
+ * converts SPICE files into the cache, running the preprocessor (if any)
+ * and qucsconv for several files at once. no events are processed while
+ * they run, like a single blocking conversion.
+ */
+class SpiceConverter : public QObject {
+Q_OBJECT
+public:
+  SpiceConverter(QObject *parent=0);
+ ~SpiceConverter();
+
+  int run(const QList<SpiceConversion>&, int workers);
+  QString errorText() const { return ErrText; }
+
+private:
+  struct Task {
+    SpiceConversion Job;
+    bool Preprocessing;
+    QString Error;
+    QString Pre;   // output of the preprocessor
+    QString New;   // output of qucsconv
+    QString Out;   // components of "New", renamed to the entry when done
+    QString Sim;   // simulation commands of "New"
+  };
+
+  bool startNext();
+  void launch(const Task&);
+  void finished(QProcess*);
+  void done(QProcess*, bool ok);
+
+  QList<SpiceConversion> Queue;
+  QHash<QProcess*, Task> Active;
+  QString ErrText;
+  int Failed;
+};
+
+#endif
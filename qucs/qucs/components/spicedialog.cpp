@@ -270,6 +270,7 @@ void SpiceDialog::slotButtApply()
 
   if(changed || Comp->withSim)    // because of "sim" text
   {
+    Comp->invalidateNetlist();
     Doc->recreateComponent(Comp); // to apply changes to the schematic symbol
     Doc->viewport()->repaint();
   }
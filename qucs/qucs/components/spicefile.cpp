@@ -19,17 +19,14 @@
 # include <unistd.h>
 #endif
 #include <QRegExp>
-#include <QProcess>
 #include <QString>
 #include <QStringList>
-#include <QMessageBox>
 #include <QTextStream>
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
 #include <QMutex>
 #include <QDebug>
-#include <QStatusBar>
 
 #include "spicefile.h"
 #include "schematic.h"
@@ -148,18 +145,17 @@ void SpiceFile::createSymbol()
 }
 
 // ---------------------------------------------------
-QString SpiceFile::netlist()
+void SpiceFile::netlist(QTextStream& s)
 {
   if(Props.at(1)->Value.isEmpty())
-    return QString("");  // no ports, no subcircuit instance
+    return;  // no ports, no subcircuit instance
 
-  QString s = "Sub:"+Name;   // SPICE netlist is subcircuit
+  s << "Sub:" << Name;   // SPICE netlist is subcircuit
   foreach(Port *pp, Ports)
-    s += " "+pp->Connection->Name;   // output all node names
+    s << ' ' << pp->Connection->Name;   // output all node names
 
   QString f = misc::properFileName(Props.first()->Value);
-  s += " Type=\""+misc::properName(f)+"\"\n";
-  return s;
+  s << " Type=\"" << misc::properName(f) << "\"\n";
 }
 
 // -------------------------------------------------------
@@ -261,8 +257,37 @@ QString SpiceFile::getSubcircuitFile()
 }
 
 // -------------------------------------------------------------------------
+SpiceConversion SpiceFile::conversion()
+{
+  SpiceConversion c;
+  c.Source = getSubcircuitFile();
+  c.Preprocessor = Props.at(3)->Value;
+  c.Subcircuit = !Props.at(1)->Value.isEmpty();
+  return c;
+}
+
+// -------------------------------------------------------------------------
+// writes a cached conversion between "Head" and "Tail", followed by the
+// simulation commands if "SimEntry" is given.
+static bool writeConversion(QTextStream& s, const QString& Head,
+                            const QString& Entry, const QString& Tail,
+                            const QString& SimEntry)
+{
+  s << Head;
+  if(!misc::streamFile(s, Entry))  return false;
+  s << Tail;
+  if(!SimEntry.isEmpty() && !misc::streamFile(s, SimEntry))  return false;
+  return true;
+}
+
+// -------------------------------------------------------------------------
+// the output of qucsconv is taken from the conversion cache, it is only
+// converted if it is not there yet. port names and simulation commands
+// are inserted here.
 bool SpiceFile::createSubNetlist(QTextStream *stream)
 {
+  ErrText = "";
+
   // check file name
   QString FileName = Props.first()->Value;
   if(FileName.isEmpty()) {
@@ -271,280 +296,50 @@ bool SpiceFile::createSubNetlist(QTextStream *stream)
     return false;
   }
 
-  // check input and output file
-  QFile SpiceFile, ConvFile;
-  FileName = getSubcircuitFile();
-  SpiceFile.setFileName(FileName);
-  if(!SpiceFile.open(QIODevice::ReadOnly)) {
-    ErrText += QObject::tr("ERROR: Cannot open SPICE file \"%1\".").
-      arg(FileName);
+  SpiceConversion Conv = conversion();
+  FileName = Conv.Source;
+  if(!SpiceCache::prepare(Conv, ErrText))
     return false;
-  }
-  SpiceFile.close();
-  QString ConvName = SpiceFile.fileName() + ".lst";
-  ConvFile.setFileName(ConvName);
-  QFileInfo Info(ConvName);
-
-  // re-create converted file if necessary
-  if(changed || !ConvFile.exists() ||
-     (lastLoaded.isValid() && lastLoaded < Info.lastModified())) {
-    if(!ConvFile.open(QIODevice::WriteOnly)) {
-      ErrText += QObject::tr("ERROR: Cannot save converted SPICE file \"%1\".").
-                          arg(FileName + ".lst");
+  if(!SpiceCache::contains(Conv)) {
+    SpiceConverter Converter;
+    int Failed = Converter.run(QList<SpiceConversion>() << Conv, 1);
+    ErrText += Converter.errorText();
+    if(Failed > 0)
       return false;
-    }
-    outstream = stream;
-    filstream = new QTextStream(&ConvFile);
-    QString SpiceName = SpiceFile.fileName();
-    bool ret = recreateSubNetlist(&SpiceName, &FileName);
-    ConvFile.close();
-    delete filstream;
-    return ret;
-  }
-
-  // load old file and stuff into stream
-  if(!ConvFile.open(QIODevice::ReadOnly)) {
-    ErrText += QObject::tr("ERROR: Cannot open converted SPICE file \"%1\".").
-                        arg(FileName + ".lst");
-    return false;
   }
-  QByteArray FileContent = ConvFile.readAll();
-  ConvFile.close();
-  //? stream->writeRawBytes(FileContent.value(), FileContent.size());
-  (*stream) << FileContent.data();
-  return true;
-}
 
-// -------------------------------------------------------------------------
-bool SpiceFile::recreateSubNetlist(QString *SpiceFile, QString *FileName)
-{
-  // initialize collectors
-  ErrText = "";
-  NetText = "";
-  SimText = "";
-  NetLine = "";
-
-  // evaluate properties
-  if(Props.at(1)->Value != "")
-    makeSubcircuit = true;
-  else
-    makeSubcircuit = false;
+  // the cached files are copied as they are, see SpiceCache
+  QString Entry = SpiceCache::entry(Conv);
+  QString SimEntry;
   if(Props.at(2)->Value == "yes")
-    insertSim = true;
-  else
-    insertSim = false;
-
-  // preprocessor run if necessary
-  QString preprocessor = Props.at(3)->Value;
-  if (preprocessor != "none") {
-    bool piping = true;
-    QStringList script;
-#ifdef __MINGW32__
-    QString interpreter = "tinyperl.exe";
-#else
-    QString interpreter = "perl";
-#endif
-    if (preprocessor == "ps2sp") {
-      script << "ps2sp";
-    } else if (preprocessor == "spicepp") {
-      script << "spicepp.pl";
-    } else if (preprocessor == "spiceprm") {
-      script << "spiceprm";
-      piping = false;
-    }
-    SpicePrep = new QProcess(this);
-    script << interpreter;
-    script << script;
-    script << *SpiceFile;
-
-    QFile PrepFile;
-    QString PrepName = *SpiceFile + ".pre";
-
-    if (!piping) {
-      script << PrepName;
-      connect(SpicePrep, SIGNAL(readyReadStandardOutput()), SLOT(slotSkipOut()));
-      connect(SpicePrep, SIGNAL(readyReadStandardError()), SLOT(slotGetPrepErr()));
-    } else {
-      connect(SpicePrep, SIGNAL(readyReadStandardOutput()), SLOT(slotGetPrepOut()));
-      connect(SpicePrep, SIGNAL(readyReadStandardError()), SLOT(slotGetPrepErr()));
-    }
-
-    QMessageBox *MBox = 
-      new QMessageBox(QMessageBox::NoIcon,
-                      QObject::tr("Info"),
-                      QObject::tr("Preprocessing SPICE file \"%1\".").arg(*SpiceFile),
-                      QMessageBox::Abort);
-    MBox->setAttribute(Qt::WA_DeleteOnClose);
-    connect(SpicePrep, SIGNAL(finished(int)), MBox, SLOT(close()));
-
-    if (piping) {
-      PrepFile.setFileName(PrepName);
-      if(!PrepFile.open(QIODevice::WriteOnly)) {
-        ErrText +=
-          QObject::tr("ERROR: Cannot save preprocessed SPICE file \"%1\".").
-          arg(PrepName);
-        return false;
-      }
-      prestream = new QTextStream(&PrepFile);
-    }
-
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    SpicePrep->setProcessEnvironment(env);
-    SpicePrep->start(script.join(" "));
-    //QucsHelp->setCommunication(0);
-
-    if(SpicePrep->state()!=QProcess::Running&&
-            SpicePrep->state()!=QProcess::Starting) {
-      ErrText += QObject::tr("ERROR: Cannot execute \"%1\".").
-              arg(interpreter + " " + script.join(" ") + "\".");
-      if (piping) {
-        PrepFile.close();
-        delete prestream;
-      }
-      return false;
-    }
-    //SpicePrep->closeStdin();
-
-    MBox->exec();
-    delete SpicePrep;
-    if (piping) {
-      PrepFile.close();
-      delete prestream;
-    }
-    *SpiceFile = PrepName;
-  }
-
-  // begin command line construction
-  QString prog;
-  QStringList com;
-  //prog =  QucsSettings.BinDir + "qucsconv"  + executableSuffix;
-  prog =  QucsSettings.Qucsconv;
-
-  if(makeSubcircuit) com << "-g" << "_ref";
-  com << "-if" << "spice" << "-of" << "qucs";
-  com << "-i" << *SpiceFile;
-
-  // begin netlist text creation
-  if(makeSubcircuit) {
-    QString f = misc::properFileName(*FileName);
-    NetText += "\n.Def:" + misc::properName(f) + " ";
+    SimEntry = SpiceCache::simulations(Conv);
+  QString Head = "\n", Tail;
+  if(Conv.Subcircuit) {
+    QString f = misc::properFileName(FileName);
     QString PortNames = Props.at(1)->Value;
     PortNames.replace(',', ' ');
-    NetText += PortNames;
-    if(makeSubcircuit) NetText += " _ref";
+    Head = "\n.Def:" + misc::properName(f) + " " + PortNames + " _ref\n";
+    Tail = ".Def:End\n\n";
   }
-  NetText += "\n";
-
-  // startup SPICE conversion process
-  QucsConv = new QProcess(this);
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  QucsConv->setProcessEnvironment(env);
-
-  qDebug() << "SpiceFile::recreateSubNetlist :Command:" << prog << com.join(" ");
-//  QucsConv->start(com.join(" "));
-  QucsConv->start(prog, com);
 
-  /// these slots might write into NetText, ErrText, outstream, filstream
-  connect(QucsConv, SIGNAL(readyReadStandardOutput()), SLOT(slotGetNetlist()));
-  connect(QucsConv, SIGNAL(readyReadStandardError()), SLOT(slotGetError()));
-  connect(QucsConv, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(slotExited()));
-
-  if(QucsConv->state()!=QProcess::Running&&
-          QucsConv->state()!=QProcess::Starting) {
-    ErrText += QObject::tr("COMP ERROR: Cannot start QucsConv!");
+  if(!writeConversion(*stream, Head, Entry, Tail, SimEntry)) {
+    ErrText += QObject::tr("ERROR: Cannot open converted SPICE file \"%1\".").
+                        arg(Entry);
     return false;
   }
-  (*outstream) << NetText;
-  (*filstream) << NetText;
-
-  // only interact with the GUI if it was launched
-  if (QucsMain) {
-    QucsMain->statusBar()->showMessage(tr("Converting SPICE file \"%1\".").arg(*SpiceFile), 2000);
-  }
-  else
-    qDebug() << QObject::tr("Converting SPICE file \"%1\".").arg(*SpiceFile);
 
-  // finish
-  QucsConv->waitForFinished();
-  delete QucsConv;
-  lastLoaded = QDateTime::currentDateTime();
-  return true;
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotSkipErr()
-{
-  SpicePrep->readAllStandardError();
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotSkipOut()
-{
-    SpicePrep->readAllStandardOutput();
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotGetPrepErr()
-{
-  ErrText += QString(SpicePrep->readAllStandardError());
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotGetPrepOut()
-{
-  (*prestream) << QString(SpicePrep->readAllStandardOutput());
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotGetError()
-{
-  ErrText += QString(QucsConv->readAllStandardError());
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotGetNetlist()
-{
-  int i;
-  QString s;
-  NetLine += QString(QucsConv->readAllStandardOutput());
-
-  while((i = NetLine.indexOf('\n')) >= 0) {
-    s = NetLine.left(i);
-    NetLine.remove(0, i+1);
-    s = s.trimmed();
-    if(s.size()>0&&s.at(0) == '#') {
-      continue;
-    } else if(s.isEmpty()) {
-      continue;
-    } else if(s.size()>0&&s.at(0) == '.') {
-      if(s.left(5) != ".Def:") {
-        if(insertSim) SimText += s + "\n";
-        continue;
-      }
-    }
-    if(makeSubcircuit) {
-      (*outstream) << "  ";
-      (*filstream) << "  ";
-    }
-    (*outstream) << s << "\n";
-    (*filstream) << s << "\n";
-  }
-}
-
-// -------------------------------------------------------------------------
-void SpiceFile::slotExited()
-{
-  if (QucsConv->exitStatus() != QProcess::NormalExit) {
-    NetText = "";
-  }
-  else {
-    if(makeSubcircuit) {
-      (*outstream) << ".Def:End\n\n";
-      (*filstream) << ".Def:End\n\n";
-    }
-    if(!SimText.isEmpty()) {
-      (*outstream) << SimText;
-      (*filstream) << SimText;
+  // the converted file next to the SPICE file is still written for the
+  // library dialog, it does not matter if its directory is read-only
+  QFileInfo ListInfo(FileName + ".lst");
+  if(changed || !ListInfo.exists() ||
+     ListInfo.lastModified() < QFileInfo(FileName).lastModified() ||
+     ListInfo.lastModified() < QFileInfo(Entry).lastModified()) {
+    QFile ListFile(ListInfo.filePath());
+    if(ListFile.open(QIODevice::WriteOnly)) {
+      QTextStream List(&ListFile);
+      writeConversion(List, Head, Entry, Tail, SimEntry);
     }
   }
+  changed = false;
+  return true;
 }
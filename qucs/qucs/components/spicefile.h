@@ -18,11 +18,10 @@
 #ifndef SPICEFILE_H
 #define SPICEFILE_H
 #include "component.h"
+#include "spicecache.h"
 
 #include <QObject>
-#include <QDateTime>
 
-class QProcess;
 class QTextStream;
 class QString;
 
@@ -40,29 +39,15 @@ public:
   bool createSubNetlist(QTextStream *);
   QString getErrorText() { return ErrText; }
   QString getSubcircuitFile();
+  SpiceConversion conversion();
 
 private:
-  bool makeSubcircuit;
-  bool insertSim;
   bool changed;
-  QProcess *QucsConv, *SpicePrep;
-  QString NetText, ErrText, NetLine, SimText;
-  QTextStream *outstream, *filstream, *prestream;
-  QDateTime lastLoaded;
-  bool recreateSubNetlist(QString *, QString *);
+  QString ErrText;
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   void createSymbol();
-
-private slots:
-  void slotGetNetlist();
-  void slotGetError();
-  void slotExited();
-  void slotSkipOut();
-  void slotSkipErr();
-  void slotGetPrepOut();
-  void slotGetPrepErr();
 };
 
 #endif
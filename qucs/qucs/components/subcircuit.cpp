@@ -198,22 +198,22 @@ int Subcircuit::loadSymbol(const QString& DocName)
 }
 
 // -------------------------------------------------------
-QString Subcircuit::netlist()
+void Subcircuit::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // type for subcircuit
   QString f = misc::properFileName(Props.first()->Value);
-  s += " Type=\""+misc::properName(f)+"\"";
+  s << " Type=\"" << misc::properName(f) << '"';
 
   // output all user defined properties
   for(Property *pp = Props.next(); pp != 0; pp = Props.next())
-    s += " "+pp->Name+"=\""+pp->Value+"\"";
-  return s + '\n';
+    s << ' ' << pp->Name << "=\"" << pp->Value << '"';
+  s << '\n';
 }
 
 // -------------------------------------------------------
@@ -29,9 +29,10 @@ public:
   static Element* info(QString&, char* &, bool getNewOne=false);
 
   QString getSubcircuitFile();
+  QByteArray symbolKey() { return QByteArray(); }  // read from file
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
   QString vhdlCode(int);
   QString verilogCode(int);
   void createSymbol();
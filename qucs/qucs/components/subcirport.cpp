@@ -98,9 +98,8 @@ Element* SubCirPort::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString SubCirPort::netlist()
+void SubCirPort::netlist(QTextStream&)
 {
-  return QString("");
 }
 
 // -------------------------------------------------------
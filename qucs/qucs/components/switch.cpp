@@ -65,23 +65,23 @@ Element* Switch::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
-QString Switch::netlist()
+void Switch::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
-  s += " "+Ports.at(0)->Connection->Name;
-  s += " "+Ports.at(1)->Connection->Name;
+  s << ' ' << Ports.at(0)->Connection->Name;
+  s << ' ' << Ports.at(1)->Connection->Name;
 
   // output all properties
   Property *p2 = Props.first();
-  s += " "+p2->Name+"=\""+p2->Value+"\"";
+  s << ' ' << p2->Name << "=\"" << p2->Value << '"';
   p2 = Props.next();
-  s += " "+p2->Name+"=\"["+p2->Value+"]\"";
+  s << ' ' << p2->Name << "=\"[" << p2->Value << "]\"";
   for(p2 = Props.next(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + '\n';
+  s << '\n';
 }
 
 // -------------------------------------------------------
@@ -23,6 +23,10 @@
 #include <QScriptValue>
 #include <QScriptValueIterator>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QSharedPointer>
 #include <QTextStream>
 #include <QMessageBox>
 
@@ -34,113 +38,32 @@
 
 
 /*!
- * \brief vacomponent::vacomponent
- * \param filename File (JSON) containing the symbol paintins and properties.
+ * \brief VaSymbol is a symbol file parsed into everything a vacomponent
+ * is made of. It serves as prototype for all instances of the device.
  */
-vacomponent::vacomponent(QString filename)
-{
-  QString data = getData(filename);
-
-  /// \todo check if JSON is error free
-  /// \todo Need to destroy engine?
-  QScriptEngine engine;
-  QScriptValue vadata = engine.evaluate("(" + data + ")");
-
-  Description = getString(vadata, "description");
-
-  QScriptValue entries = vadata.property("property");
-
-  QScriptValueIterator it(entries);
-
-  while (it.hasNext()) {
-    it.next();
-
-    QScriptValue entry = it.value();
-
-    // skip length named iterate
-    if (it.name().compare("length")) {
-      QString name = getString(entry, "name");
-      QString value = getString(entry, "value");
-      QString display = getString(entry, "display");
-      QString desc = getString(entry, "desc");
-      // QString unit = getString(entry, "unit");
-
-      /// \todo append units to description
-
-      bool show;
-      if (!display.compare("false"))
-        show = false;
-      else
-        show = true;
-
-      /// \todo what if there are no properties?
-
-      Props.append (new Property (name, value, show, desc));
-    }
-  }
-
-  createSymbol(filename);
-
-  Model = getString(vadata, "Model");
-  Name  = getString(vadata, "SymName");
-
-  /// TODO adjust location of text
-  tx = x1+100;
-  ty = y1+20;
-}
+struct VaSymbol {
+  QDateTime LastModified;
+  qint64 Size;
+
+  QString Model, SymName, Description, BitmapFile;
+  QList<Property> Props;
+  QList<Line> Lines;
+  QList<Area> Rects, Ellips;
+  QList<Arc> Arcs;
+  QList<Port> Ports;
+  QList<Text> Texts;
+  int x1, y1, x2, y2;
+};
+
+typedef QSharedPointer<const VaSymbol> VaSymbolPtr;
 
 /*!
- * \brief vacomponent::newOne is used to mouse drop new items into the schematic.
- * \param filename File (JSON) containing the symbol paintins and properties.
- * \return \a Component based on the \p filename
- *  Used by mouseactions to drop new items into the schematic.
- */
-Component *vacomponent::newOne(QString filename)
-{
-  vacomponent * p = new vacomponent(filename);
-  if (Props.count())
-      p->Props.getFirst()->Value = Props.getFirst()->Value;
-  p->recreate(0);
-  return p;
-
-}
-
-/*!
- * \brief vacomponent::info is used to either get information or create objects.
- * \param Name Model name, returned by reference
- * \param BitmapFile Bitmap file for the dock, returned by reference
- * \param getNewOne if set return new object based on JSON file
- * \param filename File (JSON) containing the symbol paintins and properties.
- * \return Null or a new \a Element if \p getNewOne is true
- * Used to get \p Name and \p BitmapFile.
- * It can also create new objects from symbol file.
+ * \brief parseSymbol evaluates a symbol file, the only place a script
+ * engine is needed.
+ * \param data JSON file contents
+ * \param sym symbol to fill in
  */
-Element *vacomponent::info(QString &Name, QString &BitmapFile,
-                           bool getNewOne, QString filename)
-{
-  // get variables out of file
-  QString data = getData(filename);
-
-  QScriptEngine engine;
-  QScriptValue vadata = engine.evaluate("(" + data + ")");
-
-  Name  = getString(vadata, "Model");
-
-  /// Default BitmapFile is [modulename]
-  /// The BitmapFile JSON entry can be modified in \see LoadDialog::slotChangeIcon()
-  BitmapFile  = getString(vadata, "BitmapFile");
-
-  if(getNewOne) return new vacomponent(filename);
-  return 0;
-}
-
-/*!
- * \brief vacomponent::createSymbol Constructor call this to create the symbol.
- * \param filename File (JSON) containing the symbol paintins and properties.
- * It reads the JSON file and parses the symbol paintings. Data is appended to
- * to the appropriate lists, Lines, Rects, Ellips, ...
- */
-void vacomponent::createSymbol(QString filename)
+static void parseSymbol(const QString& data, VaSymbol& sym)
 {
   // map string to Qt Pen/Brush
   // any better to convert QString into Qt::BrushStyle ?
@@ -171,24 +94,61 @@ void vacomponent::createSymbol(QString filename)
   penMap.insert("Qt::DashDotDotLine", Qt::DashDotDotLine);
   penMap.insert("Qt::CustomDashLine", Qt::CustomDashLine);
 
-
-  QString data = getData(filename);
-
+  /// \todo check if JSON is error free
   QScriptEngine engine;
   QScriptValue vadata = engine.evaluate("(" + data + ")");
 
-  // get array of symbol paintigs
-  QScriptValue entries = vadata.property("paintings");
+  sym.Description = getString(vadata, "description");
+  sym.Model = getString(vadata, "Model");
+  sym.SymName = getString(vadata, "SymName");
+
+  /// Default BitmapFile is [modulename]
+  /// The BitmapFile JSON entry can be modified in \see LoadDialog::slotChangeIcon()
+  sym.BitmapFile = getString(vadata, "BitmapFile");
+
+  QScriptValue entries = vadata.property("property");
 
   QScriptValueIterator it(entries);
+
   while (it.hasNext()) {
     it.next();
 
+    QScriptValue entry = it.value();
+
+    // skip length named iterate
+    if (it.name().compare("length")) {
+      QString name = getString(entry, "name");
+      QString value = getString(entry, "value");
+      QString display = getString(entry, "display");
+      QString desc = getString(entry, "desc");
+      // QString unit = getString(entry, "unit");
+
+      /// \todo append units to description
+
+      bool show;
+      if (!display.compare("false"))
+        show = false;
+      else
+        show = true;
+
+      /// \todo what if there are no properties?
+
+      sym.Props.append (Property (name, value, show, desc));
+    }
+  }
+
+  // get array of symbol paintigs
+  entries = vadata.property("paintings");
+
+  QScriptValueIterator ip(entries);
+  while (ip.hasNext()) {
+    ip.next();
+
     qreal x, x1, x2, y, y1, y2, w, h, thick, angle, arclen;
     qreal size, cos, sin;
     QString color, style    , colorfill, stylefill, s;
 
-    QScriptValue entry = it.value();
+    QScriptValue entry = ip.value();
     QString type = getString(entry, "type");
 
     if (!type.compare("line")) {
@@ -200,7 +160,7 @@ void vacomponent::createSymbol(QString filename)
       thick = getDouble(entry, "thick");
       style = getString(entry, "style");
 
-      Lines.append (new Line (x1, y1, x2, y2,
+      sym.Lines.append (Line (x1, y1, x2, y2,
                         QPen (QColor (color), thick, penMap.value(style))));
     }
 
@@ -215,7 +175,7 @@ void vacomponent::createSymbol(QString filename)
       colorfill = getString(entry, "colorfill");
       stylefill = getString(entry, "stylefill");
 
-      Rects.append (new Area (x, y, w, h,
+      sym.Rects.append (Area (x, y, w, h,
                         QPen (QColor (color), thick, penMap.value(style)),
                         QBrush(QColor (colorfill), brushMap.value(stylefill))
                         ));
@@ -232,7 +192,7 @@ void vacomponent::createSymbol(QString filename)
       colorfill = getString(entry, "colorfill");
       stylefill = getString(entry, "stylefill");
 
-      Ellips.append (new Area (x, y, w, h,
+      sym.Ellips.append (Area (x, y, w, h,
                          QPen (QColor (color), thick, penMap.value(style)),
                          QBrush(QColor (colorfill), brushMap.value(stylefill))
                          ));
@@ -249,14 +209,14 @@ void vacomponent::createSymbol(QString filename)
       thick = getDouble(entry, "thick");
       style = getString(entry, "style");
 
-      Arcs.append (new Arc (x, y, w, h, angle, arclen,
+      sym.Arcs.append (Arc (x, y, w, h, angle, arclen,
                        QPen (QColor (color), thick, penMap.value(style))));
     }
 
     if (!type.compare("portsymbol")) {
       x = getDouble(entry, "x");
       y = getDouble(entry, "y");
-      Ports.append (new Port (x, y));
+      sym.Ports.append (Port (x, y));
     }
 
     if (!type.compare("graphictext")) {
@@ -267,7 +227,7 @@ void vacomponent::createSymbol(QString filename)
       size = getDouble(entry, "size");
       cos = getDouble(entry, "cos");
       sin = getDouble(entry, "sin");
-      Texts.append (new Text (x, y, s,
+      sym.Texts.append (Text (x, y, s,
                               QColor (color), size, cos, sin));
     }
 
@@ -279,16 +239,137 @@ void vacomponent::createSymbol(QString filename)
       color = getString(entry, "color");
       thick = getDouble(entry, "thick");
       style = getString(entry, "style");
-      Lines.append (new Line (x1, y1, x2, y2,
+      sym.Lines.append (Line (x1, y1, x2, y2,
                         QPen (QColor (color), thick, penMap.value(style))));
      }
   }
 
   // bounding box, painted gray if component selected
-  x1 = getDouble(vadata, "x1");
-  y1 = getDouble(vadata, "y1");
-  x2 = getDouble(vadata, "x2");
-  y2 = getDouble(vadata, "y2");
+  sym.x1 = getDouble(vadata, "x1");
+  sym.y1 = getDouble(vadata, "y1");
+  sym.x2 = getDouble(vadata, "x2");
+  sym.y2 = getDouble(vadata, "y2");
+}
+
+/*!
+ * \brief getSymbol returns the parsed symbol file, shared by the module
+ * registration, the component dock and all instances of the device.
+ * \param filename File (JSON) containing the symbol paintings and properties.
+ * The file is parsed again only if its modification time or size changed,
+ * e.g. after the icon was changed in the load dialog.
+ */
+static VaSymbolPtr getSymbol(const QString& filename)
+{
+  static QHash<QString, VaSymbolPtr> cache;
+
+  QFileInfo info(filename);
+  QString key = info.absoluteFilePath();
+  VaSymbolPtr sym = cache.value(key);
+  if (sym && info.exists() && (sym->LastModified == info.lastModified())
+          && (sym->Size == info.size()))
+    return sym;
+
+  VaSymbol *parsed = new VaSymbol;
+  parsed->LastModified = info.lastModified();
+  parsed->Size = info.size();
+  parseSymbol(getData(filename), *parsed);
+
+  sym = VaSymbolPtr(parsed);
+  if (info.exists()) // do not keep the result of a missing file
+    cache.insert(key, sym);
+  else
+    cache.remove(key);
+  return sym;
+}
+
+/*!
+ * \brief vacomponent::vacomponent
+ * \param filename File (JSON) containing the symbol paintins and properties.
+ * The instance is copied from the cached symbol, see getSymbol().
+ */
+vacomponent::vacomponent(QString filename)
+{
+  VaSymbolPtr sym = getSymbol(filename);
+
+  Description = sym->Description;
+
+  foreach(Property const& p, sym->Props)
+    Props.append (new Property (p));
+
+  createSymbol(*sym);
+
+  Model = sym->Model;
+  Name  = sym->SymName;
+
+  /// TODO adjust location of text
+  tx = x1+100;
+  ty = y1+20;
+}
+
+/*!
+ * \brief vacomponent::newOne is used to mouse drop new items into the schematic.
+ * \param filename File (JSON) containing the symbol paintins and properties.
+ * \return \a Component based on the \p filename
+ *  Used by mouseactions to drop new items into the schematic.
+ */
+Component *vacomponent::newOne(QString filename)
+{
+  vacomponent * p = new vacomponent(filename);
+  if (Props.count())
+      p->Props.getFirst()->Value = Props.getFirst()->Value;
+  p->recreate(0);
+  return p;
+
+}
+
+/*!
+ * \brief vacomponent::info is used to either get information or create objects.
+ * \param Name Model name, returned by reference
+ * \param BitmapFile Bitmap file for the dock, returned by reference
+ * \param getNewOne if set return new object based on JSON file
+ * \param filename File (JSON) containing the symbol paintins and properties.
+ * \return Null or a new \a Element if \p getNewOne is true
+ * Used to get \p Name and \p BitmapFile.
+ * It can also create new objects from symbol file.
+ */
+Element *vacomponent::info(QString &Name, QString &BitmapFile,
+                           bool getNewOne, QString filename)
+{
+  VaSymbolPtr sym = getSymbol(filename);
+
+  Name  = sym->Model;
+  BitmapFile  = sym->BitmapFile;
+
+  if(getNewOne) return new vacomponent(filename);
+  return 0;
+}
+
+/*!
+ * \brief vacomponent::createSymbol Constructor call this to create the symbol.
+ * \param sym parsed symbol file
+ * The symbol paintings are copied to the appropriate lists, Lines, Rects,
+ * Ellips, ...
+ */
+void vacomponent::createSymbol(const VaSymbol& sym)
+{
+  foreach(Line const& l, sym.Lines)
+    Lines.append (new Line (l));
+  foreach(Area const& a, sym.Rects)
+    Rects.append (new Area (a));
+  foreach(Area const& a, sym.Ellips)
+    Ellips.append (new Area (a));
+  foreach(Arc const& a, sym.Arcs)
+    Arcs.append (new Arc (a));
+  foreach(Port const& p, sym.Ports)
+    Ports.append (new Port (p.x, p.y));
+  foreach(Text const& t, sym.Texts)
+    Texts.append (new Text (t));
+
+  // bounding box, painted gray if component selected
+  x1 = sym.x1;
+  y1 = sym.y1;
+  x2 = sym.x2;
+  y2 = sym.y2;
 }
 
 
@@ -24,6 +24,7 @@
 
 class QString;
 class QScriptValue;
+struct VaSymbol;
 
 /*!
  * \file vacomponent.h
@@ -37,10 +38,11 @@ class vacomponent : public Component
     vacomponent(QString filename);
     ~vacomponent() { };
     virtual Component* newOne(QString filename);
+    QByteArray symbolKey() { return QByteArray(); }  // read from file
     static Element* info(QString&, QString &,
                          bool getNewOne=false, QString filename="");
   protected:
-    void createSymbol(QString filename);
+    void createSymbol(const VaSymbol&);
 
 };
 
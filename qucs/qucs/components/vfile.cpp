@@ -90,21 +90,21 @@ QString vFile::getSubcircuitFile()
 }
 
 // -------------------------------------------------------
-QString vFile::netlist()
+void vFile::netlist(QTextStream& s)
 {
-  QString s = Model+":"+Name;
+  s << Model << ':' << Name;
 
   // output all node names
   foreach(Port *p1, Ports)
-    s += " "+p1->Connection->Name;   // node names
+    s << ' ' << p1->Connection->Name;   // node names
 
   // output file properties
   Property *p2 = Props.first();
-  s += " "+p2->Name+"=\"{"+getSubcircuitFile()+"}\"";
+  s << ' ' << p2->Name << "=\"{" << getSubcircuitFile() << "}\"";
 
   // output all remaining properties
   for(p2 = Props.next(); p2 != 0; p2 = Props.next())
-    s += " "+p2->Name+"=\""+p2->Value+"\"";
+    s << ' ' << p2->Name << "=\"" << p2->Value << '"';
 
-  return s + "\n";
+  s << '\n';
 }
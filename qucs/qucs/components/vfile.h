@@ -31,7 +31,7 @@ public:
   QString getSubcircuitFile();
 
 protected:
-  QString netlist();
+  void netlist(QTextStream&);
 };
 
 #endif
@@ -225,20 +225,13 @@ bool VHDL_File::createSubNetlist(QTextStream *stream)
   // construct full filename
   FileName = getSubcircuitFile();
 
-  // open file for reading
-  QFile f(FileName);
-  if(!f.open(QIODevice::ReadOnly)) {
+  // write the whole VHDL file into the netlist output
+  (*stream) << '\n';
+  if(!misc::streamFile(*stream, FileName)) {
     ErrText += QObject::tr("ERROR: Cannot open %1 file \"%2\".").
       arg(Model).arg(FileName);
     return false;
   }
-
-  // write the whole VHDL file into the netlist output
-  QByteArray FileContent = f.readAll();
-  f.close();
-  (*stream) << '\n';
-  //? stream->writeRawBytes(FileContent.data(), FileContent.size());
-  (*stream) << FileContent.data();
   (*stream) << '\n';
   return true;
 }
@@ -34,6 +34,7 @@ public:
   bool createSubNetlist(QTextStream *);
   QString getErrorText() { return ErrText; }
   QString getSubcircuitFile();
+  QByteArray symbolKey() { return QByteArray(); }  // read from file
 
 protected:
   QString vhdlCode(int);
@@ -0,0 +1,79 @@
+/*
+ * connectivity.cpp - union-find over the nodes of a schematic
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "connectivity.h"
+#include "node.h"
+
+void Connectivity::clear()
+{
+  Nodes.clear();
+  Parent.clear();
+  Size.clear();
+  Index.clear();
+}
+
+// ---------------------------------------------------------------------
+// add a node as a set of its own, returns its number.
+int Connectivity::add(Node *pn)
+{
+  int i = Index.value(pn, -1);
+  if(i >= 0)  return i;
+
+  i = Nodes.size();
+  Nodes.append(pn);
+  Parent.append(i);
+  Size.append(1);
+  Index.insert(pn, i);
+  return i;
+}
+
+// ---------------------------------------------------------------------
+int Connectivity::find(int i) const
+{
+  while(Parent[i] != i) {
+    Parent[i] = Parent[Parent[i]];   // path halving
+    i = Parent[i];
+  }
+  return i;
+}
+
+// ---------------------------------------------------------------------
+int Connectivity::find(Node *pn) const
+{
+  int i = index(pn);
+  if(i < 0)  return -1;
+  return find(i);
+}
+
+// ---------------------------------------------------------------------
+void Connectivity::unite(int i, int j)
+{
+  i = find(i);
+  j = find(j);
+  if(i == j)  return;
+
+  if(Size[i] < Size[j])  qSwap(i, j);
+  Parent[j] = i;
+  Size[i] += Size[j];
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,60 @@
+/*
+ * connectivity.h - union-find over the nodes of a schematic
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CONNECTIVITY_H_
+#define CONNECTIVITY_H_ value
+
+#include <QHash>
+#include <QVector>
+
+class Node;
+
+/*!
+ * disjoint sets of nodes, e.g. the wired regions named by
+ * Schematic::throughAllNodes(). nodes are numbered in the order they are
+ * added, find() returns the number of the representative node of a set,
+ * -1 for a node never added. unite() adds unknown nodes. union by size
+ * and path halving keep every operation almost constant in time.
+ */
+class Connectivity {
+public:
+  Connectivity() {}
+
+  void clear();
+  int  add(Node*);
+  int  index(Node *pn) const { return Index.value(pn, -1); }
+  Node* node(int i) const { return Nodes.at(i); }
+  int  size() const { return Nodes.size(); }
+
+  int  find(int) const;
+  int  find(Node*) const;
+  void unite(int, int);
+  void unite(Node *p1, Node *p2) { unite(add(p1), add(p2)); }
+
+private:
+  QVector<Node*> Nodes;
+  mutable QVector<int> Parent;
+  QVector<int> Size;
+  QHash<Node*, int> Index;
+};
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * binarydataset.cpp - memory mapped binary sidecar of a simulation dataset
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "binarydataset.h"
+#include "datasetcache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+
+#define BINDATASET_MAGIC  "QUCSBIN1"
+#define BINDATASET_CHUNK  4096   // doubles written at once
+
+BinaryDataSet::BinaryDataSet(const QString& fileName)
+  : File(fileName), Map(0), SourceSize(-1), SourceTime(0)
+{
+}
+
+BinaryDataSet::~BinaryDataSet()
+{
+  if(Map)
+    File.unmap(Map);
+}
+
+// ---------------------------------------------------------------------
+QString BinaryDataSet::sidecarName(const QString& datFile)
+{
+  QFileInfo Info(datFile);
+  return Info.path() + QDir::separator() + "." + Info.fileName() + ".bin";
+}
+
+// ---------------------------------------------------------------------
+bool BinaryDataSet::isCurrent(const QFileInfo& datFile) const
+{
+  return (datFile.size() == SourceSize)
+      && (datFile.lastModified().toTime_t() == SourceTime);
+}
+
+// ---------------------------------------------------------------------
+BinaryDataSet::Column const* BinaryDataSet::find(const QString& name) const
+{
+  QHash<QString, Column>::const_iterator i = Columns.constFind(name);
+  if(i == Columns.constEnd()) return NULL;
+  return &i.value();
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * map the sidecar of datFile. returns a null pointer if there is none,
+ * if it is out of date or if the host cannot use little-endian doubles.
+ */
+BinaryDataSetPtr BinaryDataSet::open(const QString& datFile)
+{
+  if(QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+    return BinaryDataSetPtr();
+
+  QFileInfo Info(datFile);
+  QSharedPointer<BinaryDataSet> b(new BinaryDataSet(sidecarName(datFile)));
+  if(!b->File.open(QIODevice::ReadOnly))
+    return BinaryDataSetPtr();
+
+  qint64 size = b->File.size();
+  if(size < 16)  return BinaryDataSetPtr();
+  b->Map = b->File.map(0, size);
+  b->File.close();   // the mapping stays valid
+  if(!b->Map)  return BinaryDataSetPtr();
+
+  const char *p = (const char*)b->Map;
+  if(strncmp(p, BINDATASET_MAGIC, 8) != 0)  return BinaryDataSetPtr();
+  quint64 headerSize;
+  memcpy(&headerSize, p+8, 8);
+  if(headerSize > quint64(size-16))  return BinaryDataSetPtr();
+  qint64 dataStart = (16 + headerSize + 7) & ~qint64(7);
+
+  QByteArray Header = QByteArray::fromRawData(p+16, headerSize);
+  QDataStream stream(Header);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  quint32 n;
+  stream >> b->SourceSize >> b->SourceTime >> n;
+  if(!b->isCurrent(Info))  return BinaryDataSetPtr();   // stale
+
+  QString Name;
+  Column c;
+  qint32 count;
+  quint64 offset;
+  for(; n>0; n--) {
+    stream >> Name >> c.isIndep >> c.dependencies >> count >> offset;
+    if(stream.status() != QDataStream::Ok)  return BinaryDataSetPtr();
+
+    qint64 bytes = qint64(count) * (c.isIndep ? 8 : 16);
+    if(dataStart + qint64(offset) + bytes > size)  return BinaryDataSetPtr();
+    c.count = count;
+    c.data  = (const double*)(p + dataStart + offset);
+    b->Columns.insert(Name, c);
+  }
+
+  return b;
+}
+
+// ---------------------------------------------------------------------
+// number of samples of a variable, -1 if it cannot be stored.
+static int columnCount(CachedDataSet const& Data, const QString& Name)
+{
+  CachedDataSet::Variable const* v = Data.find(Name);
+  if(!v)  return -1;
+  if(v->isIndep)  return v->dependencies.toInt();
+  if(Name.right(2) == ".X")  return -1;   // digital
+
+  int n = 1;
+  QStringList Deps = v->dependencies.split(' ', QString::SkipEmptyParts);
+  foreach(QString Dep, Deps) {
+    CachedDataSet::Variable const* d = Data.find(Dep);
+    if(!d)  return -1;
+    if(!d->isIndep) {   // dependent variable used as axis
+      if(d->dependencies.indexOf(' ') >= 0)  return -1;
+      d = Data.find(d->dependencies);
+      if(!d)  return -1;
+      if(!d->isIndep)  return -1;
+    }
+    n *= d->dependencies.toInt();
+  }
+  return n;
+}
+
+// parse n real (or complex) numbers and append them to the file.
+static bool writeColumn(QFile& file, const char *pPos, int n, bool isComplex)
+{
+  double Buffer[BINDATASET_CHUNK];
+  double *p = Buffer, *pStop = Buffer + BINDATASET_CHUNK;
+  char *pEnd;
+
+  for(int z=n; z>0; z--) {
+    while((*pPos) && (*pPos <= ' '))  pPos++; // find start of next number
+    pEnd = 0;
+    *(p++) = CachedDataSet::toDouble(pPos, &pEnd);  // real part
+    if(pPos == pEnd)  return false;
+
+    if(isComplex) {
+      pPos = pEnd + 1;
+      if(*pEnd < ' ')   // is there an imaginary part ?
+        *(p++) = 0.0;
+      else {
+        if(((*pEnd != '+') && (*pEnd != '-')) || (*pPos != 'j'))
+          return false;
+        *p = CachedDataSet::toDouble(pPos+1, &pEnd);
+        if(*(pPos-1) == '-')  *p = -*p;
+        p++;
+      }
+    }
+    pPos = pEnd;
+
+    if(p >= pStop) {
+      if(file.write((const char*)Buffer, (p-Buffer)*sizeof(double)) < 0)
+        return false;
+      p = Buffer;
+    }
+  }
+
+  if(p > Buffer)
+    if(file.write((const char*)Buffer, (p-Buffer)*sizeof(double)) < 0)
+      return false;
+  return true;
+}
+
+/*!
+ * convert all analog variables of an indexed .dat file into its sidecar.
+ * the file is written under a temporary name and renamed when complete.
+ */
+bool BinaryDataSet::write(CachedDataSet const& Data, const QString& datFile)
+{
+  if(QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+    return false;
+
+  QFileInfo Info(datFile);
+  QStringList Names;
+  QVector<int> Counts;
+  foreach(QString Name, Data.variables()) {
+    int n = columnCount(Data, Name);
+    if(n <= 0)  continue;
+    Names.append(Name);
+    Counts.append(n);
+  }
+
+  QByteArray Header;
+  QDataStream stream(&Header, QIODevice::WriteOnly);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream << qint64(Info.size()) << quint32(Info.lastModified().toTime_t())
+         << quint32(Names.size());
+
+  quint64 offset = 0;
+  for(int i=0; i<Names.size(); i++) {
+    CachedDataSet::Variable const* v = Data.find(Names.at(i));
+    stream << Names.at(i) << v->isIndep << v->dependencies
+           << qint32(Counts.at(i)) << offset;
+    offset += quint64(Counts.at(i)) * (v->isIndep ? 8 : 16);
+  }
+
+  QString Sidecar = sidecarName(datFile);
+  QString Temp = Sidecar + "." + QString::number(QCoreApplication::applicationPid())
+               + "." + QString::number(quintptr(QThread::currentThreadId()));
+  QFile file(Temp);
+  if(!file.open(QIODevice::WriteOnly))  return false;
+
+  quint64 headerSize = Header.size();
+  qint64 dataStart = (16 + headerSize + 7) & ~qint64(7);
+  file.write(BINDATASET_MAGIC, 8);
+  file.write((const char*)&headerSize, 8);
+  file.write(Header);
+  while(file.pos() < dataStart)
+    file.putChar(0);
+
+  bool ok = true;
+  for(int i=0; ok && (i<Names.size()); i++) {
+    CachedDataSet::Variable const* v = Data.find(Names.at(i));
+    ok = writeColumn(file, Data.data(*v), Counts.at(i), !v->isIndep);
+  }
+  file.close();
+
+  if(ok)  ok = (file.error() == QFile::NoError);
+  if(ok) {
+    QFile::remove(Sidecar);
+    ok = QFile::rename(Temp, Sidecar);
+  }
+  if(!ok) {
+    QFile::remove(Temp);
+    qDebug() << "BinaryDataSet: cannot write" << Sidecar;
+  }
+  return ok;
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,78 @@
+/*
+ * binarydataset.h - memory mapped binary sidecar of a simulation dataset
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BINARYDATASET_H_
+#define BINARYDATASET_H_ value
+
+#include <QFile>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+
+class QFileInfo;
+class CachedDataSet;
+
+/*!
+ * columnar copy of a .dat file, stored next to it as ".<name>.dat.bin".
+ *
+ * the file starts with the magic "QUCSBIN1" and the size of the header,
+ * followed by the header (source size and time, then name, kind,
+ * dependencies, number of samples and data offset of each variable).
+ * the data section is 8 byte aligned and holds little-endian doubles,
+ * one per sample for independent variables and real/imaginary pairs
+ * for dependent ones. the whole file is mapped read-only, so Graph and
+ * DataX point right into it.
+ *
+ * digital variables (".X") are not stored, they are read from the
+ * .dat file as before.
+ */
+class BinaryDataSet {
+public:
+  struct Column {
+    bool    isIndep;
+    QString dependencies; // names of the independent variables
+    int     count;        // number of samples
+    const double *data;   // indep: count values, dep: count complex pairs
+  };
+
+  ~BinaryDataSet();
+
+  static QString sidecarName(const QString& datFile);
+  static QSharedPointer<const BinaryDataSet> open(const QString& datFile);
+  static bool write(CachedDataSet const&, const QString& datFile);
+
+  bool isCurrent(const QFileInfo& datFile) const;
+  Column const* find(const QString& name) const;
+
+private:
+  BinaryDataSet(const QString& fileName);
+
+  QFile  File;
+  uchar *Map;
+  qint64 SourceSize;
+  uint   SourceTime;
+  QHash<QString, Column> Columns;
+};
+
+typedef QSharedPointer<const BinaryDataSet> BinaryDataSetPtr;
+
+#endif
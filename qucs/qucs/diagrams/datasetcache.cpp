@@ -0,0 +1,377 @@
+/*
+ * datasetcache.cpp - process wide cache of indexed simulation datasets
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "datasetcache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QWaitCondition>
+
+CachedDataSet::CachedDataSet(const QString& fileName,
+      const QByteArray& content, const QDateTime& lastModified)
+  : FileName(fileName),
+    Content(content),
+    LastModified(lastModified),
+    Valid(false)
+{
+  buildIndex();
+}
+
+// ---------------------------------------------------------------------
+CachedDataSet::Variable const* CachedDataSet::find(const QString& name) const
+{
+  QHash<QString, Variable>::const_iterator i = Index.constFind(name);
+  if(i == Index.constEnd()) return NULL;
+  return &i.value();
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * scan the file once and remember where each variable starts. values
+ * never contain '<', so the data blocks are skipped using memchr.
+ */
+void CachedDataSet::buildIndex()
+{
+  const char *s = Content.constData();
+  const char *e = s + Content.size();
+
+  // a dataset that is still being written does not end with '>'
+  const char *last = e;
+  while((last > s) && (*(last-1) <= ' ')) last--;
+  if((last == s) || (*(last-1) != '>'))  return;
+
+  const char *p = s;
+  while((p = (const char*)memchr(p, '<', e-p))) {
+    const char *close = (const char*)memchr(p, '>', e-p);
+    if(!close)  return;   // file corrupt
+
+    if(*(p+1) != '/') {
+      QString Tag = QString::fromLatin1(p+1, close-p-1);
+      QString Kind = Tag.section(' ', 0, 0);
+      if((Kind == "dep") || (Kind == "indep")) {
+        Variable v;
+        v.isIndep = (Kind == "indep");
+        v.dependencies = Tag.section(' ', 2);
+        v.begin = close+1 - s;
+        const char *next = (const char*)memchr(close, '<', e-close);
+        if(!next) next = e;
+        v.end = next - s;
+
+        // first definition wins, as it did with strstr
+        QString Name = Tag.section(' ', 1, 1);
+        if(!Index.contains(Name))
+          Index.insert(Name, v);
+
+        p = next;
+        continue;
+      }
+    }
+    p = close+1;
+  }
+
+  Valid = true;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * the number of samples of a variable, i.e. the product of the sizes of
+ * its independent variables. returns -1 if one of those is missing.
+ */
+int CachedDataSet::count(Variable const& v) const
+{
+  if(v.isIndep)  return v.dependencies.toInt();
+
+  int n = 1;
+  foreach(QString Dep, v.dependencies.split(' ', QString::SkipEmptyParts)) {
+    Variable const* d = find(Dep);
+    if(!d || !d->isIndep)  return -1;
+    n *= d->dependencies.toInt();
+  }
+  return n;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * strtod() with '.' as decimal point whatever LC_NUMERIC is. datasets
+ * are parsed in worker threads, which must not call setlocale().
+ */
+double CachedDataSet::toDouble(const char *pPos, char **pEnd)
+{
+#ifdef __MINGW32__
+  static _locale_t C = _create_locale(LC_NUMERIC, "C");
+  return _strtod_l(pPos, pEnd, C);
+#else
+  static locale_t C = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+  return strtod_l(pPos, pEnd, C);
+#endif
+}
+
+// ---------------------------------------------------------------------
+// parse n values, real/imaginary pairs if "complex", like loadDatFile()
+static bool parseValues(const char *pPos, int n, bool complex,
+                        QVector<double>& values)
+{
+  char *pEnd;
+  double x, y;
+  values.resize(complex ? 2*n : n);
+  double *p = values.data();
+
+  for(int z=n; z>0; z--) {
+    while((*pPos) && (*pPos <= ' '))  pPos++; // find start of next number
+    x = CachedDataSet::toDouble(pPos, &pEnd);  // real part
+    if(pEnd == pPos)  return false;
+    if(!complex) {
+      *(p++) = x;
+      pPos = pEnd;
+      continue;
+    }
+
+    pPos = pEnd + 1;
+    if(*pEnd < ' ')   // is there an imaginary part ?
+      y = 0.0;
+    else {
+      if(((*pEnd != '+') && (*pEnd != '-')) || (*pPos != 'j'))
+        return false;
+      // imaginary part, sign is in front of 'j'
+      y = CachedDataSet::toDouble(pPos+1, &pEnd);
+      if(*(pPos-1) == '-')  y = -y;
+      pPos = pEnd;
+    }
+    *(p++) = x;
+    *(p++) = y;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * parse the values of many variables at once, plus the independent
+ * variables they depend on. the data blocks are visited in file order,
+ * so this is a single pass over the dataset however many variables are
+ * asked for. missing, incomplete and digital variables are left out.
+ */
+QHash<QString, CachedDataSet::Column>
+CachedDataSet::columns(const QStringList& names) const
+{
+  QMap<int, QString> Blocks;   // offset -> variable
+  foreach(QString Name, names) {
+    Variable const* v = find(Name);
+    if(!v || Name.endsWith(".X"))  continue;
+    Blocks.insert(v->begin, Name);
+    if(v->isIndep)  continue;
+    foreach(QString Dep, v->dependencies.split(' ', QString::SkipEmptyParts)) {
+      Variable const* d = find(Dep);
+      if(d)  Blocks.insert(d->begin, Dep);
+    }
+  }
+
+  QHash<QString, Column> Result;
+  QMap<int, QString>::const_iterator it;
+  for(it = Blocks.constBegin(); it != Blocks.constEnd(); ++it) {
+    Variable const* v = find(it.value());
+    int n = count(*v);
+    if(n < 0)  continue;
+
+    Column c;
+    c.isIndep = v->isIndep;
+    c.dependencies = v->dependencies;
+    if(parseValues(data(*v), n, !v->isIndep, c.values))
+      Result.insert(it.value(), c);
+  }
+  return Result;
+}
+
+// ---------------------------------------------------------------------
+static QMutex CacheMutex;
+static QHash<QString, DataSetPtr> CacheEntries;
+static QList<QString> CacheRecent;   // most recently used first
+static qint64 CacheLimit = 256*1024*1024;
+static QHash<QString, BinaryDataSetPtr> CacheBinaries;
+static QSet<QString> CacheLoading;   // files being read right now
+static QSet<QString> CacheConverting;   // sidecars being written right now
+static QWaitCondition CacheLoaded;
+static QHash<QString, int> CacheGeneration;   // bumped by invalidate()
+
+static void evictDataSets()
+{
+  qint64 total = 0;
+  foreach(DataSetPtr d, CacheEntries)
+    total += d->size();
+
+  // the most recently used dataset is always kept
+  while((total > CacheLimit) && (CacheRecent.size() > 1)) {
+    QString key = CacheRecent.takeLast();
+    total -= CacheEntries.value(key)->size();
+    CacheEntries.remove(key);
+  }
+}
+
+/*!
+ * return the indexed contents of fileName, reading the file only if it is
+ * not cached or has changed on disk. returns a null pointer if the file
+ * cannot be read or is incomplete.
+ */
+DataSetPtr DataSetCache::get(const QString& fileName)
+{
+  QFileInfo Info(fileName);
+  if(!Info.exists())  return DataSetPtr();
+
+  QString key = Info.absoluteFilePath();
+  int generation;
+
+  {
+    QMutexLocker lock(&CacheMutex);
+    // the first caller reads the file, the others wait for it
+    while(CacheLoading.contains(key))
+      CacheLoaded.wait(&CacheMutex);
+
+    Info.refresh();
+    DataSetPtr d = CacheEntries.value(key);
+    if(d && (d->lastModified() == Info.lastModified())
+         && (d->size() == Info.size())) {
+      CacheRecent.removeOne(key);
+      CacheRecent.prepend(key);
+      return d;
+    }
+    CacheLoading.insert(key);
+    generation = CacheGeneration.value(key);
+  }
+
+  // read outside the lock, other datasets remain available meanwhile.
+  DataSetPtr d;
+  QFile file(key);
+  if(file.open(QIODevice::ReadOnly)) {
+    d = DataSetPtr(new CachedDataSet(key, file.readAll(), Info.lastModified()));
+    file.close();
+    if(!d->isValid())  d.clear();
+  }
+
+  QMutexLocker lock(&CacheMutex);
+  CacheLoading.remove(key);
+  CacheLoaded.wakeAll();
+  // keep a dataset invalidated while reading for this caller only
+  if(!d || (generation != CacheGeneration.value(key)))  return d;
+  CacheEntries.insert(key, d);
+  CacheRecent.removeOne(key);
+  CacheRecent.prepend(key);
+  evictDataSets();
+  return d;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * forget fileName and delete its binary sidecar, e.g. after a simulation
+ * has written it or before it is deleted. modification time and size
+ * alone do not tell a dataset rewritten within the same second with the
+ * same size.
+ */
+void DataSetCache::invalidate(const QString& fileName)
+{
+  QString key = QFileInfo(fileName).absoluteFilePath();
+  QMutexLocker lock(&CacheMutex);
+  while(CacheConverting.contains(key))
+    CacheLoaded.wait(&CacheMutex);
+  CacheEntries.remove(key);
+  CacheRecent.removeOne(key);
+  CacheBinaries.remove(key);
+  CacheGeneration[key]++;
+  QFile::remove(BinaryDataSet::sidecarName(key));
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * return the mapped binary sidecar of fileName, converting the text
+ * dataset if the sidecar is missing or out of date. returns a null
+ * pointer if that is not possible, e.g. in a read-only directory.
+ *
+ * the sidecar is normally written right after the simulation, see
+ * QucsApp::slotAfterSimulation(). only one caller converts a dataset,
+ * the others wait for the result.
+ */
+BinaryDataSetPtr DataSetCache::getBinary(const QString& fileName)
+{
+  QFileInfo Info(fileName);
+  if(!Info.exists())  return BinaryDataSetPtr();
+
+  QString key = Info.absoluteFilePath();
+  {
+    QMutexLocker lock(&CacheMutex);
+    while(CacheConverting.contains(key))
+      CacheLoaded.wait(&CacheMutex);
+
+    Info.refresh();
+    BinaryDataSetPtr b = CacheBinaries.value(key);
+    if(b && b->isCurrent(Info))
+      return b;
+    CacheConverting.insert(key);
+  }
+
+  BinaryDataSetPtr b = BinaryDataSet::open(key);
+  if(!b) {
+    DataSetPtr Data = get(key);
+    if(Data && BinaryDataSet::write(*Data, key))
+      b = BinaryDataSet::open(key);
+  }
+
+  QMutexLocker lock(&CacheMutex);
+  CacheConverting.remove(key);
+  CacheLoaded.wakeAll();
+  if(b)  CacheBinaries.insert(key, b);
+  return b;
+}
+
+// ---------------------------------------------------------------------
+void DataSetCache::clear()
+{
+  QMutexLocker lock(&CacheMutex);
+  CacheEntries.clear();
+  CacheRecent.clear();
+  CacheBinaries.clear();
+}
+
+// ---------------------------------------------------------------------
+void DataSetCache::setLimit(qint64 bytes)
+{
+  QMutexLocker lock(&CacheMutex);
+  CacheLimit = bytes;
+  evictDataSets();
+}
+
+// ---------------------------------------------------------------------
+qint64 DataSetCache::limit()
+{
+  QMutexLocker lock(&CacheMutex);
+  return CacheLimit;
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,109 @@
+/*
+ * datasetcache.h - process wide cache of indexed simulation datasets
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DATASETCACHE_H_
+#define DATASETCACHE_H_ value
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "binarydataset.h"
+
+/*!
+ * a .dat file read into memory once, together with an index
+ * of its variables. instances are immutable after construction
+ * and may be shared by any number of graphs.
+ */
+class CachedDataSet {
+public:
+  struct Variable {
+    bool    isIndep;
+    QString dependencies; // indep: number of values, dep: indep variables
+    int     begin;        // offset of the first data character
+    int     end;          // offset of the closing tag
+  };
+
+  // the parsed values of a variable, see columns()
+  struct Column {
+    bool    isIndep;
+    QString dependencies;
+    QVector<double> values; // indep: one per sample, dep: real/imag pairs
+  };
+
+  CachedDataSet(const QString& fileName, const QByteArray& content,
+                const QDateTime& lastModified);
+
+  bool isValid() const { return Valid; }
+  QString fileName() const { return FileName; }
+  QDateTime lastModified() const { return LastModified; }
+  qint64 size() const { return Content.size(); }
+
+  Variable const* find(const QString& name) const;
+  QList<QString> variables() const { return Index.keys(); }
+  int count(Variable const&) const;
+  QHash<QString, Column> columns(const QStringList& names) const;
+  static double toDouble(const char*, char**);
+
+  // NUL terminated, data() + v.begin is the start of the values of v.
+  const char* data() const { return Content.constData(); }
+  const char* data(Variable const& v) const { return Content.constData() + v.begin; }
+
+private:
+  void buildIndex();
+
+  QString    FileName;
+  QByteArray Content;
+  QDateTime  LastModified;
+  QHash<QString, Variable> Index;
+  bool       Valid;
+};
+
+typedef QSharedPointer<const CachedDataSet> DataSetPtr;
+
+/*!
+ * maps absolute file names to CachedDataSet. an entry is reused as
+ * long as modification time and size of the file are unchanged.
+ * least recently used entries are dropped once the total size exceeds
+ * limit(). the cache is safe to use from several threads, a file is read
+ * once however many ask for it at the same time. a simulation must
+ * invalidate() the dataset it writes, as must whoever deletes it.
+ *
+ * getBinary() maps the binary sidecar of a dataset instead, creating or
+ * refreshing it from the text file first if necessary.
+ */
+class DataSetCache {
+public:
+  static DataSetPtr get(const QString& fileName);
+  static BinaryDataSetPtr getBinary(const QString& fileName);
+  static void invalidate(const QString& fileName);
+  static void clear();
+  static void setLimit(qint64 bytes);
+  static qint64 limit();
+};
+
+#endif
@@ -33,7 +33,6 @@
 #if HAVE_IEEEFP_H
 # include <ieeefp.h>
 #endif
-#include <locale.h>
 
 #include "diagram.h"
 #include "qucs.h"
@@ -41,6 +40,9 @@
 #include "schematic.h"
 
 #include "rect3ddiagram.h"
+#include "datasetcache.h"
+#include "graphloader.h"
+#include "digitalwave.h"
 #include "misc.h"
 
 #include <QTextStream>
@@ -91,6 +93,7 @@ Diagram::Diagram(int _cx, int _cy)
 
 Diagram::~Diagram()
 {
+  GraphLoader::instance()->cancel(this);
   if(freq!=nullptr) delete[] freq;
   freq= nullptr;
 }
@@ -513,6 +516,15 @@ void Diagram::calcData(Graph *g)
   if(xAxis.autoScale)  if(yAxis.autoScale)  if(zAxis.autoScale)
     Counter = -50000;
 
+  // lines with many more samples than pixels are thinned out
+  bool Decimate = false;
+  if(g->Style <= GRAPHSTYLE_LONGDASH)
+    if(int(g->count(0)) > 2*DECIMATION_COLUMNS*x2) {
+      Decimate = true;
+      int s = (4*DECIMATION_COLUMNS*(x2+2) + 10) * g->countY + 10;
+      if(s < Size)  Size = s;
+    }
+
   double Dummy = 0.0;  // not used
   double *py = &Dummy;
 
@@ -536,18 +548,22 @@ void Diagram::calcData(Graph *g)
 
       for(i=g->countY; i>0; i--) {  // every branch of curves
 	px = g->axis(0)->Points;
-	calcCoordinateP(px, pz, py, p, pa);
-	++px;
-	pz += 2;
-	++p;
-	for(z=g->axis(0)->count-1; z>0; z--) {  // every point
-	  FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+	if(Decimate)
+	  calcDecimatedData(g, px, pz, p, p_end, Size, pa, Counter >= 2);
+	else {
 	  calcCoordinateP(px, pz, py, p, pa);
 	  ++px;
 	  pz += 2;
 	  ++p;
-	  if(Counter >= 2)   // clipping only if an axis is manual
-	    clip(p);
+	  for(z=g->axis(0)->count-1; z>0; z--) {  // every point
+	    FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+	    calcCoordinateP(px, pz, py, p, pa);
+	    ++px;
+	    pz += 2;
+	    ++p;
+	    if(Counter >= 2)   // clipping only if an axis is manual
+	      clip(p);
+	  }
 	}
 	if((p-3)->isStrokeEnd() && !(p-3)->isBranchEnd())
 	  p -= 3;  // no single point after "no stroke"
@@ -589,6 +605,73 @@ for(int zz=0; zz<60; zz+=2)
   // unreachable
 }
 
+// ------------------------------------------------------------
+// screen column of a sample, clamped to stay within int range
+static inline int decimationColumn(float x)
+{
+  x *= float(DECIMATION_COLUMNS);
+  if(x < -1e7)  return -10000000;
+  if(x >  1e7)  return  10000000;
+  return int(floor(x));
+}
+
+/*!
+   Screen points of one branch that has many more samples than the
+   diagram has pixels. Of each run of samples within the same screen
+   column only the first, the lowest, the highest and the last one are
+   kept, in their original order. The line through them covers the same
+   pixels as the line through all samples, so painting scales with the
+   width of the diagram. Markers still use the data, not these points.
+*/
+void Diagram::calcDecimatedData(Graph *g, double *&px, double *&pz,
+	Graph::iterator &p, Graph::iterator &p_end, int &Size,
+	Axis const *pa, bool clipping) const
+{
+  struct { int n; float x, y; } s[4], t;  // first, lowest, highest, last
+  double Dummy = 0.0;  // not used
+  float fx=0.0, fy=0.0;
+  int k, Last, Column=0, Emitted=0;
+  int count = g->axis(0)->count;
+
+  for(int n=0; n<=count; n++) {
+    if(n < count) {
+      calcCoordinate(px, pz, &Dummy, &fx, &fy, pa);
+      ++px;
+      pz += 2;
+      if((n > 0) && (decimationColumn(fx) == Column)) {  // same column ?
+        t.n = n;  t.x = fx;  t.y = fy;
+        if(fy < s[1].y)  s[1] = t;
+        if(fy > s[2].y)  s[2] = t;
+        s[3] = t;
+        continue;
+      }
+    }
+
+    if(n > 0) {   // write envelope of the previous column
+      if(s[1].n > s[2].n) {
+        t = s[1];  s[1] = s[2];  s[2] = t;
+      }
+      Last = -1;
+      for(k=0; k<4; k++) {
+        if(s[k].n == Last)  continue;  // same sample twice
+        Last = s[k].n;
+        if(Emitted++ > 0)
+          FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+        p->setScr(s[k].x, s[k].y);
+        ++p;
+        if(Emitted > 1)  if(clipping)
+          clip(p);
+      }
+    }
+
+    if(n < count) {   // start a new column
+      Column = decimationColumn(fx);
+      s[0].n = n;  s[0].x = fx;  s[0].y = fy;
+      s[1] = s[2] = s[3] = s[0];
+    }
+  }
+}
+
 // -------------------------------------------------------
 void Diagram::Bounding(int& _x1, int& _y1, int& _x2, int& _y2)
 {
@@ -698,6 +781,8 @@ void Diagram::getAxisLimits(Graph *pg)
 // --------------------------------------------------------------------------
 void Diagram::loadGraphData(const QString& defaultDataSet)
 {
+  GraphLoader::instance()->cancel(this);   // would be outdated
+
   int yNum = yAxis.numGraphs;
   int zNum = zAxis.numGraphs;
   yAxis.numGraphs = zAxis.numGraphs = 0;
@@ -738,6 +823,42 @@ void Diagram::loadGraphData(const QString& defaultDataSet)
   updateGraphData();
 }
 
+/*!
+   Take over graph data loaded by a GraphLoadJob. "Loaded" holds one
+   graph per graph of this diagram, NULL if its dataset is unchanged.
+   "Limits" contains the axis limits of the loaded graphs, the limits
+   of the unchanged graphs are added here.
+*/
+void Diagram::takeGraphData(QList<Graph*> const& Loaded, Diagram const& Limits)
+{
+  if(Loaded.size() != Graphs.size())  return;   // graphs edited meanwhile
+  if(Loaded.count(NULL) == Loaded.size())
+    return;    // all dataset files unchanged -> no update neccessary
+
+  xAxis.min = Limits.xAxis.min;  xAxis.max = Limits.xAxis.max;
+  yAxis.min = Limits.yAxis.min;  yAxis.max = Limits.yAxis.max;
+  zAxis.min = Limits.zAxis.min;  zAxis.max = Limits.zAxis.max;
+  yAxis.numGraphs = Limits.yAxis.numGraphs;
+  zAxis.numGraphs = Limits.zAxis.numGraphs;
+
+  for(int i=0; i<Graphs.size(); i++) {
+    Graph *pg = Graphs.at(i);
+    if(Loaded.at(i))
+      pg->takeData(*Loaded.at(i));
+    else
+      getAxisLimits(pg);
+  }
+
+  if(xAxis.min > xAxis.max)
+    xAxis.min = xAxis.max = 0.0;
+  if(yAxis.min > yAxis.max)
+    yAxis.min = yAxis.max = 0.0;
+  if(zAxis.min > zAxis.max)
+    zAxis.min = zAxis.max = 0.0;
+
+  updateGraphData();
+}
+
 /*!
    Calculate diagram again without reading dataset from file.
 */
@@ -780,10 +901,8 @@ void Diagram::updateGraphData()
     pg->clear();
     if((valid & (pg->yAxisNo+1)) != 0)
       calcData(pg);   // calculate screen coordinates
-    else if(pg->cPointsY) {
-      delete[] pg->cPointsY;
-      pg->cPointsY = 0;
-    }
+    else
+      pg->clearPointsY();
   }
 
   createAxisLabels();  // virtual function
@@ -801,6 +920,9 @@ void Diagram::updateGraphData()
  * this way, it would belong to graph.cpp. but it's too obsolete, lets see..
  *
  * FIXME: must invalidate markers.
+ *
+ * the numbers are read with CachedDataSet::toDouble(), which ignores
+ * LC_NUMERIC, so this is safe in a GraphLoadJob.
  */
 int Graph::loadDatFile(const QString& fileName)
 {
@@ -814,10 +936,6 @@ int Graph::loadDatFile(const QString& fileName)
 //    if(pos > g->Var.indexOf('['))
 //      pos = -1;
 
-  /* WORK-AROUND: A bug in SCIM (libscim) which Qt is linked to causes
-     to change the locale to the default. */
-  setlocale (LC_NUMERIC, "C");
-
   if(pos <= 0) {
     file.setFileName(fileName);
     Variable = g->Var;
@@ -833,8 +951,9 @@ int Graph::loadDatFile(const QString& fileName)
       return 1;    // dataset unchanged -> no update neccessary
 
   g->countY = 0;
+  qDeleteAll(g->mutable_axes()); // they may keep a mapped dataset alive
   g->mutable_axes().clear(); // HACK
-  if(g->cPointsY) { delete[] g->cPointsY;  g->cPointsY = 0; }
+  g->clearPointsY();
   if(Variable.isEmpty()) return 0;
 
 #if 0 // FIXME encapsulation. implement digital waves later.
@@ -843,49 +962,38 @@ int Graph::loadDatFile(const QString& fileName)
       return 0;  // digital variables only for tabulars and ziming diagram
 #endif
 
+  // *****************************************************************
+  // With binary datasets enabled, the values are used right from the
+  // mapped sidecar file, without parsing or copying them.
+  if(QucsSettings.BinaryDataSets)
+    if(Variable.right(2) != ".X") {
+      BinaryDataSetPtr Bin = DataSetCache::getBinary(file.fileName());
+      if(Bin)
+        if(loadBinaryData(Bin, Variable)) {
+          lastLoaded = QDateTime::currentDateTime();
+          return 2;
+        }
+    }
 
-  if(!file.open(QIODevice::ReadOnly))  return 0;
 
   // *****************************************************************
   // To strongly speed up the file read operation the whole file is
-  // read into the memory in one piece.
-  QByteArray FileContent;
-  FileContent = file.readAll();
-  file.close();
-  char *FileString = FileContent.data();
-  if(!FileString)  return 0;
-  char *pPos = FileString+FileContent.size()-1;
-  if(*pPos > ' ')  if(*pPos != '>')  return 0;
-  *pPos = 0;
+  // read into the memory in one piece and indexed. The result is shared
+  // with all other graphs on the same dataset, see DataSetCache.
+  DataSetPtr Data = DataSetCache::get(file.fileName());
+  if(!Data)  return 0;
 
 
   // *****************************************************************
   // look for variable name in data file  ****************************
-  bool isIndep = false;
-  Variable = "dep "+Variable+" ";
+  CachedDataSet::Variable const* Found = Data->find(Variable);
+  if(!Found)  return 0;   // data not found
+
+  bool isIndep = Found->isIndep;
+  QString Line = Found->dependencies, tmp;
   // "pFile" is used through-out the whole function and must NOT used
   // for other purposes!
-  char *pFile = strstr(FileString, Variable.toLatin1());
-  while(pFile) {
-    if(*(pFile-1) == '<')     // is dependent variable ?
-      break;
-    else if(strncmp(pFile-3, "<in", 3) == 0) {  // is independent variable ?
-      isIndep = true;
-      break;
-    }
-    pFile = strstr(pFile+4, Variable.toLatin1());
-  }
-
-  if(!pFile)  return 0;   // data not found
-
-  QString Line, tmp;
-  pFile += Variable.length();
-  pPos = strchr(pFile, '>');
-  if(!pPos)  return 0;   // file corrupt
-  *pPos = 0;
-  Line = QString(pFile);
-  *pPos = '>';
-  pFile = pPos+1;
+  const char *pFile = Data->data(*Found);
   if(!isIndep) {
     pos = 0;
     tmp = Line.section(' ', pos, pos);
@@ -935,7 +1043,7 @@ int Graph::loadDatFile(const QString& fileName)
       }
       else if(pD == bLast)  pa = &yAxis;   // y axis for Rect3D
 #endif
-      counting = loadIndepVarData(pD->Var, FileString, mutable_axis(ii));
+      counting = loadIndepVarData(pD->Var, *Data, mutable_axis(ii));
       if(counting <= 0)  return 0;
 
       g->countY *= counting;
@@ -947,8 +1055,6 @@ int Graph::loadDatFile(const QString& fileName)
   // *****************************************************************
   // get dependent variables *****************************************
   counting  *= g->countY;
-  p = new double[2*counting]; // memory for dependent variables
-  g->cPointsY = p;
 #if 0 // FIXME: what does this do?!
   if(g->yAxisNo == 0)  pa = &yAxis;   // for which axis
   else  pa = &zAxis;
@@ -957,14 +1063,17 @@ int Graph::loadDatFile(const QString& fileName)
 
   char *pEnd;
   double x, y;
-  pPos = pFile;
+  // the dataset is shared, it must not be written to.
+  const char *pPos = pFile;
 
-if(Variable.right(3) != ".X ") { // not "digital"
+if(Variable.right(2) != ".X") { // not "digital"
 
+  p = new double[2*counting]; // memory for dependent variables
+  g->cPointsY = p;
   for(int z=counting; z>0; z--) {
     pEnd = 0;
     while((*pPos) && (*pPos <= ' '))  pPos++; // find start of next number
-    x = strtod(pPos, &pEnd);  // real part
+    x = CachedDataSet::toDouble(pPos, &pEnd);  // real part
     pPos = pEnd + 1;
     if(*pEnd < ' ')   // is there an imaginary part ?
       y = 0.0;
@@ -973,10 +1082,9 @@ if(Variable.right(3) != ".X ") { // not "digital"
         delete[] g->cPointsY;  g->cPointsY = 0;
         return 0;
       }
-      *pPos = *pEnd;  // overwrite 'j' with sign
-      pEnd = 0;
-      y = strtod(pPos, &pEnd); // imaginary part
-      *pPos = 'j';   // write back old character
+      // imaginary part, sign is in front of 'j'
+      y = CachedDataSet::toDouble(pPos+1, &pEnd);
+      if(*(pPos-1) == '-')  y = -y;
       pPos = pEnd;
     }
     *(p++) = x;
@@ -1009,30 +1117,20 @@ if(Variable.right(3) != ".X ") { // not "digital"
 
 } else {  // of "if not digital"
 
-  char *pc = (char*)p;
-  pEnd = pc + 2*(counting-1)*sizeof(double);
   // for digital variables (e.g. 100ZX0):
+  DigitalWave *Wave = new DigitalWave;
+  g->cPointsD = Wave;
   for(int z=counting; z>0; z--) {
 
     while((*pPos) && (*pPos <= ' '))  pPos++; // find start of next bit vector
-    if(*pPos == 0) {
-      delete[] g->cPointsY;  g->cPointsY = 0;
+    const char *pBegin = pPos;
+    while(*pPos > ' ')  pPos++;
+    if(!Wave->append(pBegin, pPos)) {   // none left or of other width
+      delete g->cPointsD;  g->cPointsD = 0;
       return 0;
     }
-
-    while(*pPos > ' ') {    // copy bit vector
-      *(pc++) = *(pPos++);
-      if(pEnd <= pc) {
-        counting = pc - (char*)g->cPointsY;
-        pc = (char*)realloc(g->cPointsY, counting+1024);
-        pEnd = pc;
-        g->cPointsY = (double*)pEnd;
-        pc += counting;
-        pEnd += counting+1020;
-      }
-    }
-    *(pc++) = 0;   // terminate each vector with NULL
   }
+  Wave->squeeze();
 
 }  // of "if not digital"
 
@@ -1044,50 +1142,18 @@ if(Variable.right(3) != ".X ") { // not "digital"
    Reads the data of an independent variable. Returns the number of points.
 */
 int Graph::loadIndepVarData(const QString& Variable,
-			      char *FileString, DataX* pD)
+			      CachedDataSet const& Data, DataX* pD)
 {
-  bool isIndep = false;
-  QString Line, tmp;
-
-  /* WORK-AROUND: A bug in SCIM (libscim) which Qt is linked to causes
-     to change the locale to the default. */
-  setlocale (LC_NUMERIC, "C");
+  CachedDataSet::Variable const* Found = Data.find(Variable);
+  if(!Found)  return -1;   // data not found
 
-  Line = "dep "+Variable+" ";
-  // "pFile" is used through-out the whole function and must NOT used
-  // for other purposes!
-  char *pFile = strstr(FileString, Line.toLatin1());
-  while(pFile) {
-    if(*(pFile-1) == '<')     // is dependent variable ?
-      break;
-    else if(strncmp(pFile-3, "<in", 3) == 0) {  // is independent variable ?
-      isIndep = true;
-      break;
-    }
-    pFile = strstr(pFile+4, Line.toLatin1());
-  }
-
-  if(!pFile)  return -1;   // data not found
-
-  pFile += Line.length();
-  char *pPos = strchr(pFile, '>');
-  if(!pPos)  return -1;   // file corrupt
-  *pPos = 0;
-  Line = QString(pFile);
-  *pPos = '>';
-  pFile = pPos+1;
-  char *pEnd;
-  if(!isIndep) {           // dependent variable can also be used...
+  QString Line = Found->dependencies;
+  if(!Found->isIndep) {    // dependent variable can also be used...
     if(Line.indexOf(' ') >= 0)  return -1; // ...if only one dependency
-    Line = "<indep "+Line+" ";
-    pPos = strstr(FileString, Line.toLatin1());
-    if(!pPos)  return -1;
-    pPos += Line.length();
-    pEnd = strchr(pPos, '>');
-    if(!pEnd)  return -1;   // file corrupt
-    *pEnd = 0;
-    Line = QString(pPos);
-    *pEnd = '>';
+    CachedDataSet::Variable const* Indep = Data.find(Line);
+    if(!Indep)  return -1;
+    if(!Indep->isIndep)  return -1;
+    Line = Indep->dependencies;
   }
 
 
@@ -1102,13 +1168,14 @@ int Graph::loadIndepVarData(const QString& Variable,
 
 
   double x;
-  pPos = pFile;
+  char *pEnd;
+  const char *pPos = Data.data(*Found);
   // find first position containing no whitespace
   while((*pPos) && (*pPos <= ' '))  pPos++;
 
   for(int z=0; z<n; z++) {
     pEnd = 0;
-    x = strtod(pPos, &pEnd);  // real part
+    x = CachedDataSet::toDouble(pPos, &pEnd);  // real part
     if(pPos == pEnd) {
       delete[] pD->Points;  pD->Points = 0;
       return -1;
@@ -1130,6 +1197,65 @@ int Graph::loadIndepVarData(const QString& Variable,
   return n;   // return number of independent data
 }
 
+/*!
+   Lets the graph point into a mapped binary dataset. Returns false if
+   the variable cannot be taken from there, the graph is empty then.
+*/
+bool Graph::loadBinaryData(BinaryDataSetPtr const& Bin, const QString& Variable)
+{
+  BinaryDataSet::Column const* c = Bin->find(Variable);
+  if(!c)  return false;
+
+  int z;
+  if(c->isIndep) {    // create independent variable by myself
+    double *p = new double[c->count];
+    for(z=0; z<c->count; z++)  p[z] = double(z+1);
+    mutable_axes().push_back(new DataX("number", p, c->count));
+
+    countY = 1;       // only real values are stored, so copy them
+    cPointsY = new double[2*c->count];
+    for(z=0; z<c->count; z++) {
+      cPointsY[2*z]   = c->data[z];
+      cPointsY[2*z+1] = 0.0;
+    }
+    return true;
+  }
+
+  bool ok = true;
+  int n = 1;
+  QStringList Deps = c->dependencies.split(' ', QString::SkipEmptyParts);
+  foreach(QString Dep, Deps) {
+    BinaryDataSet::Column const* d = Bin->find(Dep);
+    if(!d) { ok = false;  break; }
+
+    DataX *pD = new DataX(Dep);
+    mutable_axes().push_back(pD);
+    pD->count = d->count;
+    if(d->isIndep) {
+      pD->Points  = const_cast<double*>(d->data);   // never written to
+      pD->Mapping = Bin;
+    }
+    else {   // dependent variable can also be used if only one dependency
+      if(d->dependencies.indexOf(' ') >= 0) { ok = false;  break; }
+      pD->Points = new double[d->count];
+      for(z=0; z<d->count; z++)  pD->Points[z] = d->data[2*z];
+    }
+    n *= pD->count;
+  }
+
+  if(ok)  ok = (numAxes() > 0) && (n == c->count);
+  if(!ok) {
+    foreach(DataX *pD, mutable_axes())  delete pD;
+    mutable_axes().clear();
+    return false;
+  }
+
+  countY = n / count(0);
+  cPointsY = const_cast<double*>(c->data);   // never written to
+  MappedY = Bin;
+  return true;
+}
+
 /*!
    Checks if the two graphs have the same independent variables.
 */
@@ -29,6 +29,10 @@
 
 #define MIN_SCROLLBAR_SIZE 8
 
+// screen columns per diagram pixel used to thin out dense graphs,
+// leaves headroom for zooming and printing
+#define DECIMATION_COLUMNS 4
+
 #define INVALID_STR QObject::tr(" <invalid>")
 
 // ------------------------------------------------------------
@@ -86,6 +90,7 @@ public:
   void getAxisLimits(Graph*);
   void updateGraphData();
   void loadGraphData(const QString&);
+  void takeGraphData(QList<Graph*> const&, Diagram const&);
   void recalcGraphData();
   bool sameDependencies(Graph const*, Graph const*) const;
   int  checkColumnWidth(const QString&, const QFontMetrics&, int, int, int);
@@ -142,6 +147,8 @@ protected:
   void rectClip(Graph::iterator &) const;
 
   virtual void calcData(Graph*);
+  void calcDecimatedData(Graph*, double*&, double*&, Graph::iterator&,
+                         Graph::iterator&, int&, Axis const*, bool) const;
 
 private:
   int Bounding_x1, Bounding_x2, Bounding_y1, Bounding_y2;
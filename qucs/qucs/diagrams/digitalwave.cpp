@@ -0,0 +1,148 @@
+/*
+ * digitalwave.cpp - storage of digital waveforms
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "digitalwave.h"
+
+#include <QtAlgorithms>
+
+const char DigitalWave::Chars[4] = { '0', '1', 'Z', 'X' };
+
+DigitalWave::DigitalWave()
+  : Count(0), Width(0), Entries(0)
+{
+}
+
+// ---------------------------------------------------------------------
+void DigitalWave::clear()
+{
+  Count = Width = Entries = 0;
+  Words.clear();
+  Runs.clear();
+}
+
+// ---------------------------------------------------------------------
+// appends the bit vector [begin, end), e.g. "100ZX0". returns false if
+// its width differs from the first one.
+bool DigitalWave::append(const char *begin, const char *end)
+{
+  int n = end - begin;
+  if(n <= 0)  return false;
+  if(Count == 0)  Width = n;
+  else if(n != Width)  return false;
+
+  quint64 Bits = 2 * quint64(Entries+1) * Width;
+  if(quint64(Words.size()) * 32 < Bits)
+    Words.resize(int((Bits + 31) >> 5));
+
+  for(int i = 0; i < n; i++)
+    switch(begin[i]) {
+      case '0': setCode(Entries, i, Low);  break;
+      case '1': setCode(Entries, i, High);  break;
+      case 'Z':
+      case 'z': setCode(Entries, i, HighZ);  break;
+      default:  setCode(Entries, i, Unknown);
+    }
+
+  // all samples are stored after squeeze() has expanded them
+  bool Flat = (Count > 0) && Runs.isEmpty();
+  if(Flat || (Entries == 0) || !sameEntry(Entries, Entries-1)) {
+    if(!Flat)  Runs.append(Count);
+    Entries++;
+  }
+  Count++;
+  return true;
+}
+
+// ---------------------------------------------------------------------
+// to be called after the last append(). stores every sample if the runs
+// of equal samples do not save at least half of the memory.
+void DigitalWave::squeeze()
+{
+  if(Runs.isEmpty())  return;
+
+  quint64 Compressed = quint64(Runs.size()) * (32 + 2*Width);
+  quint64 Flat = 2 * quint64(Count) * Width;
+  if(2*Compressed > Flat) {
+    QVector<quint32> Packed;
+    qSwap(Packed, Words);
+    QVector<int> Starts;
+    qSwap(Starts, Runs);
+    int n = Entries;
+    Entries = Count;
+    Words.fill(0, int((Flat + 31) >> 5));
+
+    // expand run r into the samples it covers
+    for(int r = 0; r < n; r++) {
+      int Last = (r+1 < n) ? Starts.at(r+1) : Count;
+      for(int bit = 0; bit < Width; bit++) {
+        quint64 pos = 2*(quint64(r)*Width + bit);
+        Level l = Level((Packed.at(int(pos >> 5)) >> (pos & 31)) & 3);
+        for(int z = Starts.at(r); z < Last; z++)
+          setCode(z, bit, l);
+      }
+    }
+  }
+  else
+    Words.resize(int((2 * quint64(Entries) * Width + 31) >> 5));
+
+  Words.squeeze();
+  Runs.squeeze();
+}
+
+// ---------------------------------------------------------------------
+// the bit vector of a sample as text, most significant bit first.
+QString DigitalWave::vector(int sample) const
+{
+  int e = entry(sample);
+  QString s(Width, QChar('0'));
+  for(int bit = 0; bit < Width; bit++)
+    s[bit] = QChar(Chars[code(e, bit)]);
+  return s;
+}
+
+// ---------------------------------------------------------------------
+// the position of a sample in "Words".
+int DigitalWave::entry(int sample) const
+{
+  if(Runs.isEmpty())  return sample;
+  QVector<int>::const_iterator it =
+    qUpperBound(Runs.constBegin(), Runs.constEnd(), sample);
+  return int(it - Runs.constBegin()) - 1;
+}
+
+// ---------------------------------------------------------------------
+void DigitalWave::setCode(int entry, int bit, Level l)
+{
+  quint64 pos = 2*(quint64(entry)*Width + bit);
+  quint32& w = Words[int(pos >> 5)];
+  w = (w & ~(quint32(3) << (pos & 31))) | (quint32(l) << (pos & 31));
+}
+
+// ---------------------------------------------------------------------
+bool DigitalWave::sameEntry(int a, int b) const
+{
+  for(int bit = 0; bit < Width; bit++)
+    if(code(a, bit) != code(b, bit))  return false;
+  return true;
+}
+
+// vim:ts=8:sw=2:et
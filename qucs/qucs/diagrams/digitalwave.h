@@ -0,0 +1,81 @@
+/*
+ * digitalwave.h - storage of digital waveforms
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DIGITALWAVE_H_
+#define DIGITALWAVE_H_ value
+
+#include <QString>
+#include <QVector>
+
+/*!
+ * the values of a digital variable (e.g. "stdl[8:0].X"), a bit vector
+ * of fixed width per sample. every bit takes two bits of memory, the
+ * bit vectors are packed one after the other.
+ *
+ * while loading, a sample equal to its predecessor is not stored again,
+ * only the start of every run of equal samples is remembered. squeeze()
+ * keeps this if it saves at least half of the memory (a long stable
+ * stretch), then a sample is found by a binary search over the runs.
+ * otherwise all samples are stored and found right away.
+ */
+class DigitalWave {
+public:
+  enum Level { Low = 0, High = 1, HighZ = 2, Unknown = 3 };
+
+  DigitalWave();
+
+  void clear();
+  bool append(const char *begin, const char *end);
+  void squeeze();
+
+  int count() const { return Count; }
+  int width() const { return Width; }
+  bool isCompressed() const { return !Runs.isEmpty(); }
+  int countRuns() const { return Runs.isEmpty() ? Count : Runs.size(); }
+
+  Level level(int sample, int bit) const
+    { return code(entry(sample), bit); }
+  char bitChar(int sample, int bit) const
+    { return Chars[level(sample, bit)]; }
+  QString vector(int sample) const;
+
+private:
+  int entry(int sample) const;
+  Level code(int entry, int bit) const {
+    quint64 pos = 2*(quint64(entry)*Width + bit);
+    return Level((Words.at(int(pos >> 5)) >> (pos & 31)) & 3);
+  }
+  void setCode(int entry, int bit, Level);
+  bool sameEntry(int a, int b) const;
+
+  static const char Chars[4];
+
+  int Count;               // number of samples
+  int Width;               // bits per sample
+  int Entries;             // number of bit vectors in "Words"
+  QVector<quint32> Words;  // the packed bit vectors
+  QVector<int> Runs;       // first sample of every entry, if compressed
+};
+
+#endif
+
+// vim:ts=8:sw=2:et
@@ -15,8 +15,11 @@
  *                                                                         *
  ***************************************************************************/
 #include "graph.h"
+#include "digitalwave.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 
 #include <QPainter>
@@ -40,13 +43,54 @@ Graph::Graph(Diagram const* d, const QString& _Line) :
   yAxisNo = 0;   // left y axis
 
   cPointsY = 0;
+  cPointsD = 0;
   gy=NULL;
+  HitSymbols = false;
 }
 
 Graph::~Graph()
 {
-  if(cPointsY != 0)
+  clearPointsY();
+  qDeleteAll(cPointsX);
+}
+
+// ---------------------------------------------------------------------
+// release the dependent data. it is not ours if it lies in a mapped file.
+void Graph::clearPointsY()
+{
+  if(cPointsY && !MappedY)
     delete[] cPointsY;
+  cPointsY = 0;
+  MappedY.clear();
+  delete cPointsD;
+  cPointsD = 0;
+}
+
+// ---------------------------------------------------------------------
+// hand the dependent data over to the caller, who must delete[] it.
+double* Graph::takePointsY()
+{
+  double *p = cPointsY;
+  if(p && MappedY) {   // mapped data cannot be handed over, copy it
+    size_t n = 2 * size_t(countY) * count(0);
+    p = new double[n];
+    memcpy(p, cPointsY, n*sizeof(double));
+  }
+  cPointsY = 0;
+  MappedY.clear();
+  return p;
+}
+
+// ---------------------------------------------------------------------
+// exchange the loaded data with g, e.g. a graph loaded in another thread.
+void Graph::takeData(Graph& g)
+{
+  qSwap(cPointsX, g.cPointsX);
+  qSwap(cPointsY, g.cPointsY);
+  qSwap(cPointsD, g.cPointsD);
+  qSwap(MappedY, g.MappedY);
+  qSwap(countY, g.countY);
+  qSwap(lastLoaded, g.lastLoaded);
 }
 
 // ---------------------------------------------------------------------
@@ -186,84 +230,116 @@ bool Graph::load(const QString& _s)
  */
 int Graph::getSelected(int x, int y)
 {
-  auto pp = ScrPoints.begin();
-  if(pp == ScrPoints.end()) return -1;
+  if(ScrPoints.empty()) return -1;
 
-  int A, z=0;
-  int dx, dx2, x1;
-  int dy, dy2, y1;
+  bool Symbols = (Style >= GRAPHSTYLE_STAR || gy!=NULL);
+  if(!HitIndex.isBuilt() || (Symbols != HitSymbols))
+    indexScrPoints(Symbols);
 
   int countX = cPointsX.at(0)->count;
-  if(pp->isStrokeEnd()) {
-    if(pp->isBranchEnd()) z++;
-    pp++;
-    if(pp->isBranchEnd()) {
-      if(pp->isGraphEnd())  return -1;   // not even one point ?
-      z++;
-      pp++;
-      if(pp->isGraphEnd())  return -1;   // not even one point ?
+  QVector<int> Near;
+  HitIndex.candidates(x, y, Near);
+  foreach(int i, Near) {
+    const HitSegment& s = HitSegments.at(i);
+    int x1 = int(ScrPoints[s.From].getScrX());
+    int y1 = int(ScrPoints[s.From].getScrY());
+    int dx = x - x1;
+    int dy = y - y1;
+
+    if(Symbols) {   // points on graph symbol
+      if((dx >= -5) && (dx <= 5) && (dy >= -5) && (dy <= 5))
+        return s.Branch*countX;
+      continue;
     }
+
+    int dx2 = int(ScrPoints[s.To].getScrX());
+    if(dx < -5) { if(x < dx2-5) continue; } // point between x coordinates ?
+    else { if(dx > 5) if(x > dx2+5) continue; }
+
+    int dy2 = int(ScrPoints[s.To].getScrY());
+    if(dy < -5) { if(y < dy2-5) continue; } // point between y coordinates ?
+    else { if(dy > 5) if(y > dy2+5) continue; }
+
+    dx2 -= x1;
+    dy2 -= y1;
+
+    qint64 A = qint64(dx2)*dy - qint64(dx)*dy2;  // the rectangle area spanned
+    A *= A;                  // avoid the need for square root
+    A -= 25*(qint64(dx2)*dx2 + qint64(dy2)*dy2);  // substract selectable area
+
+    if(A <= 0)  return s.Branch*countX;  // lies x/y onto the graph line ?
   }
 
-  if(Style >= GRAPHSTYLE_STAR || gy!=NULL) {
-    // for graph symbols
-    while(!pp->isGraphEnd()) {
-      if(!pp->isStrokeEnd()) {
-        dx  = x - int((pp)->getScrX());
-        dy  = y - int((pp++)->getScrY());
-
-        if(dx < -5) continue;
-        if(dx >  5) continue;
-        if(dy < -5) continue;
-        if(dy >  5) continue;
-        return z*countX;   // points on graph symbol
-      }
+  return -1;
+}
+
+// -----------------------------------------------------------------------
+/*!
+ * collects the line segments (or symbols) of the screen points and sorts
+ * them into HitIndex, so that a click is only checked against the few
+ * segments near to it. the segments are walked like they are painted:
+ * a line goes on across the end of a stroke, the branch number counts
+ * the branch ends.
+ */
+void Graph::indexScrPoints(bool symbols)
+{
+  HitSegments.clear();
+  HitIndex.clear();
+  HitSymbols = symbols;
+
+  HitSegment s;
+  s.Branch = 0;
+  int n = 0, End = int(ScrPoints.size());
+  if(ScrPoints[0].isStrokeEnd()) {
+    if(ScrPoints[0].isBranchEnd()) s.Branch++;
+    n++;
+    if((n < End) && ScrPoints[n].isBranchEnd()) {
+      if(ScrPoints[n].isGraphEnd())  n = End;   // not even one point ?
       else {
-        z++;   // next branch
-        pp++;
+        s.Branch++;
+        n++;
       }
     }
-    return -1;
   }
 
-  // for graph lines
-  while(!pp->isGraphEnd()) {
-    while(!pp->isBranchEnd()) {
-      x1 = int(pp->getScrX());
-      y1 = int((pp++)->getScrY());
-      dx  = x - x1;
-      dy  = y - y1;
-
-      if(pp->isPt()){
-        dx2 = int(pp->getScrX());
-      }else if(pp->isBranchEnd()) {
-        break;
-      }else if(pp->isStrokeEnd()) {
-        pp++;
-        dx2 = int(pp->getScrX());  // go on as graph can also be selected between strokes
-        if(pp->isBranchEnd()) break;
+  int x1, y1, x2, y2;
+  if(symbols) {
+    for( ; (n < End) && !ScrPoints[n].isGraphEnd(); n++) {
+      if(ScrPoints[n].isStrokeEnd()) {
+        s.Branch++;   // next branch
+        continue;
       }
-      if(dx < -5) { if(x < dx2-5) continue; } // point between x coordinates ?
-      else { if(x > 5) if(x > dx2+5) continue; }
-
-      dy2 = int(pp->getScrY());
-      if(dy < -5) { if(y < dy2-5) continue; } // point between y coordinates ?
-      else { if(y > 5) if(y > dy2+5) continue; }
-
-      dx2 -= x1;
-      dy2 -= y1;
-
-      A  = dx2*dy - dx*dy2;    // calculate the rectangle area spanned
-      A *= A;                  // avoid the need for square root
-      A -= 25*(dx2*dx2 + dy2*dy2);  // substract selectable area
-
-      if(A <= 0)  return z*countX;  // lies x/y onto the graph line ?
+      s.From = s.To = n;
+      x1 = int(ScrPoints[n].getScrX());
+      y1 = int(ScrPoints[n].getScrY());
+      HitSegments.append(s);
+      HitIndex.add(x1-5, y1-5, x1+5, y1+5);
+    }
+  }
+  else {
+    while((n < End) && !ScrPoints[n].isGraphEnd()) {
+      while((n+1 < End) && !ScrPoints[n].isBranchEnd()) {
+        s.From = n++;
+        if(ScrPoints[n].isBranchEnd())  break;
+        if(ScrPoints[n].isStrokeEnd()) {
+          n++;   // go on as graph can also be selected between strokes
+          if((n >= End) || ScrPoints[n].isBranchEnd())  break;
+        }
+        s.To = n;
+        x1 = int(ScrPoints[s.From].getScrX());
+        y1 = int(ScrPoints[s.From].getScrY());
+        x2 = int(ScrPoints[n].getScrX());
+        y2 = int(ScrPoints[n].getScrY());
+        HitSegments.append(s);
+        HitIndex.add(qMin(x1, x2)-5, qMin(y1, y2)-5,
+                     qMax(x1, x2)+5, qMax(y1, y2)+5);
+      }
+      n++;
+      s.Branch++;
     }
-    pp++;
-    z++;
   }
 
-  return -1;
+  HitIndex.build();
 }
 // -----------------------------------------------------------------------
 /*it's a select function for phasordiagram that with the 2 points of the vector 
@@ -351,21 +427,89 @@ std::pair<double,double> Graph::findSample(std::vector<double>& VarPos) const
   unsigned m=1;
 
   for(unsigned ii=0; (pD=axis(ii)); ++ii) {
-    double* pp = pD->Points;
-    double v = VarPos[nVarPos];
-    for(unsigned i=pD->count; i>1; i--) {  // find appropiate marker position
-      if(fabs(v-(*pp)) < fabs(v-(*(pp+1)))) break;
-      pp++;
-      n += m;
-    }
+    int i = pD->nearest(VarPos[nVarPos]);  // find appropiate marker position
+    n += i*m;
 
     m *= pD->count;
-    VarPos[nVarPos++] = *pp;
+    VarPos[nVarPos++] = pD->Points[i];
   }
 
   return std::pair<double,double>(cPointsY[2*n], cPointsY[2*n+1]);
 }
 
+// -----------------------------------------------------------------------
+/*!
+ * 1 if the values ascend, -1 if they descend, 0 if neither (or NaN). a
+ * sweep usually is monotonic, so that a value is found by binary search.
+ */
+int DataX::order() const
+{
+  if(Order != 2)  return Order;
+
+  bool Ascending = true, Descending = true;
+  for(int i = 1; i < count; i++) {
+    if(!(Points[i-1] <= Points[i]))  Ascending = false;
+    if(!(Points[i-1] >= Points[i]))  Descending = false;
+    if(!Ascending && !Descending)  break;
+  }
+  if(count > 0)  if(std::isnan(Points[0]))  Ascending = Descending = false;
+
+  if(Ascending)  Order = 1;
+  else if(Descending)  Order = -1;
+  else  Order = 0;
+  return Order;
+}
+
+// -----------------------------------------------------------------------
+/*!
+ * the index of the sample next to v, walking from the first sample to
+ * the first local minimum of the distance. of equal samples, the last
+ * one is taken.
+ */
+int DataX::nearest(double v) const
+{
+  if(count < 2)  return 0;
+  // no distance to an infinite v (or NaN) is smaller than another one
+  if(!std::isfinite(v))  return count - 1;
+
+  int s = order();
+  if(s == 0) {
+    int i = 0;
+    for( ; i < count-1; i++)
+      if(fabs(v-Points[i]) < fabs(v-Points[i+1]))  break;
+    return i;
+  }
+
+  // first sample not before v, in the direction of the axis
+  int lo = 0, hi = count;
+  while(lo < hi) {
+    int mid = (lo + hi) / 2;
+    if(s*Points[mid] < s*v)  lo = mid + 1;
+    else  hi = mid;
+  }
+
+  int i;
+  if(lo >= count)  i = count - 1;
+  else if((lo > 0) && (fabs(v-Points[lo-1]) < fabs(v-Points[lo])))  i = lo - 1;
+  else  i = lo;
+  while((i+1 < count) && (Points[i+1] == Points[i]))  i++;
+  return i;
+}
+
+// -----------------------------------------------------------------------
+// the first sample not below v, "count" if there is none.
+int DataX::firstNotBelow(double v) const
+{
+  if(std::isnan(v))  return count;
+  if(order() != 1) {
+    int i = 0;
+    while((i < count) && !(v <= Points[i]))  i++;
+    return i;
+  }
+
+  return int(std::lower_bound(Points, Points+count, v) - Points);
+}
+
 // -----------------------------------------------------------------------
 // meaning of the values in a graph "Points" list
 #define STROKEEND   -2
@@ -21,6 +21,8 @@
 
 #include "marker.h"
 #include "element.h"
+#include "binarydataset.h"
+#include "hitgrid.h"
 
 #include <cmath>
 #include <QColor>
@@ -53,25 +55,33 @@ inline graphstyle_t toGraphStyle(int x){
 
 class Diagram;
 class ViewPainter;
+class CachedDataSet;
+class DigitalWave;
 
 
 struct DataX {
   DataX(const QString& Var_, double *Points_=0, int count_=0)
-       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY) {};
- ~DataX() { if(Points) delete[] Points; };
+       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY),
+         Order(2) {};
+ ~DataX() { if(Points && !Mapping) delete[] Points; };
   QString Var;
   double *Points;
   int     count;
+  BinaryDataSetPtr Mapping; // set if Points lies in a mapped dataset
 
 public:
   const double& min()const {return Min;}
   const double& max()const {return Max;}
+  int order() const;
+  int nearest(double) const;
+  int firstNotBelow(double) const;
 public: // only called from Graph. cleanup later.
   const double& min(const double& x){if (Min<x) Min=x; return Min;}
   const double& max(const double& x){if (Max>x) Max=x; return Max;}
 private:
   double Min;
   double Max;
+  mutable int Order; // see order(), 2 if not known yet
 };
 
 struct Axis;
@@ -123,7 +133,11 @@ public:
   typedef container::const_iterator const_iterator;
 
   int loadDatFile(const QString& filename);
-  int loadIndepVarData(const QString&, char* datfilecontent, DataX* where);
+  int loadIndepVarData(const QString&, CachedDataSet const&, DataX* where);
+  bool loadBinaryData(BinaryDataSetPtr const&, const QString&);
+  void clearPointsY();
+  double* takePointsY();
+  void takeData(Graph&);
 
   void    paint(ViewPainter*, int, int);
   void    paintLines(ViewPainter*, int, int);
@@ -144,8 +158,8 @@ public:
   bool isEmpty() const { return !cPointsX.size(); }
   QVector<DataX*>& mutable_axes(){return cPointsX;} // HACK
 
-  void clear(){ScrPoints.resize(0);}
-  void resizeScrPoints(size_t s){assert(s>=ScrPoints.size()); ScrPoints.resize(s);}
+  void clear(){ScrPoints.resize(0); HitIndex.clear();}
+  void resizeScrPoints(size_t s){assert(s>=ScrPoints.size()); ScrPoints.resize(s); HitIndex.clear();}
   iterator begin(){return ScrPoints.begin();}
   iterator end(){return ScrPoints.end();}
   const_iterator begin() const{return ScrPoints.begin();}
@@ -154,6 +168,7 @@ public:
   QDateTime lastLoaded;  // when it was loaded into memory
   int     yAxisNo;       // which y axis is used
   double *cPointsY;
+  DigitalWave *cPointsD; // instead of cPointsY for digital variables (".X")
   int     countY;    // number of curves
   QString Var;
   QColor  Color;
@@ -176,8 +191,18 @@ public: // marker related
   void createMarkerText() const;
   std::pair<double,double> findSample(std::vector<double>&) const;
   Diagram const* parentDiagram() const{return diagram;}
+private: // selection, see getSelected()
+  struct HitSegment {
+    int From, To;   // in ScrPoints, the same for a symbol
+    int Branch;
+  };
+  void indexScrPoints(bool symbols);
+  QVector<HitSegment> HitSegments;
+  HitGrid HitIndex;
+  bool HitSymbols;
 private:
   QVector<DataX*>  cPointsX;
+  BinaryDataSetPtr MappedY; // set if cPointsY lies in a mapped dataset
   std::vector<ScrPt> ScrPoints; // data in screen coordinates
   Diagram const* diagram;
 };
@@ -0,0 +1,125 @@
+/*
+ * graphloader.cpp - load the graph data of diagrams in worker threads
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphloader.h"
+
+#include <float.h>
+
+#include <QThreadPool>
+#include <QDebug>
+
+GraphLoadJob::GraphLoadJob(Diagram const* d, const QString& defaultDataSet)
+  : Diag(d), DataSet(defaultDataSet), Cancelled(0)
+{
+  setAutoDelete(false);   // deleted by GraphLoader in the GUI thread
+
+  Limits.Name = d->Name;
+  Limits.yAxis.numGraphs = Limits.zAxis.numGraphs = 0;
+  Limits.yAxis.min = Limits.zAxis.min = Limits.xAxis.min =  DBL_MAX;
+  Limits.yAxis.max = Limits.zAxis.max = Limits.xAxis.max = -DBL_MAX;
+
+  foreach(Graph *pg, d->Graphs) {
+    Graph *g = new Graph(NULL, pg->Var);
+    g->yAxisNo = pg->yAxisNo;
+    g->lastLoaded = pg->lastLoaded;   // to skip unchanged datasets
+    Loaded.append(g);
+  }
+}
+
+GraphLoadJob::~GraphLoadJob()
+{
+  qDeleteAll(Loaded);
+}
+
+// ---------------------------------------------------------------------
+// runs in a worker thread, touches nothing but the detached graphs.
+void GraphLoadJob::run()
+{
+  for(int i=0; i<Loaded.size(); i++) {
+    if(isCancelled())  break;
+
+    Graph *g = Loaded.at(i);
+    if(g->loadDatFile(DataSet) == 1) {   // dataset unchanged
+      delete g;
+      Loaded[i] = NULL;
+    }
+    else
+      Limits.getAxisLimits(g);
+  }
+
+  emit finished();
+}
+
+// ---------------------------------------------------------------------
+GraphLoader::GraphLoader()
+{
+}
+
+GraphLoader* GraphLoader::instance()
+{
+  static GraphLoader *Loader = new GraphLoader();
+  return Loader;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * start loading the graphs of d. the diagram keeps showing its current
+ * data until diagramLoaded() is emitted.
+ */
+void GraphLoader::load(Diagram *d, const QString& defaultDataSet)
+{
+  cancel(d);
+  if(d->Graphs.isEmpty())  return;
+
+  GraphLoadJob *job = new GraphLoadJob(d, defaultDataSet);
+  // queued, as the signal is emitted in the worker thread
+  connect(job, SIGNAL(finished()), SLOT(slotJobFinished()),
+          Qt::QueuedConnection);
+  Pending.insert(d, job);
+  QThreadPool::globalInstance()->start(job);
+}
+
+// ---------------------------------------------------------------------
+void GraphLoader::cancel(Diagram const* d)
+{
+  GraphLoadJob *job = Pending.take(d);
+  if(job)
+    job->cancel();   // deleted as soon as it has finished
+}
+
+// ---------------------------------------------------------------------
+void GraphLoader::slotJobFinished()
+{
+  GraphLoadJob *job = qobject_cast<GraphLoadJob*>(sender());
+  if(!job)  return;
+
+  Diagram *d = const_cast<Diagram*>(job->diagram());
+  if(!job->isCancelled() && (Pending.value(d) == job)) {
+    Pending.remove(d);
+    d->takeGraphData(job->graphs(), job->limits());
+    emit diagramLoaded(d);
+  }
+
+  job->deleteLater();
+}
+
+// vim:ts=8:sw=2:et
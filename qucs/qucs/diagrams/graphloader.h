@@ -0,0 +1,97 @@
+/*
+ * graphloader.h - load the graph data of diagrams in worker threads
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHLOADER_H_
+#define GRAPHLOADER_H_ value
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+
+#include "diagram.h"
+
+/*!
+ * loads the datasets of one diagram in a worker thread.
+ *
+ * the job works on detached copies of the graphs, so the diagram stays
+ * usable (and paintable) meanwhile. the axis limits of the loaded graphs
+ * are collected in a scratch diagram. finished() is emitted from the
+ * worker thread, the result is taken over by GraphLoader in the GUI
+ * thread.
+ */
+class GraphLoadJob : public QObject, public QRunnable {
+Q_OBJECT
+public:
+  GraphLoadJob(Diagram const*, const QString& defaultDataSet);
+ ~GraphLoadJob();
+
+  void run();
+  void cancel() { Cancelled = 1; }
+  bool isCancelled() const { return Cancelled != 0; }
+
+  Diagram const* diagram() const { return Diag; }
+  // one entry per graph of the diagram, NULL if the dataset is unchanged
+  QList<Graph*> const& graphs() const { return Loaded; }
+  Diagram const& limits() const { return Limits; }
+
+signals:
+  void finished();
+
+private:
+  Diagram const* Diag;  // never dereferenced outside the GUI thread
+  QString DataSet;
+  QList<Graph*> Loaded;
+  Diagram Limits;
+  QAtomicInt Cancelled;
+};
+
+/*!
+ * schedules GraphLoadJobs, at most one per diagram. a newer request for
+ * the same diagram, a synchronous Diagram::loadGraphData() and deleting
+ * the diagram cancel the pending job, its result is then thrown away.
+ * all functions must be called from the GUI thread.
+ */
+class GraphLoader : public QObject {
+Q_OBJECT
+public:
+  static GraphLoader* instance();
+
+  void load(Diagram*, const QString& defaultDataSet);
+  void cancel(Diagram const*);
+  bool isLoading(Diagram const* d) const { return Pending.contains(d); }
+
+signals:
+  void diagramLoaded(Diagram*);
+
+private slots:
+  void slotJobFinished();
+
+private:
+  GraphLoader();
+
+  QHash<Diagram const*, GraphLoadJob*> Pending;
+};
+
+#endif
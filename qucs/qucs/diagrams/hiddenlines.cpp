@@ -0,0 +1,416 @@
+/*
+ * hiddenlines.cpp - hidden line removal for 3D diagrams
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "hiddenlines.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include <QList>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+
+namespace {
+
+// the pixels of a line as drawn by Bresenham's algorithm, without the
+// end points
+struct LineWalk {
+  LineWalk(int x1, int y1, int x2, int y2) : x(x1), y(y1), ax(0), ay(0)
+  {
+    if(x2 >= x1) { dx = x2 - x1;  ix = 1; }
+    else         { dx = x1 - x2;  ix = -1; }
+    if(y2 >= y1) { dy = y2 - y1;  iy = 1; }
+    else         { dy = y1 - y2;  iy = -1; }
+
+    if(dx < dy) {   // exchange dx and dy
+      qSwap(dx, dy);
+      ax = iy;
+      ay = ix;
+      ix = iy = 0;
+    }
+    of = dx >> 1;
+  }
+
+  int steps() const { return (dx > 1) ? dx - 1 : 0; }
+
+  void next()
+  {
+    x += ix;
+    y += ax;
+    of += dy;
+    if(of > dx) {
+      of -= dx;
+      x += ay;
+      y += iy;
+    }
+  }
+
+  int x, y;
+
+private:
+  int ix, iy, ax, ay, dx, dy, of;
+};
+
+// the columns "first" to "last" of the pixel buffer, with the extent
+// of the current polygon in each of them
+struct Columns {
+  Columns(int first_, int last_, int height, int stride, unsigned char *bits)
+    : first(first_), last(last_), Height(height), Stride(stride), Bits(bits),
+      MinY(last_ - first_ + 1, INT_MAX), MaxY(last_ - first_ + 1, INT_MIN) {}
+
+  bool owns(int x) const { return (x >= first) && (x <= last); }
+
+  void reset(int a, int b)
+  {
+    for(int x = a; x <= b; x++) {
+      MinY[x - first] = INT_MAX;
+      MaxY[x - first] = INT_MIN;
+    }
+  }
+
+  // remembers the pixel as part of the polygon, returns whether it is
+  // covered already. pixels outside the diagram are never hidden.
+  bool touch(int x, int y)
+  {
+    if((y < 0) || (y > Height))  return false;
+    int i = x - first;
+    if(MinY[i] > y)  MinY[i] = y;
+    if(MaxY[i] < y)  MaxY[i] = y;
+    return (Bits[x*Stride + (y >> 3)] & (1 << (y & 7))) != 0;
+  }
+
+  // covers the polygon area of the columns "a" to "b"
+  void fill(int a, int b)
+  {
+    for(int x = a; x <= b; x++) {
+      int y = MinY[x - first], y2 = MaxY[x - first];
+      unsigned char *col = Bits + x*Stride;
+      while(y <= y2) {
+        if(((y & 7) == 0) && (y + 7 <= y2)) {
+          int n = (y2 - y + 1) >> 3;
+          memset(col + (y >> 3), 0xff, n);
+          y += n << 3;
+          continue;
+        }
+        col[y >> 3] |= 1 << (y & 7);
+        y++;
+      }
+    }
+  }
+
+  int first, last;
+  int Height, Stride;
+  unsigned char *Bits;
+  QVector<int> MinY, MaxY;
+};
+
+// maps the depth onto an unsigned integer of the same order
+inline quint32 depthKey(float z)
+{
+  quint32 u;
+  memcpy(&u, &z, sizeof(u));
+  return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+}
+
+/*!
+ * the columns of one strip, worked on in a thread of its own.
+ */
+class HiddenLines::Strip : public QRunnable {
+public:
+  Strip(HiddenLines *engine, int first, int last)
+    : Engine(engine), First(first), Last(last) { setAutoDelete(false); }
+
+  void run() { Engine->cover(First, Last, Crossings); }
+
+  QVector<HiddenLines::Crossing> Crossings;
+
+private:
+  HiddenLines *Engine;
+  int First, Last;
+};
+
+// ---------------------------------------------------------------------
+// the diagram area reaches from (0,0) to (width,height).
+HiddenLines::HiddenLines(int width, int height)
+  : Width(width), Height(height), Stride((height >> 3) + 1),
+    Bits(0), Points(0), FirstWalk(0), StartHidden(0), EndHidden(0)
+{
+}
+
+// ---------------------------------------------------------------------
+// adds a polygon bounded by the segments starting at the points "row"
+// and "rowNext" (one direction of the grid) and "cross" and "crossNext"
+// (the other direction). "z" is its distance from the viewer, the
+// larger the nearer.
+void HiddenLines::addPolygon(float z, int row, int rowNext, int cross,
+                             int crossNext)
+{
+  Polygon P;
+  P.z = z;
+  P.Edge[0] = row;
+  P.Edge[1] = rowNext;
+  P.Edge[2] = cross;
+  P.Edge[3] = crossNext;
+  P.MinX = P.MaxX = 0;
+  Polygons.append(P);
+}
+
+// ---------------------------------------------------------------------
+bool HiddenLines::stepLessThan(const Crossing& c1, const Crossing& c2)
+{
+  return c1.Step < c2.Step;
+}
+
+// ---------------------------------------------------------------------
+// radix sort, the nearest polygon first. polygons of the same depth
+// keep their order.
+void HiddenLines::sortPolygons()
+{
+  int n = Polygons.size();
+  QVector<quint32> Keys(n), Keys2(n);
+  QVector<Polygon> Sorted(n);
+  for(int i = 0; i < n; i++)
+    Keys[i] = ~depthKey(Polygons.at(i).z);
+
+  QVector<int> Count(2049);
+  for(int shift = 0; shift < 32; shift += 11) {
+    Count.fill(0);
+    for(int i = 0; i < n; i++)
+      Count[((Keys.at(i) >> shift) & 2047) + 1]++;
+    if(Count.at(((Keys.at(0) >> shift) & 2047) + 1) == n)
+      continue;   // all the same
+    for(int d = 1; d < 2049; d++)
+      Count[d] += Count.at(d-1);
+
+    for(int i = 0; i < n; i++) {
+      int j = Count[(Keys.at(i) >> shift) & 2047]++;
+      Sorted[j] = Polygons.at(i);
+      Keys2[j] = Keys.at(i);
+    }
+    qSwap(Polygons, Sorted);
+    qSwap(Keys, Keys2);
+  }
+}
+
+// ---------------------------------------------------------------------
+// covers the polygons in the columns "first" to "last". it records the
+// hidden state of the end points of each polygon edge it owns and, for
+// the first polygon that contains a segment, every pixel of the segment
+// in the strip whose hidden state differs from the pixel before it.
+void HiddenLines::cover(int first, int last, QVector<Crossing>& crossings)
+{
+  Columns Col(first, last, Height, Stride, Bits);
+
+  for(int k = 0; k < Polygons.size(); k++) {
+    const Polygon& P = Polygons.at(k);
+    if((P.MaxX < first) || (P.MinX > last))  continue;
+    int a = qMax(P.MinX, first), b = qMin(P.MaxX, last);
+    Col.reset(a, b);
+
+    for(int e = 0; e < 4; e++) {
+      int idx = 4*k + e, s = P.Edge[e];
+      const tPoint3D& p1 = Points[s];
+      const tPoint3D& p2 = Points[s+1];
+
+      if(Col.owns(p1.x))
+        StartHidden[idx] = Col.touch(p1.x, p1.y);
+
+      LineWalk Line(p1.x, p1.y, p2.x, p2.y);
+      bool record = FirstWalk[idx];
+      bool inside = false, was = false;
+      for(int i = 1; i <= Line.steps(); i++) {
+        Line.next();
+        if(!Col.owns(Line.x)) {
+          inside = false;
+          continue;
+        }
+        bool h = Col.touch(Line.x, Line.y);
+        if(record && (!inside || (h != was))) {
+          Crossing c = { s, i, Line.x, Line.y, h };
+          crossings.append(c);
+        }
+        inside = true;
+        was = h;
+      }
+
+      if(Col.owns(p2.x))
+        EndHidden[idx] = Col.touch(p2.x, p2.y);
+    }
+
+    Col.fill(a, b);
+  }
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * hides the lines of "points" behind the polygons. afterwards "points"
+ * holds the same points, flagged, with the points where a segment gets
+ * hidden or visible inserted after the first point of the segment. the
+ * coverage is kept for cutLine().
+ */
+void HiddenLines::run(QVector<tPoint3D>& points, int threads)
+{
+  int N = points.size();
+  int NP = Polygons.size();
+  zBuffer.fill(0, (Width+1) * Stride);
+  if(NP == 0)  return;
+
+  sortPolygons();
+  tPoint3D *p = points.data();
+  Points = p;
+  Bits = zBuffer.data();
+
+  // every segment is cut by the first (nearest) polygon containing it
+  QVector<char> Flags(12*NP, 0);
+  FirstWalk = Flags.data();
+  StartHidden = FirstWalk + 4*NP;
+  EndHidden = StartHidden + 4*NP;
+  QVector<char> Seen(N, 0);
+  for(int k = 0; k < NP; k++) {
+    Polygon& P = Polygons[k];
+    P.MinX = INT_MAX;
+    P.MaxX = INT_MIN;
+    for(int e = 0; e < 4; e++) {
+      int s = P.Edge[e];
+      FirstWalk[4*k + e] = !Seen.at(s);
+      Seen[s] = 1;
+      P.MinX = qMin(P.MinX, qMin(p[s].x, p[s+1].x));
+      P.MaxX = qMax(P.MaxX, qMax(p[s].x, p[s+1].x));
+    }
+  }
+
+  // not worth a thread below some hundred polygons or 16 columns
+  if(threads < 1)  threads = QThread::idealThreadCount();
+  if(NP < 1024)  threads = 1;
+  threads = qMin(threads, (Width+1) / 16);
+  if(threads < 1)  threads = 1;
+
+  QList<Strip*> Strips;
+  for(int i = 0; i < threads; i++)
+    Strips.append(new Strip(this, (Width+1) * i / threads,
+                                  (Width+1) * (i+1) / threads - 1));
+  if(threads > 1) {
+    QThreadPool Pool;
+    Pool.setMaxThreadCount(threads - 1);
+    for(int i = 1; i < threads; i++)
+      Pool.start(Strips.at(i));
+    Strips.at(0)->run();
+    Pool.waitForDone();
+  }
+  else
+    Strips.at(0)->run();
+
+  // flag the hidden segment starts, in the order of the polygons
+  QVector<char> FirstHidden(N, 0);
+  for(int idx = 0; idx < 4*NP; idx++) {
+    int s = Polygons.at(idx >> 2).Edge[idx & 3];
+    if(FirstWalk[idx]) {
+      if(StartHidden[idx])  p[s].done |= 4;   // mark as hidden
+      FirstHidden[s] = StartHidden[idx];
+    }
+    if(!EndHidden[idx]) {
+      if(!StartHidden[idx])  p[s+1].done &= ~4;
+      else  p[s].done &= ~4;
+    }
+    p[s].done |= 1;   // mark as already worked on
+  }
+
+  // group the crossings by segment (counting sort)
+  QVector<int> Begin(N+1, 0);
+  foreach(Strip *St, Strips)
+    foreach(Crossing const& c, St->Crossings)
+      Begin[c.Segment + 1]++;
+  for(int s = 0; s < N; s++)
+    Begin[s+1] += Begin.at(s);
+  QVector<Crossing> Sorted(Begin.at(N));
+  QVector<int> Next(Begin);
+  foreach(Strip *St, Strips)
+    foreach(Crossing const& c, St->Crossings)
+      Sorted[Next[c.Segment]++] = c;
+  qDeleteAll(Strips);
+
+  // insert a point wherever the hidden state changes along a segment
+  QVector<tPoint3D> Result;
+  Result.reserve(N + Sorted.size());
+  for(int s = 0; s < N; s++) {
+    Result.append(p[s]);
+    if(Begin.at(s) == Begin.at(s+1))  continue;
+
+    Crossing *c = Sorted.data() + Begin.at(s);
+    Crossing *end = Sorted.data() + Begin.at(s+1);
+    qSort(c, end, stepLessThan);   // the strips of a segment
+    bool was = FirstHidden.at(s);
+    for(; c < end; c++) {
+      if(c->Hidden == was)  continue;
+      was = c->Hidden;
+      tPoint3D t = { c->x, c->y, p[s].No, was ? 4 : 0 };
+      Result.append(t);
+    }
+  }
+
+  Points = 0;
+  Bits = 0;
+  FirstWalk = StartHidden = EndHidden = 0;
+  points = Result;
+}
+
+// ---------------------------------------------------------------------
+bool HiddenLines::isHidden(int x, int y) const
+{
+  if((x < 0) || (x > Width) || (y < 0) || (y > Height))  return false;
+  if(zBuffer.isEmpty())  return false;
+  return (zBuffer.at(x*Stride + (y >> 3)) & (1 << (y & 7))) != 0;
+}
+
+// ---------------------------------------------------------------------
+// cuts a line (e.g. of the coordinate cross) at the coverage left by
+// run(). "out" gets the start point, the points where the line gets
+// hidden or visible and the end point, flagged like in run().
+void HiddenLines::cutLine(int x1, int y1, int x2, int y2,
+                          QVector<tPoint3D>& out) const
+{
+  out.clear();
+  bool was = isHidden(x1, y1);
+  tPoint3D Start = { x1, y1, 0, was ? 4 : 0 };
+  out.append(Start);
+
+  LineWalk Line(x1, y1, x2, y2);
+  for(int i = Line.steps(); i > 0; i--) {
+    Line.next();
+    bool h = isHidden(Line.x, Line.y);
+    if(h == was)  continue;
+    was = h;
+    tPoint3D t = { Line.x, Line.y, 0, h ? 4 : 0 };
+    out.append(t);
+  }
+
+  if(!isHidden(x2, y2) && isHidden(x1, y1))
+    out[0].done &= ~4;
+  tPoint3D End = { x2, y2, 1, 0 };
+  out.append(End);
+}
+
+// vim:ts=8:sw=2:et
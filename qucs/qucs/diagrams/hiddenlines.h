@@ -0,0 +1,91 @@
+/*
+ * hiddenlines.h - hidden line removal for 3D diagrams
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HIDDENLINES_H_
+#define HIDDENLINES_H_ value
+
+#include <QVector>
+
+/*!
+ * a point of the lines of a 3D graph in screen coordinates. "No" is
+ * the number of the line segment the point belongs to, "done" holds
+ * flags: 1 = segment worked on, 4 = hidden from here on, 8 = last point
+ * of a line, 256/512 = last point of a graph (with/without cross grid).
+ */
+struct tPoint3D {
+  int   x, y;
+  int   No, done;
+};
+
+/*!
+ * hides the parts of lines covered by polygons nearer to the viewer.
+ *
+ * the lines are given as an array of points, a segment runs from point
+ * i to point i+1. every polygon is bounded by four segments. polygons are
+ * processed from the nearest to the farthest one: a line pixel already
+ * covered by a nearer polygon is hidden, then the polygon covers the
+ * pixels between the lowest and the highest of its edge pixels in every
+ * column.
+ *
+ * as every column of the diagram is covered independently, the columns
+ * are split into strips that are worked on in parallel. the points where
+ * a segment gets hidden or visible again are inserted after the first
+ * point of the segment.
+ */
+class HiddenLines {
+public:
+  HiddenLines(int width, int height);
+
+  void addPolygon(float z, int row, int rowNext, int cross, int crossNext);
+  int  countPolygons() const { return Polygons.size(); }
+
+  void run(QVector<tPoint3D>& points, int threads=0);
+  void cutLine(int x1, int y1, int x2, int y2, QVector<tPoint3D>& out) const;
+  bool isHidden(int x, int y) const;
+
+private:
+  struct Polygon {
+    float z;        // sum of the depth of the corners, larger is nearer
+    int Edge[4];    // first points of the bounding segments
+    int MinX, MaxX;
+  };
+  struct Crossing { // a segment pixel in a strip, see cover()
+    int Segment, Step;
+    int x, y;
+    bool Hidden;
+  };
+  class Strip;
+
+  static bool stepLessThan(const Crossing&, const Crossing&);
+  void sortPolygons();
+  void cover(int first, int last, QVector<Crossing>&);
+
+  int Width, Height;
+  int Stride;                   // bytes per column of "zBuffer"
+  QVector<Polygon> Polygons;
+  QVector<unsigned char> zBuffer;   // one bit per pixel, column by column
+  unsigned char *Bits;          // data of "zBuffer" during run()
+  const tPoint3D *Points;       // during run()
+  char *FirstWalk, *StartHidden, *EndHidden;   // per polygon edge
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * hitgrid.cpp - finding screen boxes around a point
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "hitgrid.h"
+
+#define HITGRID_CELL       16    // minimum size of a cell in pixels
+#define HITGRID_MAX_CELLS  512   // maximum number of cells per direction
+#define HITGRID_LARGE      64    // cells a box may cover in the grid
+
+HitGrid::HitGrid()
+  : Left(0), Top(0), CellWidth(HITGRID_CELL), CellHeight(HITGRID_CELL),
+    Columns(0), Rows(0), Built(false)
+{
+}
+
+// ---------------------------------------------------------------------
+void HitGrid::clear()
+{
+  Boxes.clear();
+  First.clear();
+  Cells.clear();
+  Large.clear();
+  Columns = Rows = 0;
+  Built = false;
+}
+
+// ---------------------------------------------------------------------
+// adds a box given by two corners and returns its number.
+int HitGrid::add(int x1, int y1, int x2, int y2)
+{
+  Box b;
+  b.x1 = qMin(x1, x2);  b.x2 = qMax(x1, x2);
+  b.y1 = qMin(y1, y2);  b.y2 = qMax(y1, y2);
+  Boxes.append(b);
+  Built = false;
+  return Boxes.size() - 1;
+}
+
+// ---------------------------------------------------------------------
+// sorts the boxes into the cells, counting them first.
+void HitGrid::build()
+{
+  First.clear();
+  Cells.clear();
+  Large.clear();
+  Built = true;
+  Columns = Rows = 0;
+  if(Boxes.isEmpty())  return;
+
+  int Right, Bottom;
+  Left = Right = Boxes.at(0).x1;
+  Top = Bottom = Boxes.at(0).y1;
+  foreach(const Box& b, Boxes) {
+    Left = qMin(Left, b.x1);  Right  = qMax(Right, b.x2);
+    Top  = qMin(Top, b.y1);   Bottom = qMax(Bottom, b.y2);
+  }
+
+  // qint64, the boxes of unclipped graphs may lie far outside
+  qint64 w = qint64(Right) - Left + 1, h = qint64(Bottom) - Top + 1;
+  CellWidth  = int(qMax(qint64(HITGRID_CELL), w / HITGRID_MAX_CELLS + 1));
+  CellHeight = int(qMax(qint64(HITGRID_CELL), h / HITGRID_MAX_CELLS + 1));
+  Columns = int((w - 1) / CellWidth) + 1;
+  Rows    = int((h - 1) / CellHeight) + 1;
+
+  First.fill(0, Columns*Rows + 1);
+  QVector<char> isLarge(Boxes.size(), 0);
+  for(int i = 0; i < Boxes.size(); i++) {
+    const Box& b = Boxes.at(i);
+    int c1 = column(b.x1), c2 = column(b.x2);
+    int r1 = row(b.y1), r2 = row(b.y2);
+    if((c2-c1+1) * (r2-r1+1) > HITGRID_LARGE) {
+      isLarge[i] = 1;
+      Large.append(i);
+      continue;
+    }
+    for(int r = r1; r <= r2; r++)
+      for(int c = c1; c <= c2; c++)
+        First[r*Columns + c + 1]++;
+  }
+
+  for(int i = 1; i < First.size(); i++)
+    First[i] += First.at(i-1);
+  Cells.resize(First.last());
+
+  QVector<int> Next(First);
+  for(int i = 0; i < Boxes.size(); i++) {
+    if(isLarge.at(i))  continue;
+    const Box& b = Boxes.at(i);
+    int c1 = column(b.x1), c2 = column(b.x2);
+    for(int r = row(b.y1); r <= row(b.y2); r++)
+      for(int c = c1; c <= c2; c++)
+        Cells[Next[r*Columns + c]++] = i;
+  }
+}
+
+// ---------------------------------------------------------------------
+// the boxes that may contain (x,y), in the order they were added.
+void HitGrid::candidates(int x, int y, QVector<int>& ids) const
+{
+  ids.clear();
+  if(!Built || !Columns)  return;
+
+  // a point outside the grid lies in the nearest cell, as do the boxes
+  // that contain it
+  int Cell = row(y)*Columns + column(x);
+  int i = First.at(Cell), iEnd = First.at(Cell+1);
+  int j = 0, jEnd = Large.size();
+  while((i < iEnd) || (j < jEnd)) {
+    if((j >= jEnd) || ((i < iEnd) && (Cells.at(i) < Large.at(j))))
+      ids.append(Cells.at(i++));
+    else
+      ids.append(Large.at(j++));
+  }
+}
+
+// ---------------------------------------------------------------------
+int HitGrid::column(int x) const
+{
+  qint64 c = (qint64(x) - Left) / CellWidth;
+  if(c < 0)  return 0;
+  if(c >= Columns)  return Columns - 1;
+  return int(c);
+}
+
+// ---------------------------------------------------------------------
+int HitGrid::row(int y) const
+{
+  qint64 r = (qint64(y) - Top) / CellHeight;
+  if(r < 0)  return 0;
+  if(r >= Rows)  return Rows - 1;
+  return int(r);
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,70 @@
+/*
+ * hitgrid.h - finding screen boxes around a point
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HITGRID_H_
+#define HITGRID_H_ value
+
+#include <QVector>
+
+/*!
+ * finds the boxes (in screen coordinates) that may contain a point,
+ * e.g. the segments of a graph near a mouse click.
+ *
+ * after build() every box is listed in the cells of a grid it covers,
+ * a box covering very many cells is kept in a list of its own. a point
+ * then only needs to be checked against the boxes of its cell and the
+ * large ones. the candidates are returned in the order the boxes were
+ * added.
+ */
+class HitGrid {
+public:
+  HitGrid();
+
+  void clear();
+  int  add(int x1, int y1, int x2, int y2);
+  void build();
+  bool isBuilt() const { return Built; }
+  int  countBoxes() const { return Boxes.size(); }
+
+  void candidates(int x, int y, QVector<int>& ids) const;
+
+private:
+  struct Box {
+    int x1, y1, x2, y2;
+  };
+
+  int column(int x) const;
+  int row(int y) const;
+
+  QVector<Box> Boxes;
+  int Left, Top;
+  int CellWidth, CellHeight;
+  int Columns, Rows;
+  QVector<int> First;   // start of every cell in "Cells", one more at the end
+  QVector<int> Cells;   // numbers of the boxes, cell by cell
+  QVector<int> Large;   // boxes covering too many cells
+  bool Built;
+};
+
+#endif
+
+// vim:ts=8:sw=2:et
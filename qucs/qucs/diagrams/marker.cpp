@@ -334,10 +334,8 @@ bool Marker::moveLeftRight(bool left)
   px = pD->Points;
   if(!px) return false;
 
-    for(n=0; n<pD->count; n++) {
-      if(VarPos[0] <= *px) break;
-      px++;
-    }
+    n = pD->firstNotBelow(VarPos[0]);
+    px += n;
     if(n == pD->count) px--;
 
     if(left) {
@@ -358,7 +356,7 @@ bool Marker::moveLeftRight(bool left)
 // ---------------------------------------------------------------------
 bool Marker::moveUpDown(bool up)
 {
-  int n, i=0;
+  int i=0;
   double *px;
 
   DataX const *pD = pGraph->axis(0);
@@ -370,10 +368,7 @@ bool Marker::moveUpDown(bool up)
       if(!pD) return false;
       px = pD->Points;
       if(!px) return false;
-      for(n=1; n<pD->count; n++) {  // go through all data points
-        if(fabs(VarPos[i]-(*px)) < fabs(VarPos[i]-(*(px+1)))) break;
-        px++;
-      }
+      px += pD->nearest(VarPos[i]);
 
     } while(px >= (pD->Points + pD->count - 1));  // go to next dimension ?
 
@@ -390,10 +385,7 @@ bool Marker::moveUpDown(bool up)
       if(!pD) return false;
       px = pD->Points;
       if(!px) return false;
-      for(n=0; n<pD->count; n++) {
-        if(fabs(VarPos[i]-(*px)) < fabs(VarPos[i]-(*(px+1)))) break;
-        px++;
-      }
+      px += pD->nearest(VarPos[i]);
 
     } while(px <= pD->Points);  // go to next dimension ?
 
@@ -197,7 +197,7 @@ void Rect3DDiagram::finishMarkerCoordinates(float& fCX, float& fCY) const
 
 // ------------------------------------------------------------
 void Rect3DDiagram::calcCoordinate3D(double x, double y, double zr, double zi,
-					tPoint3D *p, tPointZ *pz)
+					tPoint3D *p, float *pz)
 {
   if(zAxis.log) {
     zr = sqrt(zr*zr + zi*zi);
@@ -234,180 +234,30 @@ void Rect3DDiagram::calcCoordinate3D(double x, double y, double zr, double zi,
 
   p->x  = int(calcX_2D(x, y, zr) + 0.5 + xorig);
   p->y  = int(calcY_2D(x, y, zr) + 0.5 + yorig);
-  p->No = pz->No = p-Mem;
+  p->No = p - Points.data();
   p->done = 0;
-  pz->z = float(calcZ_2D(x, y, zr));
-}
-
-// --------------------------------------------------------------
-bool Rect3DDiagram::isHidden(int x, int y, tBound *Bounds, char *zBuffer)
-{
-  // remember the boundings of the polygon
-  if( (Bounds+x)->max < y )  (Bounds+x)->max = y;
-  if( (Bounds+x)->min > y )  (Bounds+x)->min = y;
-
-  // diagram area already used ?
-  return ( *(zBuffer + (y>>3) + x * ((y2+7)>>3)) & (1 << (y & 7)) ) != 0;
-}
-
-// --------------------------------------------------------------
-// Enlarge memory block if neccessary.
-void Rect3DDiagram::enlargeMemoryBlock(tPoint3D* &MemEnd)
-{
-  if(pMem >= MemEnd) {
-    int Size = MemEnd - Mem + 256;
-    MemEnd = Mem;
-    Mem  = (tPoint3D*)realloc(Mem, Size*sizeof(tPoint3D));
-    pMem += Mem - MemEnd;
-    MemEnd = Mem + Size - 5;
-  }
-}
-
-// --------------------------------------------------------------
-// Calculate all 2D points of the line between point "p" and "p+1".
-// Parameters:   p        - pointer on 3D coordinate of line start point
-//                          (p+1 points onto line end point)
-//               MemEnd   - pointer where memory block ends
-//               Bounds   - memory block for occupied polygon area
-//               zBuffer  - memory block for occupied diagram area
-void Rect3DDiagram::calcLine(tPoint3D* &p, tPoint3D* &MemEnd,
-				tBound *Bounds, char *zBuffer)
-{
-  int Pos_;
-  int x1_ = p->x, y1_ = p->y;
-  int x2_ = (p+1)->x, y2_ = (p+1)->y;
-
-  bool wasHidden = isHidden(x1_, y1_, Bounds, zBuffer);
-  if(wasHidden)
-    if((p->done & 1) == 0)
-      p->done |= 4;   // mark as hidden
-
-  int ax_ = 0, ay_ = 0;
-  int ix_, iy_, dx_, dy_, of_;
-
-  if(x2_ >= x1_) {
-    dx_ = x2_ - x1_;
-    ix_ = 1;
-  }
-  else {
-    dx_ = x1_ - x2_;
-    ix_ = -1;
-  }
-
-  if(y2_ >= y1_) {
-    dy_ = y2_ - y1_;
-    iy_ = 1;
-  }
-  else {
-    dy_ = y1_ - y2_;
-    iy_ = -1;
-  }
-
-  if(dx_ < dy_) {
-    of_ = dx_;   // exchange dx and dy
-    dx_ = dy_;
-    dy_ = of_;
-
-    ax_ = iy_;
-    ay_ = ix_;
-    ix_ = iy_ = 0;
-  }
-
-  of_ = dx_ >> 1;
-  for(int i=dx_; i>1; i--) {   // calculate each point of the line
-    x1_ += ix_;
-    y1_ += ax_;
-    of_ += dy_;
-    if(of_ > dx_) {
-      of_ -= dx_;
-      x1_ += ay_;
-      y1_ += iy_;
-    }
-
-    // This section has significant impact to the hiding algorithm
-    //   be aware isHidden() modifies (Bounds+x)->min/max
-    // if isHidden() is replaced by  false  nearly all segments are drawn,
-    //   nothing set hidden by this section ... though few segments are hidden
-    // if isHidden() is replaced by true  most segments are not drawn
-    //   and many line-ends are outside the diagram-are (mem/malloc-issue?)
-    if( isHidden(x1_, y1_, Bounds, zBuffer) != wasHidden )
-      if((p->done & 1) == 0) {
-        wasHidden = !wasHidden;
-        pMem->x  = x1_;
-        pMem->y  = y1_;
-        pMem->No = p->No;
-        pMem->done = 0;
-        if(wasHidden) pMem->done = 4;   // mark as hidden
-        pMem++;
-
-        Pos_ = p - Mem;
-        // Enlarge memory block if neccessary.
-        enlargeMemoryBlock(MemEnd);   // this may make "p" invalid (realloc)
-        p = Mem + Pos_;  // rebuild "p"
-    }
-  }
-
-  // extra treatment for last point (create no further point)
-  // OLD: implementation hides most of the segmets
-  // NEW: unhide missing segments
-  if(!isHidden((p+1)->x, (p+1)->y, Bounds, zBuffer))
-  {
-    if(!isHidden((p)->x, (p)->y, Bounds, zBuffer))
-    {
-      (p+1)->done &= ~4;
-    }
-    else
-    {
-      (p)->done &= ~4;
-    }
-  }
-
-  // If this assignment is commented-out all inner segments are not drawn.
-  // Just the surrounding boundary (all segments) of the mesh is drawn
-  p->done |= 1;   // mark as already worked on
-}
-
-// --------------------------------------------------------------
-// Compare functions for GNU qsort routine.
-int Rect3DDiagram::comparePoint3D(const void *Point1, const void *Point2)
-{
-  return ((tPoint3D*)Point1)->No - ((tPoint3D*)Point2)->No;
-}
-int Rect3DDiagram::comparePointZ(const void *Point1, const void *Point2)
-{
-  if((((tPointZ*)Point2)->z - ((tPointZ*)Point1)->z) < 0.0f)
-    return -1;
-  return 1;
+  *pz = float(calcZ_2D(x, y, zr));
 }
 
 // --------------------------------------------------------------
 // Removes the invisible parts of the graph.
-void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
+void Rect3DDiagram::removeHiddenLines(HiddenLines& Hidden)
 {
   double Dummy = 0.0;  // number for 1-dimensional data in 3D cartesian
   double *px, *py, *pz;
 
-  tPoint3D *p;
   int i, j, z, dx, dy, Size=0;
-  // pre-calculate buffer size to avoid reallocations in the first step
+  // every point once in the grid and once in the cross grid
   foreach(Graph *g, Graphs)
-    if(g->cPointsY)
+    if(g->cPointsY && g->numAxes() >= 1) {
       Size += g->axis(0)->count * g->countY;
+      if(g->countY > 1)  Size += g->axis(0)->count * g->countY;
+    }
+  Points.resize(Size);
 
-  // "Mem" should be the last malloc to simplify realloc
-  // multiplicator 'malloc_8xsize' added
-  // 'malloc_8xsize' increases the requested size in the 2 malloc lines below
-  // this comment section.
-  // And it is added to the calculation of 'MemEnd'.
-  // Main reason are the segments drawn to points outside the diagram.
-  // It is assumed to be a memory issue.
-  // Note: As of today the memory calculation is still not 100% clean.
-  int malloc_8xsize=8;
-  tPointZ *zMem = (tPointZ*)malloc( malloc_8xsize*(Size+2)*sizeof(tPointZ) );
-  Mem  = (tPoint3D*)malloc( malloc_8xsize*2*(Size+2)*sizeof(tPoint3D) );
-
-  pMem = Mem;
-  tPointZ *zp = zMem, *zp_tmp;
+  tPoint3D *p = Points.data(), *q;
+  QVector<float> zMem;  // depth of the grid points of the current graph
+  float *zp;
 
   // ...............................................................
   foreach(Graph *g, Graphs) {
@@ -419,209 +269,88 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     py = &Dummy;
     if(g->countY > 1)  py = g->axis(1)->Points;
 
-    p = pMem;  // save status for cross grid
-    zp_tmp = zp;
+    int First = p - Points.data();  // save status for cross grid
     // ..........................................
     // calculate coordinates of all lines
     dx = g->axis(0)->count;
     if(g->countY > 1)  dy = g->axis(1)->count;
     else  dy = 0;
+    zMem.resize(dx * g->countY);
+    zp = zMem.data();
     for(i=g->countY-1; i>=0; i--) {   // y coordinates
       px = g->axis(0)->Points;
-    
+
       for(j=dx; j>0; j--) { // x coordinates
-        calcCoordinate3D(*(px++), *py, *pz, *(pz+1), pMem++, zp++);
+        calcCoordinate3D(*(px++), *py, *pz, *(pz+1), p++, zp++);
         pz += 2;
       }
 
-      (pMem-1)->done |= 8;  // mark as "last in line"
+      (p-1)->done |= 8;  // mark as "last in line"
       py++;
       if(dy > 0) if((i % dy) == 0)
         py = g->axis(1)->Points;
     }
-    (pMem-1)->done |= 512;  // mark as "last point before grid"
+    (p-1)->done |= 512;  // mark as "last point before grid"
 
     // ..........................................
     // copy points for cross lines ("dx", "dy" still unchanged ! )
+    int Cross = p - Points.data();
     if(g->countY > 1) {
-      zp = zp_tmp;
+      q = Points.data() + First;
       for(j=g->countY/dy; j>0; j--) { // every plane
         for(i=dx; i>0; i--) {  // every branch
           for(z=dy; z>0; z--) {  // every point
-            pMem->x  = p->x;
-            pMem->y  = p->y;
-            pMem->No = pMem-Mem;
-            pMem->done = 0;
-            zp->NoCross = pMem-Mem; // position of its cross grid
-            pMem++;
-            p += dx;  // next coordinate
-            zp += dx;
+            p->x  = q->x;
+            p->y  = q->y;
+            p->No = p - Points.data();
+            p->done = 0;
+            p++;
+            q += dx;  // next coordinate
           }
-          (pMem-1)->done |= 8;  // mark as "last in line"
-          p  -= dx*dy - 1;  // next z coordinate
-          zp -= dx*dy - 1;
+          (p-1)->done |= 8;  // mark as "last in line"
+          q -= dx*dy - 1;  // next z coordinate
         }
-        p  += dx*(dy-1);
-        zp += dx*(dy-1);
+        q += dx*(dy-1);
       }
     }
-    (pMem-1)->done |= 256;  // mark as "very last point"
-
+    (p-1)->done |= 256;  // mark as "very last point"
 
-    if(hideLines) {
+    if(!hideLines || (dy < 1))  continue;
     // ..........................................
-    // Calculate the z-coordinate of all polygons by building the
-    // sum of the z-coordinates of all of its 4 corners.
-    // After this, each point represents one polygon. The unneccessary
-    // points are filled with "-FLTMAX".
-    zp = zp_tmp;
-    // "dx" and "dy" are still unchanged !
+    // Each polygon gets the sum of the z-coordinates of its 4 corners
+    // as depth. "dx" and "dy" are still unchanged !
+    zp = zMem.data();
     for(i=g->countY-1; i>=0; i--) {   // all branches
-      if(dy > 0) if(i % dy) {
-        for(j=dx-1; j>0; j--) {   // x coordinates
-          zp->z += (zp+1)->z + (zp+dx)->z + (zp+dx+1)->z;
-          zp++;
-        }
-        zp->z = -FLT_MAX;  // last one not needed
-        zp++;
+      if((i % dy) == 0) {  // last line of a plane has no polygons
+        zp += dx;
         continue;
       }
-
-      // last line not needed
-      for(j=dx; j>0; j--) {   // x coordinates
-        zp->z = -FLT_MAX;  // last one not needed
+      for(j=0; j<dx-1; j++) {   // x coordinates
+        int No = zp - zMem.data();
+        int NoCross = Cross + (No / (dx*dy)) * dx*dy + j*dy + (No / dx) % dy;
+        Hidden.addPolygon(*zp + *(zp+1) + *(zp+dx) + *(zp+dx+1),
+                          First + No, First + No + dx, NoCross, NoCross + dy);
         zp++;
       }
+      zp++;  // last one not needed
     }
-    }  // of "if(hideLines)"
-
   }  // of "for(Graphs)"
 
-
-  if(!hideLines) {  // do not hide invisible lines
-    free(zMem);
-    return;
-  }
-
-#if 0
-  qDebug("##########################################");
-  qDebug("Size 1b: Size=%d, %d, %d", Size, pMem-Mem, zp-zMem);
-  for(tPoint3D *p=Mem; p<pMem; p++)
-    qDebug("xyPoints:  %d/%d - %d - %d", p->x, p->y, p->No, p->done);
-  qDebug("------------------------------------------");
-  for(tPointZ *p=zMem; p-zMem<Size; p++)
-    qDebug("zPoints:   %g - %d", p->z, p->No);
-#endif
-
-
-  // ..........................................
-  // Sort z-coordinates (greatest first).
-  // After this the polygons that have the smallest distance to the
-  // viewer are on top of the list and thus, will be processed first.
-  qsort(zMem, Size, sizeof(tPointZ), comparePointZ);
-
-#if 0
-  qDebug("--------------------------- z sorting");
-  for(tPointZ *p=zMem; p-zMem<Size; p++)
-    qDebug("zPoints:   %g - %d", p->z, p->No);
-#endif
-
-
-  // ..........................................
-  char *pc;
-  // malloc_8xsize added (see comment before malloc_8xsize declaration)
-  tPoint3D *MemEnd = Mem + malloc_8xsize*2*Size - 5;   // limit of buffer
-
-  zp = zMem;
-  foreach(Graph *g, Graphs) {
-    if(!g->cPointsY) continue;
-    dx = g->axis(0)->count;
-    if(g->countY > 1)  dy = g->axis(1)->count;
-    else  dy = 1;
-
-    // look for hidden lines ...
-    for(int No = g->countY/dy * (dx-1)*(dy-1); No>0; No--) {
-
-      // reset the polygon bounding buffer
-      for(i=x2; i>=0; i--) {
-        (Bounds+i)->max = INT_MIN;
-        (Bounds+i)->min = INT_MAX;
-      }
-
-      // work on all 4 lines of polygon
-      p = Mem + zp->No;  // polygon corner coordinates
-      calcLine(p, MemEnd, Bounds, zBuffer);
-
-      p += dx;
-      calcLine(p, MemEnd, Bounds, zBuffer);
-
-      p = Mem + zp->NoCross;  // cross grid
-      calcLine(p, MemEnd, Bounds, zBuffer);
-
-      p += dy;
-      calcLine(p, MemEnd, Bounds, zBuffer);
-
-      // mark the area of the polygon (stored in "*Bounds") as used
-      for(i=x2-1; i>=0; i--)  // all x coordinates
-        if( (Bounds+i)->max > INT_MIN) {
-          pc = zBuffer + i * ((y2+7)>>3);
-          for(j=(Bounds+i)->min; j<=(Bounds+i)->max; j++) // all y coordinates
-            *(pc + (j>>3)) |= (1 << (j & 7));
-        }
-
-      zp++;   // next polygon
-    }
-
-  }  // of "for(Graphs)"
-
-#if 0
-  qDebug("--------------------------- hidden lines %d", pMem-Mem);
-  for(tPoint3D *p=Mem; p<pMem; p++)
-    qDebug("xyPoints:  %d/%d - %d - %d", p->x, p->y, p->No, p->done);
-#endif
-
-  free(zMem);
-
-  // sort "No" (least one first)
-  qsort(Mem, pMem - Mem, sizeof(tPoint3D), comparePoint3D);
-
-#if 0
-  qDebug("--------------------------- last sorting %d", pMem-Mem);
-  for(tPoint3D *p=Mem; p<pMem; p++)
-    qDebug("xyPoints:  %d/%d - %d - %d", p->x, p->y, p->No, p->done);
-  qDebug("\n");
-#endif
+  if(hideLines)  // do not hide invisible lines otherwise
+    Hidden.run(Points);
 }
 
 // --------------------------------------------------------------
 // Removes the invisible parts of the coordinate cross.
 void Rect3DDiagram::removeHiddenCross(int x1_, int y1_, int x2_, int y2_,
-                                      char *zBuffer, tBound *Bounds)
+                                      HiddenLines const& Hidden)
 {
-  pMem = Mem;
-
-  pMem->x  = x1_;
-  pMem->y  = y1_;
-  pMem->No = 0;
-  pMem->done = 0;
-  pMem++;
-
-  pMem->x  = x2_;
-  pMem->y  = y2_;
-  pMem->No = 1;
-  pMem->done = 0;
-  pMem++;
-
-  tPoint3D *p = Mem+6;
-  calcLine(Mem, p, Bounds, zBuffer);
-  *pMem = *(Mem+1);
-  *(Mem+1) = *Mem;
-  p = Mem+2;
-  do {
-    if(((p-1)->done & 4) == 0)
-      Lines.append(new Line((p-1)->x, (p-1)->y, p->x, p->y, QPen(Qt::black,0)));
-    p++;
-  } while(p <= pMem);
+  QVector<tPoint3D> Cut;
+  Hidden.cutLine(x1_, y1_, x2_, y2_, Cut);
+  for(int i=1; i<Cut.size(); i++)
+    if((Cut.at(i-1).done & 4) == 0)
+      Lines.append(new Line(Cut.at(i-1).x, Cut.at(i-1).y,
+                            Cut.at(i).x, Cut.at(i).y, QPen(Qt::black,0)));
 }
 
 // --------------------------------------------------------------
@@ -790,8 +519,7 @@ void Rect3DDiagram::createAxis(Axis *Axis, bool Right,
       if(Axis != &zAxis) {
         if(!pg->cPointsY)  continue;
         if(valid < 0) {
-          delete[] pg->cPointsY;
-          pg->cPointsY = 0;
+          pg->clearPointsY();
           continue;
         }
         pD = pg->axis(Index);
@@ -834,8 +562,7 @@ int Rect3DDiagram::calcDiagram()
   x3 = x2 + 7;
   int z, z2, o, w;
 
-  char *zBuffer=0;   // hidden line algorithm
-  tBound *Bounds=0;
+  HiddenLines Hidden(x2, y2);   // hidden line algorithm
 
 
   // =====  give "step" the right sign  ==================================
@@ -924,34 +651,14 @@ int Rect3DDiagram::calcDiagram()
   createAxis(&zAxis, true, X[z], Y[z], X[z2], Y[z2]);
 
 
-  if(hideLines) {
-    w = (x2+1) * (y2/8 + 1);
-    // To store the pixel coordinates that are already used (hidden).
-    // Use one bit per pixel.
-    zBuffer = (char*)malloc(w);
-    memset(zBuffer, 0, w);
-
-    // To store the boundings of the current polygon.
-    Bounds = (tBound*)malloc((x2+1) * sizeof(tBound));
-  }
-
   // hide invisible parts of graphs
-  removeHiddenLines(zBuffer, Bounds);
+  removeHiddenLines(Hidden);
 
   if(hideLines) {
     // now hide invisible part of coordinate cross
-    tPoint3D *MemTmp = Mem;
-    Mem = (tPoint3D*)malloc( 10*sizeof(tPoint3D) );
-    
-    removeHiddenCross(X[o^1], Y[o^1], X[o], Y[o], zBuffer, Bounds); // x axis
-    removeHiddenCross(X[o^2], Y[o^2], X[o], Y[o], zBuffer, Bounds); // y axis
-    removeHiddenCross(X[o^4], Y[o^4], X[o], Y[o], zBuffer, Bounds); // z axis
-  
-    free(Mem);
-    Mem = MemTmp;  // write back values
-
-    free(Bounds);
-    free(zBuffer);
+    removeHiddenCross(X[o^1], Y[o^1], X[o], Y[o], Hidden); // x axis
+    removeHiddenCross(X[o^2], Y[o^2], X[o], Y[o], Hidden); // y axis
+    removeHiddenCross(X[o^4], Y[o^4], X[o], Y[o], Hidden); // z axis
   }
   else {
     Lines.append(new Line(X[o], Y[o], X[o^1], Y[o^1], QPen(Qt::black,0)));
@@ -959,7 +666,7 @@ int Rect3DDiagram::calcDiagram()
     Lines.append(new Line(X[o], Y[o], X[o^4], Y[o^4], QPen(Qt::black,0)));
   }
 
-  pMem = Mem;
+  Mem = pMem = Points.isEmpty() ? 0 : Points.data();
   return 3;
 
 
@@ -1051,7 +758,7 @@ void Rect3DDiagram::calcData(Graph *g)
 // for the coordinates is released here.
 void Rect3DDiagram::createAxisLabels()
 {
-  if(Mem)  free (Mem);
+  Points.clear();
   Mem  = 0;
   pMem = 0;
 }
@@ -19,21 +19,9 @@
 #define RECT3DDIAGRAM_H
 
 #include "diagram.h"
+#include "hiddenlines.h"
 
-
-struct tPoint3D {
-  int   x, y;
-  int   No, done;
-};
-
-struct tPointZ {
-  float z;
-  int   No, NoCross;
-};
-
-struct tBound {
-  int min, max;
-};
+#include <QVector>
 
 
 class Rect3DDiagram : public Diagram  {
@@ -52,7 +40,8 @@ public:
   void createAxisLabels();
   bool insideDiagram(float, float) const;
 
-  tPoint3D *Mem;   // memory for all points during hidden line algorithm
+  QVector<tPoint3D> Points;  // all points during hidden line algorithm
+  tPoint3D *Mem;   // first point in "Points"
   tPoint3D *pMem;  // current position in "Mem"
 
 
@@ -69,14 +58,9 @@ private:
   double calcY_2D(double, double, double) const;
   double calcZ_2D(double, double, double) const;
 
-  static int comparePoint3D(const void*, const void*);
-  static int comparePointZ(const void*, const void*);
-  bool isHidden(int, int, tBound*, char*);
-  void enlargeMemoryBlock(tPoint3D* &);
-  void calcLine(tPoint3D* &, tPoint3D* &, tBound*, char*);
-  void calcCoordinate3D(double, double, double, double, tPoint3D*, tPointZ*);
-  void removeHiddenLines(char*, tBound*);
-  void removeHiddenCross(int, int, int, int, char*, tBound*);
+  void calcCoordinate3D(double, double, double, double, tPoint3D*, float*);
+  void removeHiddenLines(HiddenLines&);
+  void removeHiddenCross(int, int, int, int, HiddenLines const&);
 
   float  xorig, yorig; // where is the 3D origin with respect to cx/cy
   double cxx, cxy, cxz, cyx, cyy, cyz, czx, czy, czz; // coefficients 3D -> 2D
@@ -28,6 +28,7 @@
 #include "qucs.h"
 #include <cmath>
 #include "misc.h"
+#include "digitalwave.h"
 
 
 TabDiagram::TabDiagram(int _cx, int _cy) : Diagram(_cx, _cy)
@@ -257,7 +258,7 @@ int TabDiagram::calcDiagram()
     py = g->cPointsY - 2;
     if(g->axis(0)) {
 
-      if (!g->cPointsY) {   // no data points
+      if (!g->cPointsY && !g->cPointsD) {   // no data points
 	Str = QObject::tr("invalid");
 	colWidth = checkColumnWidth(Str, metrics, colWidth, x, y);
 	if(colWidth < 0)  goto funcEnd;
@@ -286,20 +287,15 @@ int TabDiagram::calcDiagram()
           }
 
         else {  // digital data
-          char *pcy = (char*)g->cPointsY;
           for(; z>0; z--) {
-            if(startWriting-- > 0) {  // reached visible area ?
-              pcy += strlen(pcy) + 1;
-              continue;
-            }
+            if(startWriting-- > 0) continue; // reached visible area ?
             if(y < tHeight) break;           // no room for more rows ?
-            Str = QString(pcy);
+            Str = g->cPointsD->vector(g->cPointsD->count() - z);
 
             colWidth = checkColumnWidth(Str, metrics, colWidth, x, y);
             if(colWidth < 0)  goto funcEnd;
 
             Texts.append(new Text(x, y, Str));
-            pcy += strlen(pcy) + 1;
             y -= tHeight;
           }
         }
@@ -23,6 +23,7 @@
 #include "timingdiagram.h"
 #include "qucs.h"
 #include "misc.h"
+#include "digitalwave.h"
 
 #include <cmath>
 #include <QPolygon>
@@ -188,17 +189,15 @@ int TimingDiagram::calcDiagram()
   // First check the maximum bit number of all vectors.
   colWidth = 0;
   foreach(Graph *g, Graphs)
-    if(g->cPointsY) {
-      if(g->Var.right(2) == ".X") {
-        z = strlen((char*)g->cPointsY);
-        if(z > colWidth)
-          colWidth = z;
-      }
-      else {
-        z = 8;
-        if(z > colWidth)
-          colWidth = z;
-      }
+    if(g->cPointsD) {
+      z = g->cPointsD->width();
+      if(z > colWidth)
+        colWidth = z;
+    }
+    else if(g->cPointsY) {
+      z = 8;
+      if(z > colWidth)
+        colWidth = z;
     }
   int TimeStepWidth = colWidth * metrics.width("X") + 8;
   if(TimeStepWidth < 40)
@@ -288,7 +287,7 @@ if(!firstGraph->isEmpty()) {
     x = xStart + 5;
     colWidth = 0;
 
-    if(g->cPointsY == 0) {
+    if((g->cPointsY == 0) && (g->cPointsD == 0)) {
       Str = QObject::tr("no data");
       colWidth = checkColumnWidth(Str, metrics, colWidth, x, y);
       if(colWidth < 0)  goto funcEnd;
@@ -345,33 +344,36 @@ if(!firstGraph->isEmpty()) {
 
 
     // digital variable !!!
-    char *pcx = (char*)g->cPointsY;
-    pcx += z * (strlen(pcx)+1);
+    DigitalWave const *Wave = g->cPointsD;
+    if(Wave->count() == 0) {
+      y -= tHeight;
+      continue;
+    }
+    z = qBound(0, z, Wave->count());   // the samples are read right away
 
-    if(strlen(pcx) < 2) {   // vector or single bit ?
+    if(Wave->width() < 2) {   // vector or single bit ?
 
       // It is single "bit".
       yLast = 0;
-      if(z > 0)  yLast += 2; // vertical line before first value ?
-      switch(*(pcx-yLast)) {  // high or low ?
-        case '0':  // low
+      if(z > 0)  yLast += 1; // vertical line before first value ?
+      switch(Wave->level(z-yLast, 0)) {  // high or low ?
+        case DigitalWave::Low:
           yLast = tHeight - 5;
           break;
-        case '1':  // high
+        case DigitalWave::High:
           yLast = 1;
           break;
         default:
           yLast = 1 + ((tHeight - 6) >> 1);
       }
 
-      z = g->axis(0)->count - z;
-      for( ; z>0; z--) {
+      for( ; z<Wave->count(); z++) {
 
-        switch(*pcx) {
-          case '0':  // low
+        switch(Wave->level(z, 0)) {
+          case DigitalWave::Low:
             yNow = tHeight - 5;
             break;
-          case '1':  // high
+          case DigitalWave::High:
             yNow = 1;
             break;
           default:
@@ -381,10 +383,10 @@ if(!firstGraph->isEmpty()) {
         if(yLast != yNow)
           Lines.append(new Line(x, y-yLast, x, y-yNow, Pen));
         if(x+TimeStepWidth >= x2) break;
-        if((*pcx & 254) == '0')
+        if(Wave->level(z, 0) <= DigitalWave::High)
           Lines.append(new Line(x, y-yNow, x+TimeStepWidth, y-yNow, Pen));
         else {
-          Texts.append(new Text(x+(TimeStepWidth>>1)-3, y, QString(pcx)));
+          Texts.append(new Text(x+(TimeStepWidth>>1)-3, y, Wave->vector(z)));
           Lines.append(new Line(x+3, y-1, x+TimeStepWidth-3, y-1, Pen));
           Lines.append(new Line(x+3, y-tHeight+5, x+TimeStepWidth-3, y-tHeight+5, Pen));
           Lines.append(new Line(x, y-yNow, x+3, y-1, Pen));
@@ -395,25 +397,22 @@ if(!firstGraph->isEmpty()) {
 
         yLast = yNow;
         x += TimeStepWidth;
-        pcx += 2;
       }
 
     }
     else {  // It is a bit vector !!!
 
-      z = g->axis(0)->count - z;
       yNow = 1 + ((tHeight - 6) >> 1);
       Lines.append(new Line(x, y-yNow, x+2, y-1, Pen));
       Lines.append(new Line(x+2, y-tHeight+5, x, y-yNow, Pen));
-      for( ; z>0; z--) {
+      for( ; z<Wave->count(); z++) {
         if(x+TimeStepWidth >= x2) break;
         Lines.append(new Line(x+2, y-1, x+TimeStepWidth-2, y-1, Pen));
         Lines.append(new Line(x+2, y-tHeight+5, x+TimeStepWidth-2, y-tHeight+5, Pen));
 
-        Texts.append(new Text(x+3, y, QString(pcx)));
+        Texts.append(new Text(x+3, y, Wave->vector(z)));
 
         x += TimeStepWidth;
-        pcx += strlen(pcx) + 1;
         Lines.append(new Line(x-2, y-tHeight+5, x+2, y-1, Pen));
         Lines.append(new Line(x+2, y-tHeight+5, x-2, y-1, Pen));
       }
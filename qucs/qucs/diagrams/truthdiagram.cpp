@@ -26,6 +26,7 @@
 
 #include "truthdiagram.h"
 #include "qucs.h"
+#include "digitalwave.h"
 
 
 TruthDiagram::TruthDiagram(int _cx, int _cy) : TabDiagram(_cx, _cy)
@@ -95,7 +96,6 @@ int TruthDiagram::calcDiagram()
   int NumAll=0;   // how many numbers per column
   int NumLeft=0;  // how many numbers could not be written
 
-  char *py;
   int counting, invisibleCount=0;
   int startWriting, z;
 
@@ -184,9 +184,9 @@ int TruthDiagram::calcDiagram()
           }
         }
 
-        else {  // digital variable !!!
-          py = (char*)g->cPointsY;
-          counting = strlen((char*)py);    // count number of "bits"
+        else if(g->cPointsD) {  // digital variable !!!
+          DigitalWave const *Wave = g->cPointsD;
+          counting = Wave->width();    // count number of "bits"
 
           digitWidth = metrics.width("X") + 2;
           if((x+digitWidth*counting) >= x2) {    // enough space for "bit vector" ?
@@ -194,20 +194,16 @@ int TruthDiagram::calcDiagram()
             goto funcEnd;
           }
 
-          for(z = NumAll; z>0; z--) {
-            if(startWriting-- > 0) {   // reached visible area ?
-              py += counting + 1;
-              continue;
-            }
+          // start right in the visible area, the scrollbar may be
+          // before the first sample
+          if(startWriting < 0)  startWriting = 0;
+          for(z = startWriting; z < Wave->count(); z++) {
             if(y < tHeight) break;    // no room for more rows ?
 
-            zi = 0;
-            while(*py) {
-              Str = *(py++);
-              Texts.append(new Text(x + zi, y, Str));
-              zi += digitWidth;
+            for(zi = 0; zi < counting; zi++) {
+              Str = QChar(Wave->bitChar(z, zi));
+              Texts.append(new Text(x + zi*digitWidth, y, Str));
             }
-            py++;
             y -= tHeight;
           }
 
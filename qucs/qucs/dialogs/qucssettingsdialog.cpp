@@ -159,6 +159,27 @@ QucsSettingsDialog::QucsSettingsDialog(QucsApp *parent)
     appSettingsGrid->addWidget(checkShowSchematicDescription,10,1);
     checkShowSchematicDescription->setChecked(QucsSettings.ShowDescriptionProjectTree);
 
+    appSettingsGrid->addWidget(new QLabel(tr("Load datasets through binary files:")),11,0);
+    checkBinaryDataSets = new QCheckBox(appSettingsTab);
+    checkBinaryDataSets->setToolTip(tr("Keep a binary copy next to each dataset and map it into memory, faster for large simulation results."));
+    appSettingsGrid->addWidget(checkBinaryDataSets,11,1);
+    checkBinaryDataSets->setChecked(QucsSettings.BinaryDataSets);
+
+    valJobs = new QIntValidator(0, 256, this);
+    appSettingsGrid->addWidget(new QLabel(tr("Simulations run at once:")),12,0);
+    simJobsEdit = new QLineEdit(appSettingsTab);
+    simJobsEdit->setValidator(valJobs);
+    simJobsEdit->setToolTip(tr("Number of simulations running in parallel, 0 means one per processor core."));
+    appSettingsGrid->addWidget(simJobsEdit,12,1);
+    simJobsEdit->setText(QString::number(QucsSettings.SimJobs));
+
+    appSettingsGrid->addWidget(new QLabel(tr("Split parameter sweeps into:")),13,0);
+    sweepSlicesEdit = new QLineEdit(appSettingsTab);
+    sweepSlicesEdit->setValidator(valJobs);
+    sweepSlicesEdit->setToolTip(tr("Number of simulator processes sharing the points of the outermost parameter sweep, 1 means no splitting, 0 means one per processor core."));
+    appSettingsGrid->addWidget(sweepSlicesEdit,13,1);
+    sweepSlicesEdit->setText(QString::number(QucsSettings.SweepSlices));
+
 
     t->addTab(appSettingsTab, tr("Settings"));
 
@@ -428,6 +449,7 @@ QucsSettingsDialog::~QucsSettingsDialog()
     delete all;
     delete val50;
     delete val200;
+    delete valJobs;
     delete Validator;
 }
 
@@ -644,6 +666,24 @@ void QucsSettingsDialog::slotApply()
       changed = true;
     }
 
+    if (QucsSettings.BinaryDataSets != checkBinaryDataSets->isChecked())
+    {
+      QucsSettings.BinaryDataSets = checkBinaryDataSets->isChecked();
+      changed = true;
+    }
+
+    if (QucsSettings.SimJobs != simJobsEdit->text().toInt())
+    {
+      QucsSettings.SimJobs = simJobsEdit->text().toInt();
+      changed = true;
+    }
+
+    if (QucsSettings.SweepSlices != sweepSlicesEdit->text().toInt())
+    {
+      QucsSettings.SweepSlices = sweepSlicesEdit->text().toInt();
+      changed = true;
+    }
+
     // use toDouble() as it can interpret the string according to the current locale
     if (QucsSettings.largeFontSize != LargeFontSizeEdit->text().toDouble(&ok))
     {
@@ -737,6 +777,9 @@ void QucsSettingsDialog::slotDefaultValues()
     checkAntiAliasing->setChecked(false);
     checkTextAntiAliasing->setChecked(true);
     checkShowSchematicDescription->setChecked(false);
+    checkBinaryDataSets->setChecked(false);
+    simJobsEdit->setText("0");
+    sweepSlicesEdit->setText("1");
 }
 
 // -----------------------------------------------------------
@@ -80,10 +80,11 @@ public:
     QFont Font;
     QCheckBox *checkWiring, *checkLoadFromFutureVersions,
               *checkAntiAliasing, *checkTextAntiAliasing,
-              *checkShowSchematicDescription;
+              *checkShowSchematicDescription, *checkBinaryDataSets;
     QComboBox *LanguageCombo;
     QPushButton *FontButton, *BGColorButton;
-    QLineEdit *LargeFontSizeEdit, *undoNumEdit, *editorEdit, *Input_Suffix,
+    QLineEdit *LargeFontSizeEdit, *undoNumEdit, *editorEdit, *simJobsEdit, *sweepSlicesEdit,
+              *Input_Suffix,
               *Input_Program, *homeEdit, *admsXmlEdit, *ascoEdit, *octaveEdit;
     QTableWidget *fileTypesTableWidget, *pathsTableWidget;
     QStandardItemModel *model;
@@ -95,6 +96,7 @@ public:
     QVBoxLayout *all;
     QIntValidator *val50;
     QIntValidator *val200;
+    QIntValidator *valJobs;
     QRegExp Expr;
     QRegExpValidator *Validator;
 
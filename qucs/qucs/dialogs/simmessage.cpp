@@ -40,6 +40,8 @@ using namespace std;
 #include <QMessageBox>
 
 #include "simmessage.h"
+#include "simqueue.h"
+#include "sweepsplitter.h"
 #include "module.h"
 #include "qucs.h"
 #include "textdoc.h"
@@ -74,6 +76,9 @@ SimMessage::SimMessage(QWidget *w, QWidget *parent)
   showBias = Doc->showBias;     // save some settings as the document...
   SimOpenDpl = Doc->SimOpenDpl; // ...could be closed during the simulation.
   SimRunScript = Doc->SimRunScript;
+  WorkDir = QucsSettings.QucsHomeDir;
+  ownWorkDir = false;
+  Sweep = 0;
 
   all = new QVBoxLayout(this);
   all->setSpacing(5);
@@ -137,7 +142,11 @@ SimMessage::SimMessage(QWidget *w, QWidget *parent)
  */
 SimMessage::~SimMessage()
 {
+  SimQueue::instance()->remove(this);
   if(SimProcess.state()==QProcess::Running)  SimProcess.kill();
+  delete Sweep;
+  if(ownWorkDir)
+    SimQueue::removeWorkDir(WorkDir);
   delete all;
 }
 
@@ -161,9 +170,29 @@ bool SimMessage::startProcess()
     return false;
   }
 
+  // Every simulation gets a directory of its own, so several of them can
+  // run at once. Only ASCO expects its files in the home directory.
+  if(!QucsApp::isTextDocument(DocWidget) &&
+     findOptimization((Schematic*)DocWidget)) {
+    foreach(SimMessage *sim, SimQueue::instance()->jobs())
+      if(!sim->ownWorkDir) {
+        ErrText->appendPlainText(tr("ERROR: Another optimization is still running!"));
+        FinishSimulation(-1);
+        return false;
+      }
+  }
+  else {
+    if(!SimQueue::createWorkDir(WorkDir)) {
+      ErrText->appendPlainText(tr("ERROR: Cannot create simulation directory!"));
+      FinishSimulation(-1);
+      return false;
+    }
+    ownWorkDir = true;
+  }
+
   Collect.clear();  // clear list for NodeSets, SPICE components etc.
   ProgText->appendPlainText(tr("creating netlist... "));
-  NetlistFile.setFileName(QucsSettings.QucsHomeDir.filePath("netlist.txt"));
+  NetlistFile.setFileName(WorkDir.filePath("netlist.txt"));
    if(!NetlistFile.open(QIODevice::WriteOnly)) {
     ErrText->appendPlainText(tr("ERROR: Cannot write netlist file!"));
     FinishSimulation(-1);
@@ -342,8 +371,8 @@ void SimMessage::startSimulator()
   // faster than the user (I have no other idea).
 
   QString SimTime;
-  QStringList Arguments;
-  QString SimPath = QDir::toNativeSeparators(QucsSettings.QucsHomeDir.absolutePath());
+  Arguments.clear();
+  QString SimPath = QDir::toNativeSeparators(WorkDir.absolutePath());
 #ifdef __MINGW32__
   QString QucsDigiLib = "qucsdigilib.bat";
   QString QucsDigi = "qucsdigi.bat";
@@ -355,7 +384,6 @@ void SimMessage::startSimulator()
 #endif
   SimOpt = NULL;
   bool isVerilog = false;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
 
   // Simulate text window.
   if(QucsApp::isTextDocument(DocWidget)) {
@@ -390,7 +418,7 @@ void SimMessage::startSimulator()
       }
 #endif
       Program = pathName(QucsSettings.BinDir + QucsDigi);
-      Arguments  << QucsSettings.QucsHomeDir.filePath("netlist.txt")
+      Arguments  << WorkDir.filePath("netlist.txt")
                  << DataSet << SimTime << pathName(SimPath)
                  << pathName(QucsSettings.BinDir) << libs;
     }
@@ -427,7 +455,7 @@ void SimMessage::startSimulator()
       destFile.write(text.toAscii(), text.length());
       destFile.close();
       Program = pathName(QucsSettings.BinDir + QucsDigiLib);
-      Arguments << QucsSettings.QucsHomeDir.filePath("netlist.txt")
+      Arguments << WorkDir.filePath("netlist.txt")
                 << pathName(SimPath)
                 << entity
                 << lib;
@@ -536,14 +564,14 @@ void SimMessage::startSimulator()
       else {
         Program = QucsSettings.Qucsator;
         Arguments << "-b" << "-g" << "-i"
-                  << QucsSettings.QucsHomeDir.filePath("netlist.txt")
+                  << WorkDir.filePath("netlist.txt")
                   << "-o" << DataSet;
       }
     }
     else {
       if (isVerilog) {
           Program = QDir::toNativeSeparators(QucsSettings.BinDir + QucsVeri);
-          Arguments << QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("netlist.txt"))
+          Arguments << QDir::toNativeSeparators(WorkDir.filePath("netlist.txt"))
                     << DataSet
                     << SimTime
                     << QDir::toNativeSeparators(SimPath)
@@ -553,14 +581,14 @@ void SimMessage::startSimulator()
 /// \todo \bug error: unrecognized command line option '-Wl'
 #ifdef __MINGW32__
     Program = QDir::toNativeSeparators(pathName(QucsSettings.BinDir + QucsDigi));
-    Arguments << QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("netlist.txt"))
+    Arguments << QDir::toNativeSeparators(WorkDir.filePath("netlist.txt"))
               << DataSet
               << SimTime
               << QDir::toNativeSeparators(SimPath)
               << QDir::toNativeSeparators(QucsSettings.BinDir) << "-Wall" << "-c";
 #else
     Program = QDir::toNativeSeparators(pathName(QucsSettings.BinDir + QucsDigi));
-    Arguments << QucsSettings.QucsHomeDir.filePath("netlist.txt")
+    Arguments << WorkDir.filePath("netlist.txt")
               << DataSet << SimTime << pathName(SimPath)
 		      << pathName(QucsSettings.BinDir) << "-Wall" << "-c";
 
@@ -569,6 +597,28 @@ void SimMessage::startSimulator()
     }
   }
 
+  if(simKilled) {  // aborted while converting SPICE netlists
+    FinishSimulation(-1);
+    return;
+  }
+
+  SimQueue::instance()->enqueue(this);
+  if(SimQueue::instance()->isWaiting(this))
+    ProgText->appendPlainText(tr("waiting for other simulations to finish..."));
+}
+
+/*!
+ * \brief SimMessage::runSimulator starts the simulator process.
+ *
+ *  Called by SimQueue as soon as the simulation may run.
+ */
+void SimMessage::runSimulator()
+{
+  if((Program == QucsSettings.Qucsator) && startSweepSlices())
+    return;
+
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+
   disconnect(&SimProcess, 0, 0, 0);
   connect(&SimProcess, SIGNAL(readyReadStandardError()), SLOT(slotDisplayErr()));
   connect(&SimProcess, SIGNAL(readyReadStandardOutput()), SLOT(slotDisplayMsg()));
@@ -590,6 +640,14 @@ void SimMessage::startSimulator()
   QString sep(":");
 #endif
 
+  // the VHDL libraries stay in the home directory, the scripts run in
+  // the private work directory
+  env.insert("QUCS_VHDL_DIR",
+             QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("vhdl")));
+  // compiled digital designs, unless the user keeps them elsewhere
+  if(!env.contains("QUCS_DIGI_CACHE"))
+    env.insert("QUCS_DIGI_CACHE",
+               QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("cache/digi")));
   SimProcess.setProcessEnvironment(env);
 
   qDebug() << "Command :" << Program << Arguments.join(" ");
@@ -597,6 +655,69 @@ void SimMessage::startSimulator()
 
 }
 
+/*!
+ * \brief SimMessage::startSweepSlices runs a parameter sweep in slices.
+ *
+ *  Splits the outermost parameter sweep of the netlist and starts one
+ *  simulator per slice, see SweepSplitter. Returns false if the sweep
+ *  is not to be split or cannot be split.
+ */
+bool SimMessage::startSweepSlices()
+{
+  int n = QucsSettings.SweepSlices;
+  if(n <= 0)  n = SimQueue::maxJobs();
+  if(n < 2)  return false;
+
+  QStringList Netlists;
+  n = SweepSplitter::split(WorkDir.filePath("netlist.txt"), n, Netlists, SweepVar);
+  if(n < 2)  return false;
+
+  SweepParts.clear();
+  for(int i=1; i<=n; i++)
+    SweepParts.append(WorkDir.filePath("slice_" + QString::number(i) + ".dat"));
+
+  ProgText->appendPlainText(tr("Running sweep of \"%1\" in %2 slices...")
+                            .arg(SweepVar).arg(n));
+  Sweep = new SweepRunner(Program, Netlists, SweepParts);
+  connect(Sweep, SIGNAL(output(const QString&)), SLOT(slotSweepOutput(const QString&)));
+  connect(Sweep, SIGNAL(progress(int, int)), SLOT(slotSweepProgress(int, int)));
+  connect(Sweep, SIGNAL(finished(int)), SLOT(slotSweepEnded(int)));
+  Sweep->start();
+  return true;
+}
+
+// ------------------------------------------------------------------------
+void SimMessage::slotSweepOutput(const QString& s)
+{
+  ErrText->appendPlainText(s);
+}
+
+// ------------------------------------------------------------------------
+void SimMessage::slotSweepProgress(int done, int total)
+{
+  SimProgress->setMaximum(total);
+  SimProgress->setValue(done);
+}
+
+// ------------------------------------------------------------------------
+// all slices have finished, merge their datasets.
+void SimMessage::slotSweepEnded(int Status)
+{
+  Sweep->deleteLater();
+  Sweep = 0;
+  SimProgress->setMaximum(100);
+
+  if(Status == 0) {
+    ProgText->appendPlainText(tr("merging datasets... "));
+    QString Error;
+    if(!SweepSplitter::merge(SweepParts, DataSet, SweepVar, Error)) {
+      ErrText->appendPlainText(tr("ERROR: ") + Error);
+      Status = -1;
+    }
+  }
+  FinishSimulation(Status);
+}
+
 // ------------------------------------------------------------------------
 Component * SimMessage::findOptimization(Schematic *Doc) {
   Component *pc;
@@ -763,6 +884,8 @@ void SimMessage::slotSimEnded(int exitCode, QProcess::ExitStatus exitStatus )
  */
 void SimMessage::FinishSimulation(int Status)
 {
+  SimQueue::instance()->remove(this);  // let the next simulation run
+
   Abort->setText(tr("Close window"));
   Display->setDisabled(false);
   SimProgress->setValue(100);  // progress bar to 100%
@@ -783,7 +906,7 @@ void SimMessage::FinishSimulation(int Status)
     ProgText->appendPlainText("\n" + txt + "\n" + tr("Aborted."));
   }
 
-  QFile file(QucsSettings.QucsHomeDir.filePath("log.txt"));  // save simulator messages
+  QFile file(WorkDir.filePath("log.txt"));  // save simulator messages
   if(file.open(QIODevice::WriteOnly)) {
     QTextStream stream(&file);
     stream << tr("Output:\n-------") << "\n\n";
@@ -813,6 +936,17 @@ void SimMessage::FinishSimulation(int Status)
     }
   }
 
+  if(ownWorkDir) {
+    // keep netlist and messages for "Show Last Netlist/Messages"
+    QDir Home(QucsSettings.QucsHomeDir);
+    foreach(QString Name, QStringList() << "netlist.txt" << "log.txt") {
+      Home.remove(Name);
+      QFile::copy(WorkDir.filePath(Name), Home.filePath(Name));
+    }
+    SimQueue::removeWorkDir(WorkDir);
+    ownWorkDir = false;
+  }
+
   emit SimulationEnded(Status, this);
 }
 
@@ -838,6 +972,11 @@ void SimMessage::AbortSim()
 {
   ErrText->appendPlainText(tr("Simulation aborted by the user!"));
   simKilled = true;
-  SimProcess.kill();
+  if(SimQueue::instance()->isWaiting(this))  // not started yet
+    FinishSimulation(-1);
+  else if(Sweep)
+    Sweep->kill();
+  else
+    SimProcess.kill();
 }
 // vim:ts=8:sw=2:et
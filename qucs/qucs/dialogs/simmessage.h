@@ -22,6 +22,7 @@
 #include <QProcess>
 #include <QStringList>
 #include <QFile>
+#include <QDir>
 #include <QTextStream>
 #include <QVBoxLayout>
 
@@ -34,6 +35,7 @@ class QProcess;
 class QFile;
 class Component;
 class Schematic;
+class SweepRunner;
 
 // #define SPEEDUP_PROGRESSBAR
 
@@ -45,6 +47,7 @@ public:
  ~SimMessage();
 
   bool startProcess();
+  void runSimulator();
 
 signals:
   void SimulationEnded(int, SimMessage*);
@@ -65,6 +68,10 @@ private slots:
   void slotReadSpiceNetlist();
   void slotFinishSpiceNetlist(int status);
 
+  void slotSweepOutput(const QString&);
+  void slotSweepProgress(int, int);
+  void slotSweepEnded(int);
+
 /* #ifdef SPEEDUP_PROGRESSBAR
   void slotUpdateProgressBar();
 private:
@@ -77,6 +84,7 @@ private:
   void FinishSimulation(int);
   void nextSPICE();
   void startSimulator();
+  bool startSweepSlices();
   Component * findOptimization(Schematic *);
 
 public:
@@ -85,6 +93,8 @@ public:
   bool SimOpenDpl;
   bool SimRunScript;
   QString DocName, DataSet, DataDisplay, Script;
+  QDir WorkDir;      // netlist, log and scratch files of this simulation
+  bool ownWorkDir;   // WorkDir is private, removed when finished
 
   QProcess       SimProcess;
   QPlainTextEdit *ProgText, *ErrText;
@@ -101,9 +111,14 @@ public:
   QFile          NetlistFile;
   QTextStream    Stream;
 
+  SweepRunner    *Sweep;   // runs the slices of a split parameter sweep
+  QString        SweepVar;
+  QStringList    SweepParts;
+
   QVBoxLayout  *all;
 protected:
   QString Program;
+  QStringList Arguments;
 };
 
 #endif
@@ -0,0 +1,262 @@
+/*
+ * simqueue.cpp - schedule simulations on several worker processes
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "simqueue.h"
+#include "simmessage.h"
+#include "qucs.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QThread>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QDebug>
+
+SimQueue::SimQueue()
+{
+}
+
+SimQueue* SimQueue::instance()
+{
+  static SimQueue *Queue = new SimQueue();
+  return Queue;
+}
+
+// ---------------------------------------------------------------------
+// number of simulations run at once, by default one per core.
+int SimQueue::maxJobs()
+{
+  int n = QucsSettings.SimJobs;
+  if(n <= 0)  n = QThread::idealThreadCount();
+  if(n <= 0)  n = 1;
+  return n;
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * create an empty directory below the Qucs home directory for the
+ * netlist, the log and any intermediate files of one simulation.
+ */
+bool SimQueue::createWorkDir(QDir& WorkDir)
+{
+  static int Count = 0;
+
+  QDir Dir(QucsSettings.QucsHomeDir);
+  if(!Dir.exists("simulations"))
+    if(!Dir.mkdir("simulations"))  return false;
+  if(!Dir.cd("simulations"))  return false;
+
+  QString Name;
+  do {
+    Name = QString::number(QCoreApplication::applicationPid()) + "-"
+         + QString::number(++Count);
+  } while(Dir.exists(Name));
+
+  if(!Dir.mkdir(Name) || !Dir.cd(Name))  return false;
+  WorkDir = Dir;
+  return true;
+}
+
+// ---------------------------------------------------------------------
+// remove a work directory created by createWorkDir() and its contents.
+void SimQueue::removeWorkDir(const QDir& WorkDir)
+{
+  QDir Dir(WorkDir);
+  QString Base = QucsSettings.QucsHomeDir.absoluteFilePath("simulations");
+  if(!Dir.absolutePath().startsWith(Base + "/"))  return;  // not ours
+  if(!Dir.exists())  return;
+
+  QFileInfoList Entries =
+    Dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+  foreach(QFileInfo Info, Entries) {
+    if(Info.isDir() && !Info.isSymLink())
+      removeWorkDir(QDir(Info.absoluteFilePath()));
+    else
+      Dir.remove(Info.fileName());
+  }
+
+  QString Name = Dir.dirName();
+  if(Dir.cdUp())
+    Dir.rmdir(Name);
+}
+
+// ---------------------------------------------------------------------
+/*!
+ * append sim to the queue, its simulator is started by
+ * SimMessage::runSimulator() as soon as a worker is free.
+ */
+void SimQueue::enqueue(SimMessage *sim)
+{
+  if(Waiting.contains(sim) || Running.contains(sim))  return;
+  Waiting.append(sim);
+  emit changed();
+  schedule();
+}
+
+// ---------------------------------------------------------------------
+// to be called when sim is finished, aborted or deleted.
+void SimQueue::remove(SimMessage *sim)
+{
+  bool wasRunning = Running.removeOne(sim);
+  if(!wasRunning && !Waiting.removeOne(sim))  return;
+
+  emit changed();
+  if(wasRunning)   // not now, the caller may still be in runSimulator()
+    QTimer::singleShot(0, this, SLOT(schedule()));
+}
+
+// ---------------------------------------------------------------------
+// two jobs must neither share the output dataset nor the work directory.
+bool SimQueue::canStart(SimMessage *sim) const
+{
+  foreach(SimMessage *r, Running) {
+    if(r->DataSet == sim->DataSet)  return false;
+    if(r->WorkDir == sim->WorkDir)  return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------
+void SimQueue::schedule()
+{
+  int i = 0;
+  while((Running.size() < maxJobs()) && (i < Waiting.size())) {
+    SimMessage *sim = Waiting.at(i);
+    if(!canStart(sim)) {
+      i++;
+      continue;
+    }
+
+    Waiting.removeAt(i);
+    Running.append(sim);
+    emit changed();
+    sim->runSimulator();
+  }
+}
+
+
+// ---------------------------------------------------------------------
+SimQueueDialog::SimQueueDialog(QWidget *parent)
+  : QDialog(parent)
+{
+  setWindowTitle(tr("Qucs Simulation Queue"));
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  QVBoxLayout *all = new QVBoxLayout(this);
+  all->setSpacing(5);
+  all->setMargin(5);
+
+  JobList = new QTreeWidget();
+  JobList->setColumnCount(3);
+  JobList->setHeaderLabels(
+    QStringList() << tr("Document") << tr("Dataset") << tr("State"));
+  JobList->setRootIsDecorated(false);
+  JobList->setMinimumSize(400, 150);
+  all->addWidget(JobList);
+  connect(JobList, SIGNAL(itemSelectionChanged()), SLOT(slotSelectionChanged()));
+
+  QHBoxLayout *Butts = new QHBoxLayout();
+  all->addLayout(Butts);
+  ButtShow = new QPushButton(tr("Show messages"));
+  Butts->addWidget(ButtShow);
+  connect(ButtShow, SIGNAL(clicked()), SLOT(slotShow()));
+  ButtAbort = new QPushButton(tr("Abort simulation"));
+  Butts->addWidget(ButtAbort);
+  connect(ButtAbort, SIGNAL(clicked()), SLOT(slotAbort()));
+  Butts->addStretch();
+  QPushButton *ButtClose = new QPushButton(tr("Close"));
+  Butts->addWidget(ButtClose);
+  connect(ButtClose, SIGNAL(clicked()), SLOT(accept()));
+
+  connect(SimQueue::instance(), SIGNAL(changed()), SLOT(slotUpdate()));
+  slotUpdate();
+}
+
+// ---------------------------------------------------------------------
+SimMessage* SimQueueDialog::currentJob()
+{
+  QTreeWidgetItem *item = JobList->currentItem();
+  if(!item || !item->isSelected())  return 0;
+
+  // the job may have finished meanwhile
+  SimMessage *sim = (SimMessage*)item->data(0, Qt::UserRole).value<void*>();
+  if(!SimQueue::instance()->jobs().contains(sim))  return 0;
+  return sim;
+}
+
+// ---------------------------------------------------------------------
+void SimQueueDialog::slotUpdate()
+{
+  SimQueue *Queue = SimQueue::instance();
+  SimMessage *selected = currentJob();
+
+  JobList->blockSignals(true);
+  JobList->clear();
+  foreach(SimMessage *sim, Queue->jobs()) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(JobList);
+    item->setText(0, QFileInfo(sim->DocName).fileName());
+    item->setText(1, QFileInfo(sim->DataSet).fileName());
+    item->setText(2, Queue->isRunning(sim) ? tr("running") : tr("waiting"));
+    item->setData(0, Qt::UserRole, qVariantFromValue((void*)sim));
+    if(sim == selected) {
+      JobList->setCurrentItem(item);
+      item->setSelected(true);
+    }
+  }
+  JobList->blockSignals(false);
+
+  setWindowTitle(tr("Qucs Simulation Queue") + " (" +
+                 tr("%1 of %2 workers busy").arg(Queue->running())
+                                            .arg(SimQueue::maxJobs()) + ")");
+  slotSelectionChanged();
+}
+
+// ---------------------------------------------------------------------
+void SimQueueDialog::slotSelectionChanged()
+{
+  bool selected = (currentJob() != 0);
+  ButtShow->setEnabled(selected);
+  ButtAbort->setEnabled(selected);
+}
+
+// ---------------------------------------------------------------------
+void SimQueueDialog::slotAbort()
+{
+  SimMessage *sim = currentJob();
+  if(sim)
+    sim->reject();   // aborts the simulation, see SimMessage::AbortSim()
+}
+
+// ---------------------------------------------------------------------
+void SimQueueDialog::slotShow()
+{
+  SimMessage *sim = currentJob();
+  if(!sim)  return;
+  sim->show();
+  sim->raise();
+  sim->activateWindow();
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,93 @@
+/*
+ * simqueue.h - schedule simulations on several worker processes
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SIMQUEUE_H_
+#define SIMQUEUE_H_ value
+
+#include <QDialog>
+#include <QDir>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class SimMessage;
+class QTreeWidget;
+class QPushButton;
+
+/*!
+ * runs the simulator processes of SimMessage dialogs, at most maxJobs()
+ * at a time. every job gets a private work directory, so several
+ * schematics can be simulated at once. jobs writing the same dataset
+ * never run at the same time, the later one waits in the queue.
+ * all functions must be called from the GUI thread.
+ */
+class SimQueue : public QObject {
+Q_OBJECT
+public:
+  static SimQueue* instance();
+
+  static int maxJobs();
+  static bool createWorkDir(QDir&);
+  static void removeWorkDir(const QDir&);
+
+  void enqueue(SimMessage*);
+  void remove(SimMessage*);
+  bool isWaiting(SimMessage *sim) const { return Waiting.contains(sim); }
+  bool isRunning(SimMessage *sim) const { return Running.contains(sim); }
+  int running() const { return Running.size(); }
+  QList<SimMessage*> jobs() const { return Running + Waiting; }
+
+signals:
+  void changed();
+
+private slots:
+  void schedule();
+
+private:
+  SimQueue();
+  bool canStart(SimMessage*) const;
+
+  QList<SimMessage*> Waiting, Running;
+};
+
+/*!
+ * lists the running and waiting simulations, lets the user abort them.
+ */
+class SimQueueDialog : public QDialog {
+Q_OBJECT
+public:
+  SimQueueDialog(QWidget *parent=0);
+
+private slots:
+  void slotUpdate();
+  void slotSelectionChanged();
+  void slotAbort();
+  void slotShow();
+
+private:
+  SimMessage* currentJob();
+
+  QTreeWidget *JobList;
+  QPushButton *ButtShow, *ButtAbort;
+};
+
+#endif
@@ -19,7 +19,7 @@
 #include "qucs.h"
 
 #include <QGridLayout>
-#include "../diagrams/graph.h"
+#include "../diagrams/datasetcache.h"
 #include "misc.h"
 
 #include <QLabel>
@@ -72,14 +72,14 @@ SweepDialog::SweepDialog(Schematic *Doc_)
 
   Doc = Doc_;
 
-  pGraph = setBiasPoints();
+  setBiasPoints();
   // if simulation has no sweeps, terminate dialog before showing it
-  if(!pGraph->numAxes()) {
+  if(Axes.isEmpty()) {
     reject();
     return;
   }
-  if(pGraph->numAxes() <= 1)
-    if(pGraph->axis(0)->count <= 1) {
+  if(Axes.count() <= 1)
+    if(Axes.first().count() <= 1) {
       reject();
       return;
     }
@@ -88,65 +88,49 @@ SweepDialog::SweepDialog(Schematic *Doc_)
   setWindowTitle(tr("Bias Points"));
 
   // ...........................................................
-  QGridLayout *all = new QGridLayout(this);//, pGraph->cPointsX.count()+2,2,3,3);
+  QGridLayout *all = new QGridLayout(this);
   all->setMargin(5);
   all->setSpacing(5);
   all->setColumnStretch(1,5);
 
-  DataX const *pD;
   mySpinBox *Box;
-  
-  for(unsigned ii=0; (pD=pGraph->axis(ii)); ++ii) {
-    all->addWidget(new QLabel(pD->Var, this), 0, 0);
-    //cout<<"count: "<<pD->count-1<<", points: "<<*pD->Points<<endl;
-    //works only for linear:
-    /*double Min = pD->Points[0];
-    double Max = pD->Points[pD->count-1];
-    double Step = (Max-Min)/(pD->count);
-    cout<<"Min: "<<Min<<", Max: "<<Max<<", Step: "<<Step<<endl;
-    Box = new mySpinBox(Min, Max, Step, pD->Points, this);*/
-    Box = new mySpinBox(0, pD->count-1, 1, pD->Points, this);
-    Box->setValue(0);  
-    all->addWidget(Box, 0, 1);
+
+  for(int ii=0; ii<Axes.count(); ++ii) {
+    all->addWidget(new QLabel(AxisNames.at(ii), this), ii, 0);
+    Box = new mySpinBox(0, Axes[ii].count()-1, 1, Axes[ii].data(), this);
+    Box->setValue(0);
+    all->addWidget(Box, ii, 1);
     connect(Box, SIGNAL(valueChanged(int)), SLOT(slotNewValue(int)));
     BoxList.append(Box);
   }
 
   // ...........................................................
-  all->setRowStretch(0,5);
+  all->setRowStretch(Axes.count()-1,5);
   QPushButton *ButtClose = new QPushButton(tr("Close"), this);
-  all->addWidget(ButtClose, 1, 0, 1, 5);
+  all->addWidget(ButtClose, Axes.count(), 0, 1, 5);
   connect(ButtClose, SIGNAL(clicked()), SLOT(accept()));
   show();
 }
 
 SweepDialog::~SweepDialog()
 {
-  delete pGraph;
-
-  while(!ValueList.isEmpty()) {
-    delete ValueList.takeFirst();
-  }
 }
 
 // ---------------------------------------------------------------
 void SweepDialog::slotNewValue(int)
 {
-  DataX const*pD = pGraph->axis(0);
-
   int Factor = 1, Index = 0;
-  QList<mySpinBox *>::const_iterator it;
-  for(it = BoxList.constBegin(); it != BoxList.constEnd(); it++) {
-    Index  += (*it)->value() * Factor;
-    Factor *= pD->count;
+  for(int ii=0; ii<BoxList.count(); ++ii) {
+    Index  += BoxList.at(ii)->value() * Factor;
+    Factor *= Axes.at(ii).count();
   }
   Index *= 2;  // because of complex values
 
   QList<Node *>::iterator node_it;
-  QList<double *>::const_iterator value_it = ValueList.begin();
+  QList<QVector<double> >::const_iterator value_it = ValueList.constBegin();
   for(node_it = NodeList.begin(); node_it != NodeList.end(); node_it++) {
     qDebug() << "SweepDialog::slotNewValue:(*node_it)->Name:" << (*node_it)->Name;
-    (*node_it)->Name = misc::num2str(*((*value_it)+Index));
+    (*node_it)->Name = misc::num2str(value_it->at(Index));
     (*node_it)->Name += ((*node_it)->x1 & 0x10)? "A" : "V";
     value_it++;
   }
@@ -155,7 +139,7 @@ void SweepDialog::slotNewValue(int)
 }
 
 // ---------------------------------------------------
-Graph* SweepDialog::setBiasPoints()
+void SweepDialog::setBiasPoints()
 {
   // When this function is entered, a simulation was performed.
   // Thus, the node names are still in "node->Name".
@@ -163,20 +147,22 @@ Graph* SweepDialog::setBiasPoints()
   qDebug() << "SweepDialog::setBiasPoints()";
 
   bool hasNoComp;
-  Graph *pg = new Graph(NULL, ""); // HACK!
   QFileInfo Info(Doc->DocName);
   QString DataSet = Info.path() + QDir::separator() + Doc->DataSet;
 
   Node *pn;
   Element *pe;
 
-  // Note 1:
-  // Invalidate it so that "Graph::loadDatFile()" does not check for the previously loaded time.
-  // This is a current hack as "Graph::loadDatFile()" does not support multi-node data loading
-  // from the simulation results without refreshing (changing) or invalidating the timestamp.
+  // First decide which nodes get a text and which variable it shows,
+  // then load all these variables from the dataset in a single pass.
+  // Until then a labelled node keeps the variable name as its text.
+  QList<Node *> Labelled;
+  QStringList Vars;
 
   NodeList.clear();
   ValueList.clear();
+  AxisNames.clear();
+  Axes.clear();
 
   // create DC voltage for all nodes
   for(pn = Doc->Nodes->first(); pn != 0; pn = Doc->Nodes->next()) {
@@ -208,16 +194,8 @@ Graph* SweepDialog::setBiasPoints()
       }
     }
 
-    pg->Var = pn->Name + ".V";
-    pg->lastLoaded = QDateTime(); // Note 1 at the start of this function
-    if(pg->loadDatFile(DataSet) == 2) {
-      pn->Name = misc::num2str(*(pg->cPointsY)) + "V";
-      NodeList.append(pn);             // remember node ...
-      ValueList.append(pg->cPointsY);  // ... and all of its values
-      pg->cPointsY = 0;   // do not delete it next time !
-    }
-    else
-      pn->Name = "0V";
+    Labelled.append(pn);
+    Vars.append(pn->Name + ".V");
 
 
     for(pe = pn->Connections.first(); pe!=0; pe = pn->Connections.next())
@@ -238,16 +216,9 @@ Graph* SweepDialog::setBiasPoints()
         pn = pc->Ports.at(1)->Connection;
 
       pn->x1 = 0x10;   // mark current
-      pg->Var = pc->name() + ".I";
-      pg->lastLoaded = QDateTime(); // Note 1 at the start of this function
-      if(pg->loadDatFile(DataSet) == 2) {
-        pn->Name = misc::num2str(*(pg->cPointsY)) + "A";
-        NodeList.append(pn);             // remember node ...
-        ValueList.append(pg->cPointsY);  // ... and all of its values
-        pg->cPointsY = 0;   // do not delete it next time !
-      }
-      else
-        pn->Name = "0A";
+      pn->Name = pc->name() + ".I";
+      Labelled.append(pn);
+      Vars.append(pn->Name);
 
       for(pe = pn->Connections.first(); pe!=0; pe = pn->Connections.next())
         if(pe->Type == isWire) {
@@ -259,7 +230,51 @@ Graph* SweepDialog::setBiasPoints()
     }
 
 
-  Doc->showBias = 1;
+  QHash<QString, CachedDataSet::Column> Columns;
+  DataSetPtr Data = DataSetCache::get(DataSet);
+  if(Data)
+    Columns = Data->columns(Vars);
+
+  for(int i=0; i<Labelled.count(); i++) {
+    pn = Labelled.at(i);
+    if(pn->Name.isEmpty())  continue;  // text removed by a neighbour
+    QString Unit = Vars.at(i).endsWith(".I") ? "A" : "V";
+
+    QHash<QString, CachedDataSet::Column>::const_iterator it;
+    it = Columns.constFind(Vars.at(i));
+    if(it == Columns.constEnd() || it->values.isEmpty()) {
+      pn->Name = "0" + Unit;
+      continue;
+    }
 
-  return pg;
+    CachedDataSet::Column const& c = it.value();
+    if(Axes.isEmpty()) {  // the sweep, taken from the first variable
+      if(c.isIndep) {
+        AxisNames.append("number");
+        QVector<double> Numbers(c.values.count());
+        for(int z=0; z<Numbers.count(); z++)  Numbers[z] = double(z+1);
+        Axes.append(Numbers);
+      }
+      else
+        foreach(QString Dep, c.dependencies.split(' ', QString::SkipEmptyParts)) {
+          AxisNames.append(Dep);
+          Axes.append(Columns.value(Dep).values);
+        }
+    }
+
+    QVector<double> Values = c.values;
+    if(c.isIndep) {  // real values only, make them pairs as for dep
+      Values.resize(2*c.values.count());
+      for(int z=c.values.count()-1; z>=0; z--) {
+        Values[2*z]   = c.values.at(z);
+        Values[2*z+1] = 0.0;
+      }
+    }
+    pn->Name = misc::num2str(Values.first()) + Unit;
+    NodeList.append(pn);       // remember node ...
+    ValueList.append(Values);  // ... and all of its values
+  }
+
+
+  Doc->showBias = 1;
 }
@@ -21,13 +21,14 @@
 #include <QDialog>
 #include <QRegExp>
 #include <QList>
+#include <QStringList>
+#include <QVector>
 
 #include <QSpinBox>
 #include <QGridLayout>
 
 #include "node.h"
 
-class Graph;
 class Schematic;
 class QGridLayout;
 
@@ -55,15 +56,16 @@ private slots:
   void slotNewValue(int);
 
 private:
-  Graph* setBiasPoints();
+  void setBiasPoints();
 
   QGridLayout *all;   // the mother of all widgets
   QList<mySpinBox *> BoxList;
 
-  Graph *pGraph;
   Schematic *Doc;
+  QStringList AxisNames;            // the swept variables ...
+  QList<QVector<double> > Axes;     // ... and their values
   QList<Node *> NodeList;
-  QList<double *> ValueList;
+  QList<QVector<double> > ValueList; // real/imaginary pairs per node
 };
 
 #endif
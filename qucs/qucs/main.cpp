@@ -39,6 +39,8 @@
 #include <QRegExp>
 #include <QtSvg>
 #include <QDebug>
+#include <QThread>
+#include <QTime>
 
 #include "qucs.h"
 #include "node.h"
@@ -48,6 +50,8 @@
 #include "schematic.h"
 #include "module.h"
 #include "misc.h"
+#include "sweepsplitter.h"
+#include "batch.h"
 
 #include "components/components.h"
 
@@ -113,8 +117,9 @@ Schematic *openSchematic(QString schematic)
     return NULL;
   }
 
-  // populate Modules list
-  Module::registerModules ();
+  // populate Modules list, once for all schematics of a batch
+  if(Module::Modules.isEmpty())
+    Module::registerModules ();
 
   // new schematic from file
   Schematic *sch = new Schematic(0, schematic);
@@ -138,12 +143,12 @@ int doNetlist(QString schematic, QString netlist)
   qDebug() << "*** try to write netlist  :" << netlist;
 
   // QString to *char
-  QByteArray ba = schematic.toLatin1();
+  QByteArray ba = netlist.toLatin1();
   const char *c_net = ba.data();
 
   QStringList Collect;
 
-  QPlainTextEdit *ErrText = new QPlainTextEdit();  //dummy
+  QPlainTextEdit ErrText;  //dummy
   QFile NetlistFile;
   QTextStream   Stream;
 
@@ -152,17 +157,19 @@ int doNetlist(QString schematic, QString netlist)
   NetlistFile.setFileName(netlist);
   if(!NetlistFile.open(QIODevice::WriteOnly)) {
     fprintf(stderr, "Error: Could not load netlist %s\n", c_net);
+    delete sch;
     return -1;
   }
 
   Stream.setDevice(&NetlistFile);
-  int SimPorts = sch->prepareNetlist(Stream, Collect, ErrText);
+  int SimPorts = sch->prepareNetlist(Stream, Collect, &ErrText);
 
   if(SimPorts < -5) {
     NetlistFile.close();
     fprintf(stderr, "Error: Could not prepare netlist %s\n", c_net);
     /// \todo better handling for error/warnings
-    qCritical() << ErrText->toPlainText();
+    qCritical() << ErrText.toPlainText();
+    delete sch;
     return 1;
   }
 
@@ -188,6 +195,40 @@ int doNetlist(QString schematic, QString netlist)
   return 0;
 }
 
+/*!
+ * split the outermost parameter sweep of a netlist written by doNetlist()
+ * into the given number of slice netlists, to be simulated separately.
+ */
+int doSplitSweep(QString netlist, int slices)
+{
+  QStringList Netlists;
+  QString Var;
+  int n = SweepSplitter::split(netlist, slices, Netlists, Var);
+  if(n < 2) {
+    fprintf(stderr, "Warning: parameter sweep of %s cannot be split\n",
+            netlist.toLocal8Bit().data());
+    return 0;
+  }
+
+  fprintf(stdout, "sweep of %s split into:\n", Var.toLocal8Bit().data());
+  foreach(QString Name, Netlists)
+    fprintf(stdout, "  %s\n", Name.toLocal8Bit().data());
+  return 0;
+}
+
+/*!
+ * merge the datasets of the slices of a parameter sweep, in sweep order.
+ */
+int doMergeSweep(QStringList datasets, QString outfile)
+{
+  QString Error;
+  if(!SweepSplitter::merge(datasets, outfile, QString(), Error)) {
+    fprintf(stderr, "Error: %s\n", Error.toLocal8Bit().data());
+    return 1;
+  }
+  return 0;
+}
+
 int doPrint(QString schematic, QString printFile,
     QString page, int dpi, QString color, QString orientation)
 {
@@ -211,13 +252,88 @@ int doPrint(QString schematic, QString printFile,
     PrinterWriter *Printer = new PrinterWriter();
     Printer->setFitToPage(true);
     Printer->noGuiPrint(sch, printFile, page, dpi, color, orientation);
+    delete Printer;
   } else {
     ImageWriter *Printer = new ImageWriter("");
     Printer->noGuiPrint(sch, printFile, color);
+    delete Printer;
   }
+  delete sch;
   return 0;
 }
 
+// netlist or print one file of a batch, report how it went
+static bool doBatchJob(const BatchJob& Job, bool netlist,
+    QString page, int dpi, QString color, QString orientation)
+{
+  QTime Timer;
+  Timer.start();
+  int result;
+  if (netlist)
+    result = doNetlist(Job.Input, Job.Output);
+  else
+    result = doPrint(Job.Input, Job.Output, page, dpi, color, orientation);
+
+  fputs(Batch::statusLine(result == 0, Timer.elapsed(), Job).toLocal8Bit().data(),
+        stdout);
+  fflush(stdout);
+  return result == 0;
+}
+
+/*!
+ * netlist or print the files of a manifest (see Batch), on the given
+ * number of worker processes (0 = one per processor). the manifest "-"
+ * is read from standard input line by line, as done by the workers.
+ */
+int doBatch(QString manifest, bool netlist, int workers,
+    QString page, int dpi, QString color, QString orientation)
+{
+  QString Error;
+  QList<BatchJob> Jobs;
+  int Failed = 0;
+
+  if (manifest == "-") {
+    char Line[4096];
+    while (fgets(Line, sizeof(Line), stdin)) {
+      Jobs.clear();
+      if (!Batch::parseLine(QString::fromLocal8Bit(Line), Jobs, Error)) {
+        fprintf(stderr, "Error: %s\n", Error.toLocal8Bit().data());
+        return 1;
+      }
+      foreach(BatchJob const& Job, Jobs)
+        if (!doBatchJob(Job, netlist, page, dpi, color, orientation))
+          Failed++;
+    }
+    return Failed > 0 ? 1 : 0;
+  }
+
+  if (!Batch::readManifest(manifest, Jobs, Error)) {
+    fprintf(stderr, "Error: %s\n", Error.toLocal8Bit().data());
+    return -1;
+  }
+
+  QTime Timer;
+  Timer.start();
+  if (workers < 1)
+    workers = QThread::idealThreadCount();
+  if (workers < 2 || Jobs.size() < 2) {
+    foreach(BatchJob const& Job, Jobs)
+      if (!doBatchJob(Job, netlist, page, dpi, color, orientation))
+        Failed++;
+  } else {
+    QStringList Arguments;
+    Arguments << (netlist ? "-n" : "-p") << "--page" << page
+              << "--dpi" << QString::number(dpi) << "--color" << color
+              << "--orin" << orientation << "--batch" << "-";
+    BatchRunner Runner(QCoreApplication::applicationFilePath(), Arguments);
+    Failed = Runner.run(Jobs, workers);
+  }
+
+  fprintf(stdout, "%d of %d files failed, %d ms\n",
+          Failed, Jobs.size(), Timer.elapsed());
+  return Failed > 0 ? 1 : 0;
+}
+
 /*!
  * \brief createIcons Create component icons (png) from command line.
  */
@@ -516,6 +632,8 @@ int main(int argc, char *argv[])
   QucsSettings.maxUndo = 20;
   QucsSettings.NodeWiring = 0;
   QucsSettings.Editor = "qucs";
+  QucsSettings.SimJobs = 0;
+  QucsSettings.SweepSlices = 1;
 
   // initially center the application
   QApplication a(argc, argv);
@@ -677,9 +795,13 @@ int main(int argc, char *argv[])
 
   QString inputfile;
   QString outputfile;
+  QString batchfile;
+  QStringList mergefiles;
 
   bool netlist_flag = false;
   bool print_flag = false;
+  int sweep_slices = 1;
+  int jobs = 0;
   QString page = "A4";
   int dpi = 96;
   QString color = "RGB";
@@ -690,13 +812,23 @@ int main(int argc, char *argv[])
     if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
       fprintf(stdout,
   "Usage: %s [-hv] \n"
-  "       qucs -n -i FILENAME -o FILENAME\n"
-  "       qucs -p -i FILENAME -o FILENAME.[pdf|png|svg|eps] \n\n"
+  "       qucs -n -i FILENAME -o FILENAME [--sweep-slices NUMBER]\n"
+  "       qucs --merge FILENAME [--merge FILENAME ...] -o FILENAME\n"
+  "       qucs -p -i FILENAME -o FILENAME.[pdf|png|svg|eps] \n"
+  "       qucs [-n|-p] --batch FILENAME [--jobs NUMBER]\n\n"
   "  -h, --help     display this help and exit\n"
   "  -v, --version  display version information and exit\n"
   "  -n, --netlist  convert Qucs schematic into netlist\n"
   "  -p, --print    print Qucs schematic to file (eps needs inkscape)\n"
   "  -q, --quit     exit\n"
+  "    --sweep-slices NUMBER        also write the outermost parameter sweep\n"
+  "                                 split into NUMBER netlists FILENAME_1...\n"
+  "    --merge FILENAME             merge datasets of sweep slices, in order\n"
+  "    --batch FILENAME             netlist or print all files listed in\n"
+  "                                 FILENAME, lines of INPUT OUTPUT, where\n"
+  "                                 INPUT may contain one '*' (- = stdin)\n"
+  "    --jobs NUMBER                files processed at a time by --batch\n"
+  "                                 (default one per processor)\n"
   "    --page [A4|A3|B4|B5]         set print page size (default A4)\n"
   "    --dpi NUMBER                 set dpi value (default 96)\n"
   "    --color [RGB|RGB]            set color mode (default RGB)\n"
@@ -726,6 +858,18 @@ int main(int argc, char *argv[])
     else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--print")) {
       print_flag = true;
     }
+    else if (!strcmp(argv[i], "--sweep-slices")) {
+      sweep_slices = QString(argv[++i]).toInt();
+    }
+    else if (!strcmp(argv[i], "--merge")) {
+      mergefiles.append(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "--batch")) {
+      batchfile = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--jobs")) {
+      jobs = QString(argv[++i]).toInt();
+    }
     else if (!strcmp(argv[i], "--page")) {
       page = argv[++i];
     }
@@ -769,9 +913,24 @@ int main(int argc, char *argv[])
   }
 
   // check operation and its required arguments
+  if (!mergefiles.isEmpty()) {
+    if (outputfile.isEmpty()) {
+      fprintf(stderr, "Error: Expected output file.\n");
+      return -1;
+    }
+    return doMergeSweep(mergefiles, outputfile);
+  }
+
   if (netlist_flag and print_flag) {
     fprintf(stderr, "Error: --print and --netlist cannot be used together\n");
     return -1;
+  } else if (!batchfile.isEmpty()) {
+    if (!(netlist_flag or print_flag)) {
+      fprintf(stderr, "Error: --batch needs --netlist or --print\n");
+      return -1;
+    }
+    return doBatch(batchfile, netlist_flag, jobs,
+        page, dpi, color, orientation);
   } else if (netlist_flag or print_flag) {
     if (inputfile.isEmpty()) {
       fprintf(stderr, "Error: Expected input file.\n");
@@ -783,7 +942,10 @@ int main(int argc, char *argv[])
     }
     // create netlist from schematic
     if (netlist_flag) {
-      return doNetlist(inputfile, outputfile);
+      int result = doNetlist(inputfile, outputfile);
+      if ((result == 0) && (sweep_slices > 1))
+        result = doSplitSweep(outputfile, sweep_slices);
+      return result;
     } else if (print_flag) {
       return doPrint(inputfile, outputfile,
           page, dpi, color, orientation);
@@ -33,6 +33,8 @@
 #include <QRegExp>
 #include <QFileInfo>
 #include <QDir>
+#include <QFile>
+#include <QTextStream>
 
 // #########################################################################
 QString misc::complexRect(double real, double imag, int Precision)
@@ -438,6 +440,43 @@ bool misc::checkVersion(QString& Line)
   return true;
 }
 
+// #########################################################################
+// Copies the file "FileName" unchanged into "stream", e.g. a model file
+// into a netlist. If the stream writes to a device, the text buffered so
+// far is flushed and the file goes to the device as it is, mapped into
+// memory if possible, else block by block. Otherwise the file is read in
+// blocks and handed to the stream as Latin-1 text.
+bool misc::streamFile(QTextStream& stream, const QString& FileName)
+{
+  QFile file(FileName);
+  if(!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QIODevice *dev = stream.device();
+  if(dev) {
+    stream.flush();
+    qint64 size = file.size();
+    uchar *p = size > 0 ? file.map(0, size) : 0;
+    if(p) {
+      bool ok = (dev->write((const char*)p, size) == size);
+      file.unmap(p);
+      return ok;
+    }
+  }
+
+  char buf[16384];
+  qint64 n;
+  while((n = file.read(buf, sizeof(buf))) > 0) {
+    if(dev) {
+      if(dev->write(buf, n) != n)
+        return false;
+    }
+    else
+      stream << QString::fromLatin1(buf, n);
+  }
+  return n == 0;
+}
+
 // a small class to handle the application version string
 //   loosely modeled after the standard Semantic Versioning...
 VersionTriplet::VersionTriplet(const QString& version) {
@@ -26,6 +26,7 @@
 #include <QDebug>
 
 class QString;
+class QTextStream;
 
 namespace misc {
   QString complexRect(double, double, int Precision=3);
@@ -46,6 +47,7 @@ namespace misc {
   bool    Verilog_Delay(QString&, const QString&);
   QString Verilog_Param(const QString);
   bool    checkVersion(QString&);
+  bool    streamFile(QTextStream&, const QString&);
 
 
   inline const QColor getWidgetForegroundColor(const QWidget *q)
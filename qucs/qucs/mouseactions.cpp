@@ -1931,7 +1931,7 @@ void MouseActions::editElement(Schematic *Doc, QMouseEvent *Event)
            Doc->Components->append(c);
          }
 
-         Doc->setChanged(true, true);
+         Doc->setChanged(true, true, 'p'); // the dialogs invalidated "c"
          c->entireBounds(x1,y1,x2,y2, Doc->textCorr());
          Doc->enlargeView(x1,y1,x2,y2);
          break;
@@ -0,0 +1,99 @@
+/*
+ * nodeindex.cpp - finding the nodes of a schematic by position
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nodeindex.h"
+#include "node.h"
+
+void NodeIndex::clear()
+{
+  Map.clear();
+  Built = false;
+  Count = 0;
+}
+
+// ---------------------------------------------------------------------
+// indexes all nodes of the list, in the order of the list.
+void NodeIndex::build(Q3PtrList<Node> *Nodes)
+{
+  clear();
+  Built = true;
+  Map.reserve(Nodes->count());
+  Q3PtrListIterator<Node> it(*Nodes);
+  for(Node *pn; (pn = it.current()) != 0; ++it)
+    insert(pn);
+}
+
+// ---------------------------------------------------------------------
+// a node appended to the list. does nothing before build().
+void NodeIndex::insert(Node *pn)
+{
+  if(!Built)  return;
+  Entry e;
+  e.pn = pn;
+  e.Order = Count++;
+  Map.insert(Position(pn->cx, pn->cy), e);
+}
+
+// ---------------------------------------------------------------------
+// a node about to be removed from the list. unknown nodes are ignored.
+void NodeIndex::remove(Node *pn)
+{
+  Position pos(pn->cx, pn->cy);
+  QMultiHash<Position, Entry>::iterator it = Map.find(pos);
+  for( ; (it != Map.end()) && (it.key() == pos); ++it)
+    if(it.value().pn == pn) {
+      Map.erase(it);
+      return;
+    }
+}
+
+// ---------------------------------------------------------------------
+// the first node at x/y, 0 if there is none.
+Node* NodeIndex::find(int x, int y) const
+{
+  Position pos(x, y);
+  const Entry *First = 0;
+  QMultiHash<Position, Entry>::const_iterator it = Map.find(pos);
+  for( ; (it != Map.constEnd()) && (it.key() == pos); ++it)
+    if(!First || (it.value().Order < First->Order))
+      First = &it.value();
+  return First ? First->pn : 0;
+}
+
+// ---------------------------------------------------------------------
+// the first node hit by a click at x/y (see Node::getSelected()), 0 if
+// there is none.
+Node* NodeIndex::selected(int x, int y) const
+{
+  const Entry *First = 0;
+  for(int dx = -5; dx <= 5; dx++)
+    for(int dy = -5; dy <= 5; dy++) {
+      Position pos(x+dx, y+dy);
+      QMultiHash<Position, Entry>::const_iterator it = Map.find(pos);
+      for( ; (it != Map.constEnd()) && (it.key() == pos); ++it)
+        if(!First || (it.value().Order < First->Order))
+          First = &it.value();
+    }
+  return First ? First->pn : 0;
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,66 @@
+/*
+ * nodeindex.h - finding the nodes of a schematic by position
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NODEINDEX_H_
+#define NODEINDEX_H_ value
+
+#include <QHash>
+#include <QPair>
+
+#include <Q3PtrList>
+
+class Node;
+
+/*!
+ * the positions of the nodes of a list, so that a port does not need to
+ * search the whole list for the node it connects to. nodes are expected
+ * to be appended to the list only and to keep their position while they
+ * are listed. if several nodes share a position, the first one in the
+ * list is found, as by a walk through the list.
+ */
+class NodeIndex {
+public:
+  NodeIndex() : Built(false), Count(0) {}
+
+  void clear();
+  bool isBuilt() const { return Built; }
+  void build(Q3PtrList<Node>*);
+  void insert(Node*);
+  void remove(Node*);
+  int  size() const { return Map.size(); }
+
+  Node* find(int x, int y) const;
+  Node* selected(int x, int y) const;
+
+private:
+  struct Entry {
+    Node *pn;
+    int Order;   // position in the list, growing with every insert()
+  };
+  typedef QPair<int, int> Position;
+
+  QMultiHash<Position, Entry> Map;
+  bool Built;
+  int  Count;
+};
+
+#endif
@@ -29,18 +29,62 @@
 #include <QDir>
 #include <QStandardItemModel>
 #include <QFileSystemWatcher>
+#include <QTimer>
 #include <QDebug>
 
+#include <limits.h>
+
+namespace {
+
+// what the view shows of a file, read again only if the file is modified
+struct FileDigest {
+  FileDigest() : Size(-1), Ports(INT_MIN) {}
+
+  QDateTime Modified;
+  qint64 Size;
+  int Ports;             // see Schematic::testFile(), INT_MIN if not read yet
+  QString Description;   // null if not read yet
+};
+
+QHash<QString, FileDigest> FileDigests;
+
+FileDigest& digest(const QFileInfo& Info)
+{
+  FileDigest& d = FileDigests[Info.absoluteFilePath()];
+  if((d.Modified != Info.lastModified()) || (d.Size != Info.size())) {
+    d = FileDigest();
+    d.Modified = Info.lastModified();
+    d.Size = Info.size();
+  }
+  return d;
+}
+
+// drops the digest of a file no longer shown
+void forget(const QDir& Dir, const QString& fileName)
+{
+  FileDigests.remove(QFileInfo(Dir, fileName).absoluteFilePath());
+}
+
+}
+
 ProjectView::ProjectView(QWidget *parent)
   : QTreeView(parent)
 {
   m_projPath = QString();
   m_projName = QString();
   m_valid = false;
+  m_described = false;
   m_model = new QStandardItemModel(8, 2, this);
   watcher = new QFileSystemWatcher(this);
   connect(watcher, SIGNAL(directoryChanged(const QString&)), SLOT(dirChanged(const QString&)));
 
+  // a simulation or a save changes the directory several times in a row,
+  // the view is refreshed once after them
+  m_refreshTimer = new QTimer(this);
+  m_refreshTimer->setSingleShot(true);
+  m_refreshTimer->setInterval(200);
+  connect(m_refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+
   init();
 
   this->setModel(m_model);
@@ -63,6 +107,9 @@ ProjectView::setProjPath(const QString &path)
     if (!m_projPath.isEmpty()) {
       watcher->removePath(m_projPath); // stop watching the previous directry
     }
+    if (path != m_projPath) {
+      clearEntries(); // the files of the previous project
+    }
     m_projPath = path; // full path
     watcher->addPath(path); // start watching the current directory
     m_projName = QDir(m_projPath).dirName(); // only project directory name
@@ -95,85 +142,171 @@ ProjectView::init()
   APPEND_ROW(m_model, tr("Octave")       );
   APPEND_ROW(m_model, tr("Schematics")   );
   APPEND_ROW(m_model, tr("Others")       );
+  m_entries.clear();
 
   if (!m_valid) {
     return;
   }
 }
 
-// refresh the view using the current projectPath
+// refresh the view using the current projectPath. only the files that
+// were added, removed or modified since the last refresh are worked on.
 void
 ProjectView::refresh()
 {
-  // put all files into "Content"-ListView
+  m_refreshTimer->stop();
+
   QDir workPath(m_projPath);
-  QStringList files = workPath.entryList(QStringList() << "*", QDir::Files, QDir::Name);
-  QStringList::iterator it;
-  QString extName, fileName;
-  QList<QStandardItem *> columnData;
+  QFileInfoList files = workPath.entryInfoList(QStringList() << "*", QDir::Files, QDir::Name);
 
   // update project name in header as it may have changed
   QStringList header;
   header << tr("Content of %1").arg(m_projName) << tr("Note");
   m_model->setHorizontalHeaderLabels(header);
 
+  if (m_described != QucsSettings.ShowDescriptionProjectTree) {
+    clearEntries();
+    m_described = QucsSettings.ShowDescriptionProjectTree;
+  }
+
+  QHash<QString, Entry> listed;
+  foreach (const QFileInfo &info, files) {
+    QString fileName = info.fileName();
+    Entry e = m_entries.take(fileName);
+    if (!e.Modified.isValid() || (e.Modified != info.lastModified())
+                              || (e.Size != info.size())) {
+      removeEntry(fileName, e.Category);
+      e.Modified = info.lastModified();
+      e.Size = info.size();
+      e.Category = addEntry(info);
+    }
+    listed.insert(fileName, e);
+  }
+
+  // the files left were deleted
+  QHash<QString, Entry>::const_iterator it;
+  for (it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+    removeEntry(it.key(), it.value().Category);
+    forget(workPath, it.key());
+  }
+  m_entries = listed;
+
+  resizeColumnToContents(0);
+}
+
+// removes all files from the view, and their digests (the project may
+// be left)
+void
+ProjectView::clearEntries()
+{
   for (int i=0; i<m_model->rowCount(); i++) {
     // delete_childrens
     m_model->item(i, 0)->removeRows(0, m_model->item(i, 0)->rowCount());
   }
+  QDir workPath(m_projPath);
+  foreach (const QString &fileName, m_entries.keys()) {
+    forget(workPath, fileName);
+  }
+  m_entries.clear();
+}
 
-#define APPEND_CHILD(category, data) \
-  m_model->item(category, 0)->appendRow(data);
-
-  for(it = files.begin(); it != files.end(); ++it) {
-    fileName = (*it).toAscii();
-    extName = QFileInfo(workPath.filePath(fileName)).suffix();
+// puts a file into its category, sorted by name like the directory
+// listing. returns the category, -1 if the file is not shown.
+int
+ProjectView::addEntry(const QFileInfo &info)
+{
+  QString fileName = info.fileName();
+  QString extName = info.suffix();
+  FileDigest &d = digest(info);
 
-    columnData.clear();
-    QStandardItem * d = new QStandardItem(fileName);
-    if (QucsSettings.ShowDescriptionProjectTree)
-    { // In case of the ShowDescriptionProjectTree property is set, 
-      // it reads the schematic header looking for the message to be displayed
-      // and the variable which sets the visibility of the frame
-       QString description = ReadDescription(workPath.absoluteFilePath(fileName));
-       d->setToolTip(description);
+  QList<QStandardItem *> columnData;
+  QStandardItem * item = new QStandardItem(fileName);
+  if (QucsSettings.ShowDescriptionProjectTree)
+  { // In case of the ShowDescriptionProjectTree property is set, 
+    // it reads the schematic header looking for the message to be displayed
+    // and the variable which sets the visibility of the frame
+    if (d.Description.isNull()) {
+      d.Description = ReadDescription(info.absoluteFilePath());
     }
-    columnData.append(d);
+    item->setToolTip(d.Description);
+  }
+  columnData.append(item);
 
-    if(extName == "dat") {
-      APPEND_CHILD(0, columnData);
-    }
-    else if(extName == "dpl") {
-      APPEND_CHILD(1, columnData);
-    }
-    else if(extName == "v") {
-      APPEND_CHILD(2, columnData);
-    }
-    else if(extName == "va") {
-      APPEND_CHILD(3, columnData);
-    }
-    else if((extName == "vhdl") || (extName == "vhd")) {
-      APPEND_CHILD(4, columnData);
-    }
-    else if((extName == "m") || (extName == "oct")) {
-      APPEND_CHILD(5, columnData);
+  int category;
+  if(extName == "dat") {
+    category = 0;
+  }
+  else if(extName == "dpl") {
+    category = 1;
+  }
+  else if(extName == "v") {
+    category = 2;
+  }
+  else if(extName == "va") {
+    category = 3;
+  }
+  else if((extName == "vhdl") || (extName == "vhd")) {
+    category = 4;
+  }
+  else if((extName == "m") || (extName == "oct")) {
+    category = 5;
+  }
+  else if(extName == "sch") {
+    // test if it's a valid schematic file
+    if (d.Ports == INT_MIN) {
+      d.Ports = Schematic::testFile(info.absoluteFilePath());
     }
-    else if(extName == "sch") {
-      // test if it's a valid schematic file
-      int n = Schematic::testFile(workPath.filePath(fileName));
-      if(n >= 0) {
-        if(n > 0) { // is a subcircuit
-          columnData.append(new QStandardItem(QString::number(n)+tr("-port")));
-        }
-        APPEND_CHILD(6, columnData);
-      }
+    int n = d.Ports;
+    if(n < 0) {
+      delete item;
+      return -1;
     }
-    else {
-      APPEND_CHILD(7, columnData);
+    if(n > 0) { // is a subcircuit
+      columnData.append(new QStandardItem(QString::number(n)+tr("-port")));
     }
+    category = 6;
+  }
+  else {
+    category = 7;
   }
 
-  resizeColumnToContents(0);
+  QStandardItem *parent = m_model->item(category, 0);
+  bool found;
+  parent->insertRow(findRow(parent, fileName, found), columnData);
+  return category;
+}
+
+// removes a file from its category
+void
+ProjectView::removeEntry(const QString &fileName, int category)
+{
+  if (category < 0) {
+    return;
+  }
+  QStandardItem *parent = m_model->item(category, 0);
+  bool found;
+  int row = findRow(parent, fileName, found);
+  if (found) {
+    parent->removeRow(row);
+  }
+}
+
+// binary search for the row of a file in a category, or for the row to
+// insert it at
+int
+ProjectView::findRow(QStandardItem *parent, const QString &fileName, bool &found) const
+{
+  int lo = 0, hi = parent->rowCount();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (parent->child(mid, 0)->text() < fileName) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  found = (lo < parent->rowCount()) && (parent->child(lo, 0)->text() == fileName);
+  return lo;
 }
 
 QStringList
@@ -193,20 +326,27 @@ void ProjectView::dirChanged(const QString &path)
 {
   Q_UNUSED(path);
   //qDebug() << "watcher:" << path;
-  refresh();
+  m_refreshTimer->start();
 }
 
-// This function reads the text inside the <description></description> tags from the given file location
+// This function reads the text inside the <description></description> tags from the given file location.
+// Only the properties in the header of a schematic are read.
 QString ProjectView::ReadDescription(QString file)
 {
     QFile QucsDocument(file);
     if (!QucsDocument.open(QIODevice::ReadOnly)) return "";
     QTextStream in (&QucsDocument);
     QString line, description;
-    int showFrame;
+    int showFrame = 0;
     int index, index2;
     do {
         line = in.readLine();
+    } while (!line.isNull() && line.trimmed().isEmpty());
+    if (!line.trimmed().startsWith("<Qucs Schematic ")) return "";  // no schematic, no frame
+
+    do {
+        line = in.readLine();
+        if (line.trimmed() == "</Properties>") break;
         index = line.indexOf("FrameText0=");
         if (index != -1) {
             index2 = line.indexOf(">", index);
@@ -26,6 +26,8 @@
 
 #include <QTreeView>
 #include <QString>
+#include <QHash>
+#include <QDateTime>
 #include "qucs.h"
 
 #define APPEND_ROW(parent, data) \
@@ -37,6 +39,8 @@
 
 class QStandardItemModel;
 class QFileSystemWatcher;
+class QFileInfo;
+class QTimer;
 
 class ProjectView : public QTreeView
 {
@@ -50,19 +54,35 @@ public:
   //data related
   void setProjPath(const QString &);
   void init();
-  void refresh();
   QStringList exportSchematic();
 private:
+  // a file shown in the view, as it was when it was listed
+  struct Entry {
+    Entry() : Size(-1), Category(-1) {}
+
+    QDateTime Modified;
+    qint64 Size;
+    int Category;   // row in the model, -1 if the file is not shown
+  };
+
   QStandardItemModel *m_model;
   QFileSystemWatcher *watcher;
+  QTimer *m_refreshTimer;
 
   bool m_valid;
   QString m_projPath;
   QString m_projName;
+  QHash<QString, Entry> m_entries;   // by file name
+  bool m_described;  // whether the entries got a description
 
+  void clearEntries();
+  int  addEntry(const QFileInfo&);
+  void removeEntry(const QString&, int);
+  int  findRow(QStandardItem*, const QString&, bool&) const;
   QString ReadDescription(QString);
 
 public slots:
+  void refresh();
   void dirChanged(const QString&);
 };
 
@@ -55,6 +55,7 @@
 #include "components/components.h"
 #include "paintings/paintings.h"
 #include "diagrams/diagrams.h"
+#include "diagrams/datasetcache.h"
 #include "dialogs/savedialog.h"
 #include "dialogs/newprojdialog.h"
 #include "dialogs/settingsdialog.h"
@@ -71,6 +72,7 @@
 #include "printerwriter.h"
 #include "imagewriter.h"
 #include "../qucs-lib/qucslib_common.h"
+#include "../qucs-lib/qucslib_index.h"
 #include "misc.h"
 
 struct iconCompInfoStruct
@@ -392,6 +394,23 @@ void QucsApp::fillLibrariesTreeView ()
 
     QDir LibDir(QucsSettings.LibDir);
     LibFiles = LibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
+    QDir UserLibDir = QDir (QucsSettings.QucsHomeDir.canonicalPath () + "/user_lib/");
+    QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
+
+    // bring the library index up to date, in the order of qucslib:
+    // user libraries with full path, then system libraries
+    QStringList LibPaths;
+    foreach(QString s, UserLibFiles) {
+        s = UserLibDir.absoluteFilePath(s);
+        s.chop(4); // remove extension
+        LibPaths.append(s);
+    }
+    foreach(QString s, LibFiles) {
+        s.chop(4);
+        LibPaths.append(s);
+    }
+    ComponentLibraryIndex& Index = componentLibraryIndex();
+    Index.update(LibPaths);
 
     // create top level library items, base on the library names
     for(it = LibFiles.begin(); it != LibFiles.end(); it++)
@@ -399,11 +418,10 @@ void QucsApp::fillLibrariesTreeView ()
         QString libPath(*it);
         libPath.chop(4); // remove extension
 
-        ComponentLibrary parsedlibrary;
-
-        int result = parseComponentLibrary (libPath , parsedlibrary);
+        IndexedLibrary const* parsedlibrary = Index.library (libPath);
+        int result = parsedlibrary->result;
         QStringList nameAndFileName;
-        nameAndFileName.append (parsedlibrary.name);
+        nameAndFileName.append (parsedlibrary->name);
         nameAndFileName.append (QucsSettings.LibDir + *it);
 
         QTreeWidgetItem* newlibitem = new QTreeWidgetItem((QTreeWidget*)0, nameAndFileName);
@@ -423,16 +441,16 @@ void QucsApp::fillLibrariesTreeView ()
                 break;
         }
 
-        for (int i = 0; i < parsedlibrary.components.count (); i++)
+        for (int i = 0; i < parsedlibrary->components.count (); i++)
         {
             QStringList compNameAndDefinition;
 
-            compNameAndDefinition.append (parsedlibrary.components[i].name);
+            compNameAndDefinition.append (parsedlibrary->components[i].name);
 
             QString s = "<Qucs Schematic " PACKAGE_VERSION ">\n";
 
             s +=  "<Components>\n  " +
-                  parsedlibrary.components[i].modelString + "\n" +
+                  parsedlibrary->components[i].modelString + "\n" +
                   "</Components>\n";
 
             compNameAndDefinition.append (s);
@@ -454,9 +472,7 @@ void QucsApp::fillLibrariesTreeView ()
     newitem->setFont (0, sectionFont);
     topitems.append (newitem);
 
-    QDir UserLibDir = QDir (QucsSettings.QucsHomeDir.canonicalPath () + "/user_lib/");
-
-    LibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
+    LibFiles = UserLibFiles;
     int UserLibCount = LibFiles.count();
 
     if (UserLibCount > 0) // there are user libraries
@@ -468,11 +484,10 @@ void QucsApp::fillLibrariesTreeView ()
             QString libPath(UserLibDir.absoluteFilePath(*it));
             libPath.chop(4); // remove extension
 
-            ComponentLibrary parsedlibrary;
-
-            int result = parseComponentLibrary (libPath, parsedlibrary);
+            IndexedLibrary const* parsedlibrary = Index.library (libPath);
+            int result = parsedlibrary->result;
             QStringList nameAndFileName;
-            nameAndFileName.append (parsedlibrary.name);
+            nameAndFileName.append (parsedlibrary->name);
             nameAndFileName.append (UserLibDir.absolutePath() +"/"+ *it);
 
             QTreeWidgetItem* newlibitem = new QTreeWidgetItem((QTreeWidget*)0, nameAndFileName);
@@ -492,16 +507,16 @@ void QucsApp::fillLibrariesTreeView ()
                     break;
             }
 
-            for (int i = 0; i < parsedlibrary.components.count (); i++)
+            for (int i = 0; i < parsedlibrary->components.count (); i++)
             {
                 QStringList compNameAndDefinition;
 
-                compNameAndDefinition.append (parsedlibrary.components[i].name);
+                compNameAndDefinition.append (parsedlibrary->components[i].name);
 
                 QString s = "<Qucs Schematic " PACKAGE_VERSION ">\n";
 
                 s +=  "<Components>\n  " +
-                      parsedlibrary.components[i].modelString + "\n" +
+                      parsedlibrary->components[i].modelString + "\n" +
                       "</Components>\n";
 
                 compNameAndDefinition.append (s);
@@ -1050,6 +1065,7 @@ void QucsApp::slotCMenuRename()
       s += QString(".") + suffix;
     }
     QDir dir(QucsSettings.QucsWorkDir.path());
+    DataSetCache::invalidate(file);   // and its binary sidecar
     if(!dir.rename(filename, s)) {
       QMessageBox::critical(this, tr("Error"), tr("Cannot rename file: %1").arg(filename));
       return;
@@ -1077,6 +1093,7 @@ void QucsApp::slotCMenuDelete()
       tr("This will delete the file permanently! Continue ?"),
       tr("No"), tr("Yes"));
   if(No == 1) {
+    DataSetCache::invalidate(file);   // and its binary sidecar
     if(!QFile::remove(file)) {
       QMessageBox::critical(this, tr("Error"),
       tr("Cannot delete file: %1").arg(filename));
@@ -2143,8 +2160,13 @@ void QucsApp::slotSimulate()
 // Is called after the simulation process terminates.
 void QucsApp::slotAfterSimulation(int Status, SimMessage *sim)
 {
+  DataSetCache::invalidate(sim->DataSet);   // may be rewritten in a second
   if(Status != 0) return;  // errors ocurred ?
 
+  // convert once now instead of on first display
+  if(QucsSettings.BinaryDataSets)
+    DataSetCache::getBinary(sim->DataSet);
+
   if(sim->ErrText->document()->lineCount() > 1)   // were there warnings ?
     slotShowWarnings();
 
@@ -2183,7 +2205,7 @@ void QucsApp::slotAfterSimulation(int Status, SimMessage *sim)
     else
       if(w) if(!isTextDocument (sim->DocWidget))
 	// load recent simulation data (if document is still open)
-	((Schematic*)sim->DocWidget)->reloadGraphs();
+	((Schematic*)sim->DocWidget)->reloadGraphs(true);
   }
 
   if(!isTextDocument (sim->DocWidget))
@@ -2250,7 +2272,7 @@ void QucsApp::slotChangePage(QString& DocName, QString& DataDisplay)
 
   if(DocumentTab->currentWidget() == w)      // if page not ...
     if(!isTextDocument (w))
-      ((Schematic*)w)->reloadGraphs();  // ... changes, reload here !
+      ((Schematic*)w)->reloadGraphs(true);  // ... changes, reload here !
 
   TabView->setCurrentIndex(2);   // switch to "Component"-Tab
   if (Name.right(4) == ".dpl") {
@@ -2951,6 +2973,15 @@ bool loadSettings()
 
     if(settings.contains("ShowDescription")) QucsSettings.ShowDescriptionProjectTree = settings.value("ShowDescription").toBool();
 
+    if(settings.contains("BinaryDataSets")) QucsSettings.BinaryDataSets = settings.value("BinaryDataSets").toBool();
+    else QucsSettings.BinaryDataSets = false;
+
+    if(settings.contains("SimJobs")) QucsSettings.SimJobs = settings.value("SimJobs").toInt();
+    else QucsSettings.SimJobs = 0;
+
+    if(settings.contains("SweepSlices")) QucsSettings.SweepSlices = settings.value("SweepSlices").toInt();
+    else QucsSettings.SweepSlices = 1;
+
     QucsSettings.RecentDocs = settings.value("RecentDocs").toString().split("*",QString::SkipEmptyParts);
     QucsSettings.numRecentDocs = QucsSettings.RecentDocs.count();
 
@@ -3138,6 +3169,9 @@ bool saveApplSettings()
     settings.setValue("TextAntiAliasing", QucsSettings.TextAntiAliasing);
     settings.setValue("Editor", QucsSettings.Editor);
     settings.setValue("ShowDescription", QucsSettings.ShowDescriptionProjectTree);
+    settings.setValue("BinaryDataSets", QucsSettings.BinaryDataSets);
+    settings.setValue("SimJobs", QucsSettings.SimJobs);
+    settings.setValue("SweepSlices", QucsSettings.SweepSlices);
 
     // Copy the list of directory paths in which Qucs should
     // search for subcircuit schematics from qucsPathList
@@ -118,6 +118,9 @@ struct tQucsSettings {
   bool GraphAntiAliasing;
   bool TextAntiAliasing;
   bool ShowDescriptionProjectTree;
+  bool BinaryDataSets;   // map datasets through a binary sidecar file
+  int SimJobs;           // simulations run at once, 0 = one per core
+  int SweepSlices;       // split parameter sweeps, 1 = never, 0 = one per core
 };
 
 // extern because nearly everywhere used
@@ -394,7 +397,7 @@ public:
           *editRotate, *editMirror, *editMirrorY, *editPaste, *select,
           *editActivate, *wire, *editDelete, *setMarker, *onGrid, *moveText,
           *helpOnline, *callEditor, *callFilter, *callLine, *callActiveFilter,
-          *showMsg, *showNet, *alignTop, *alignBottom, *alignLeft, *alignRight,
+          *showMsg, *showNet, *simQueue, *alignTop, *alignBottom, *alignLeft, *alignRight,
           *distrHor, *distrVert, *selectAll, *callLib, *callMatch, *changeProps,
           *addToProj, *editFind, *insEntity, *selectMarker, *callPowerComb,
           *createLib, *importData, *graph2csv, *createPkg, *extractPkg,
@@ -436,6 +439,7 @@ public slots:
   void slotSelectMarker();
   void slotShowLastMsg();
   void slotShowLastNetlist();
+  void slotShowSimQueue();
   void slotCallEditor();
   void slotCallFilter();
   void slotCallActiveFilter();
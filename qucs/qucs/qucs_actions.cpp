@@ -59,6 +59,7 @@
 #include "dialogs/importdialog.h"
 #include "dialogs/packagedialog.h"
 #include "dialogs/aboutdialog.h"
+#include "dialogs/simqueue.h"
 #include "module.h"
 #include "misc.h"
 
@@ -734,6 +735,14 @@ void QucsApp::slotShowLastNetlist()
   editFile(QucsSettings.QucsHomeDir.filePath("netlist.txt"));
 }
 
+// ------------------------------------------------------------------------
+// Is called to show the list of running and waiting simulations.
+void QucsApp::slotShowSimQueue()
+{
+  SimQueueDialog *d = new SimQueueDialog(this);
+  d->show();
+}
+
 // ------------------------------------------------------------------------
 // Is called to start the text editor.
 void QucsApp::slotCallEditor()
@@ -1119,15 +1128,17 @@ void QucsApp::slotApplyCompText()
               break;  // found component with the same name ?
           if(!pc2) {
             pc->obsolete_name_override_hack( editText->text() );
-            Doc->setChanged(true, true);  // only one undo state
+            pc->invalidateNetlist();
+            Doc->setChanged(true, true, 'p');  // only one undo state
           }
         }
     }
     else if(pp) {  // property was applied
       if(pp->Value != editText->text()) {
         pp->Value = editText->text();
+        pc->invalidateNetlist();
         Doc->recreateComponent(pc);  // because of "Num" and schematic symbol
-        Doc->setChanged(true, true); // only one undo state
+        Doc->setChanged(true, true, 'p'); // only one undo state
       }
     }
 
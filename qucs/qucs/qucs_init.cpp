@@ -646,6 +646,12 @@ void QucsApp::initActions()
 	tr("Show Last Netlist\n\nShows the netlist of the last simulation"));
   connect(showNet, SIGNAL(triggered()), SLOT(slotShowLastNetlist()));
 
+  simQueue = new QAction(tr("Simulation Queue..."), this);
+  simQueue->setStatusTip(tr("Shows the running and waiting simulations"));
+  simQueue->setWhatsThis(
+	tr("Simulation Queue\n\nShows the running and waiting simulations"));
+  connect(simQueue, SIGNAL(triggered()), SLOT(slotShowSimQueue()));
+
   viewToolBar = new QAction(tr("Tool&bar"), this);
   viewToolBar->setCheckable(true);
   viewToolBar->setStatusTip(tr("Enables/disables the toolbar"));
@@ -824,6 +830,7 @@ void QucsApp::initMenuBar()
   simMenu->addAction(dcbias);
   simMenu->addAction(showMsg);
   simMenu->addAction(showNet);
+  simMenu->addAction(simQueue);
 
 
   viewMenu = new QMenu(tr("&View"));  // menuBar entry viewMenu
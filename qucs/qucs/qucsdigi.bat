@@ -35,6 +35,9 @@ if not exist "%DIR%" goto nodir
 
 cd /d "%DIR%"
 
+set VHDLDIR=vhdl
+if not "X%QUCS_VHDL_DIR%"=="X" set VHDLDIR=%QUCS_VHDL_DIR%
+
 if not exist %NAME% goto nofile
 
 copy %NAME% digi.vhdl > NUL
@@ -48,7 +51,7 @@ set LIBS=-lfreehdl-kernel -lfreehdl-std -lieee -lregex
 set PATH=%PATH%;%FREEHDL%/bin
 
 echo running C++ conversion...
-freehdl-v2cc -m %NAME%._main_.cc -L"%FREEHDL%/share/freehdl/lib" -Lvhdl -o %NAME%.cc %NAME%.vhdl
+freehdl-v2cc -m %NAME%._main_.cc -L"%FREEHDL%/share/freehdl/lib" -L"%VHDLDIR%" -o %NAME%.cc %NAME%.vhdl
 
 echo compiling functions...
 %CXX% %CXXFLAGS% -c %NAME%.cc
@@ -57,7 +60,7 @@ echo compiling main...
 %CXX% %CXXFLAGS% -c %NAME%._main_.cc
 
 echo linking...
-%CXX% %NAME%._main_.o %NAME%.o %LDFLAGS% -Lvhdl %VLIBS% %LIBS% -static-libstdc++ -o %NAME%.exe
+%CXX% %NAME%._main_.o %NAME%.o %LDFLAGS% -L"%VHDLDIR%" %VLIBS% %LIBS% -static-libstdc++ -o %NAME%.exe
 
 echo simulating...
 %NAME%.exe -q -cmd "dc -f %NAME%.vcd -t 1 ps -q;d;run %TIME%;q;" < NUL
@@ -32,6 +32,9 @@ if not exist "%DIR%" goto nodir
 
 cd /d "%DIR%"
 
+set VHDLDIR=vhdl
+if not "X%QUCS_VHDL_DIR%"=="X" set VHDLDIR=%QUCS_VHDL_DIR%
+
 if not exist %NAME% goto nofile
 
 copy %NAME% %ENTITY%.vhdl > NUL
@@ -45,17 +48,17 @@ set RANLIB=ranlib
 set PATH=%PATH%;%FREEHDL%/bin
 
 echo running C++ conversion...
-freehdl-v2cc -l%LIBRARY% -Lvhdl -L"%FREEHDL%/share/freehdl/lib" -o %NAME%.cc %NAME%.vhdl
+freehdl-v2cc -l%LIBRARY% -L"%VHDLDIR%" -L"%FREEHDL%/share/freehdl/lib" -o %NAME%.cc %NAME%.vhdl
 
 echo compiling functions...
 %CXX% %CXXFLAGS% -c %NAME%.cc
 
 echo copying modules to VHDL directory...
-copy %NAME%.o vhdl\%LIBRARY% > NUL
+copy %NAME%.o "%VHDLDIR%\%LIBRARY%" > NUL
 
 echo updating VHDL library...
-%AR% cru vhdl/lib%LIBRARY%.a vhdl/%LIBRARY%/*.o
-%RANLIB% vhdl/lib%LIBRARY%.a
+%AR% cru "%VHDLDIR%/lib%LIBRARY%.a" %VHDLDIR%/%LIBRARY%/*.o
+%RANLIB% "%VHDLDIR%/lib%LIBRARY%.a"
 
 goto end
 
@@ -48,6 +48,7 @@
 #include "viewpainter.h"
 #include "mouseactions.h"
 #include "diagrams/diagrams.h"
+#include "diagrams/graphloader.h"
 #include "paintings/paintings.h"
 #include "components/vhdlfile.h"
 #include "components/verilogfile.h"
@@ -87,9 +88,9 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
 
   // The 'i' means state for being unchanged.
   undoActionIdx = 0;
-  undoAction.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
+  undoAction.append(new UndoState(" i\n</>\n</>\n</>\n</>\n"));
   undoSymbolIdx = 0;
-  undoSymbol.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
+  undoSymbol.append(new UndoState(" i\n</>\n</>\n</>\n</>\n"));
 
   isVerilog = false;
   creatingLib = false;
@@ -111,6 +112,9 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
       viewport(), SLOT(update()));
   connect(this, SIGNAL(verticalSliderReleased()),
       viewport(), SLOT(update()));
+  // repaint diagrams whose data was loaded in the background
+  connect(GraphLoader::instance(), SIGNAL(diagramLoaded(Diagram*)),
+      this, SLOT(slotDiagramLoaded(Diagram*)));
   if (App_) {
     connect(this, SIGNAL(signalCursorPosChanged(int, int)), 
         App_, SLOT(printCursorPosition(int, int)));
@@ -221,7 +225,7 @@ void Schematic::becomeCurrent(bool update)
     emit signalUndoState(undoActionIdx != 0);
     emit signalRedoState(undoActionIdx != undoAction.size()-1);
     if(update)
-      reloadGraphs();   // load recent simulation data
+      reloadGraphs(true);   // load recent simulation data
   }
 }
 
@@ -240,6 +244,165 @@ void Schematic::setName (const QString& Name_)
     DataDisplay = base + ".sch";
 }
 
+// ---------------------------------------------------
+// "s" is split into lines. "prev", the newest state so far, then only
+// keeps the changes from these lines to its own.
+UndoState::UndoState(const QString& s, UndoState *prev)
+  : Next(0)
+{
+  Op = s.at(0);
+  Unchanged = (s.at(1) == 'i');
+
+  Lines = s.mid(s.indexOf('\n')+1).split('\n');
+  Lines.removeLast();   // empty, as the text ends with newline
+
+  if(!prev)  return;
+  prev->expand();
+  prev->Delta = diff(prev->Lines, Lines);
+  prev->Lines.clear();
+  prev->Next = this;
+}
+
+// ---------------------------------------------------
+// Returns the text as created by "createUndoString()".
+QString UndoState::text() const
+{
+  QString s(Op);
+  s += Unchanged ? 'i' : ' ';
+  s += '\n';
+  foreach(const QString& Line, lines())
+    s += Line + '\n';
+  return s;
+}
+
+// ---------------------------------------------------
+void UndoState::expand()
+{
+  if(!Next)  return;
+  Lines = lines();
+  Delta.clear();
+  Next = 0;
+}
+
+// ---------------------------------------------------
+// Goes back from the newest state, applying the changes of every state
+// on the way.
+QStringList UndoState::lines() const
+{
+  QList<UndoState const*> Chain;
+  UndoState const* p = this;
+  for( ; p->Next; p = p->Next)
+    Chain.prepend(p);
+
+  QStringList l = p->Lines;
+  foreach(UndoState const* c, Chain)
+    l = c->patch(l);
+  return l;
+}
+
+// ---------------------------------------------------
+// Applies "Delta" to the lines "next" of the successor.
+QStringList UndoState::patch(const QStringList& next) const
+{
+  QStringList l;
+  int i = 0;
+  foreach(const Hunk& h, Delta) {
+    while(i < h.Pos)  l.append(next.at(i++));
+    l += h.Lines;
+    i += h.Removed;
+  }
+  while(i < next.size())  l.append(next.at(i++));
+  return l;
+}
+
+// ---------------------------------------------------
+// Returns the changes from "to" to "from", ordered by position. After
+// skipping the common lines at both ends, the rest is compared by the
+// algorithm of E. Myers ("An O(ND) Difference Algorithm and Its
+// Variations", 1986). More than UNDO_DIFF_MAX differences are kept as
+// one block.
+#define UNDO_DIFF_MAX 64
+
+QList<UndoState::Hunk> UndoState::diff(const QStringList& from,
+                                       const QStringList& to)
+{
+  QList<Hunk> Hunks;
+  int n = from.size(), m = to.size();
+  int Begin = 0, End = 0;
+  while((Begin < n) && (Begin < m) && (from.at(Begin) == to.at(Begin)))
+    Begin++;
+  while((End < n-Begin) && (End < m-Begin) &&
+        (from.at(n-1-End) == to.at(m-1-End)))
+    End++;
+  n -= Begin + End;
+  m -= Begin + End;
+  if((n == 0) && (m == 0))  return Hunks;
+
+  // V[k] is the furthest x on diagonal k = x-y (x in "from", y in "to")
+  // for d differences, "Trace" keeps it for every d (index k+d).
+  QVector<QVector<int> > Trace;
+  int Off = UNDO_DIFF_MAX + 1;
+  QVector<int> V(2*UNDO_DIFF_MAX + 3, 0);
+  int d, k, x, y, D = -1;
+  for(d = 0; (d <= UNDO_DIFF_MAX) && (D < 0); d++) {
+    for(k = -d; k <= d; k += 2) {
+      if((k == -d) || ((k != d) && (V.at(Off+k-1) < V.at(Off+k+1))))
+        x = V.at(Off+k+1);     // line of "to" only
+      else
+        x = V.at(Off+k-1) + 1; // line of "from" only
+      y = x - k;
+      while((x < n) && (y < m) && (from.at(Begin+x) == to.at(Begin+y))) {
+        x++;
+        y++;
+      }
+      V[Off+k] = x;
+      if((x >= n) && (y >= m)) {
+        D = d;
+        break;
+      }
+    }
+    Trace.append(V.mid(Off-d, 2*d+1));
+  }
+
+  if(D < 0) {
+    Hunk h;
+    h.Pos = Begin;
+    h.Removed = m;
+    h.Lines = from.mid(Begin, n);
+    Hunks.append(h);
+    return Hunks;
+  }
+
+  // walk back from the end, one difference per step, and put adjacent
+  // differences into one hunk
+  x = n;
+  y = m;
+  for(d = D; d > 0; d--) {
+    const QVector<int>& P = Trace.at(d-1);
+    k = x - y;
+    bool Down = (k == -d) || ((k != d) && (P.at(k-1+d-1) < P.at(k+1+d-1)));
+    int pk = Down ? k+1 : k-1;
+    int px = P.at(pk+d-1), py = px - pk;
+    int ex = Down ? px : px+1, ey = Down ? py+1 : py;  // end of the step
+
+    // the current hunk starts at (x,y), equal lines lie in between else
+    if(Hunks.isEmpty() || (ex != x) || (ey != y)) {
+      Hunk h;
+      h.Removed = 0;
+      Hunks.prepend(h);
+    }
+    Hunk& h = Hunks.first();
+    h.Pos = Begin + py;
+    if(Down)
+      h.Removed++;
+    else
+      h.Lines.prepend(from.at(Begin+px));
+    x = px;
+    y = py;
+  }
+  return Hunks;
+}
+
 // ---------------------------------------------------
 // Sets the document to be changed or not to be changed.
 void Schematic::setChanged(bool c, bool fillStack, char Op)
@@ -252,18 +415,29 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
 
   showBias = -1;   // schematic changed => bias points may be invalid
 
+  // Anything may have changed the netlist of the components, except for
+  // property edits ('p'), which invalidate the edited component only.
+  if(c && Op != 'p') {
+    Q3PtrListIterator<Component> it(DocComps);
+    for(Component *pc; (pc = it.current()) != 0; ++it)
+      pc->invalidateNetlist();
+  }
+
   if(!fillStack)
     return;
 
 
   // ................................................
   if(symbolMode) {  // for symbol edit mode
+    if(!undoSymbol.isEmpty())  // empty while loading
+      undoSymbol.at(undoSymbolIdx)->expand();
     while(undoSymbol.size() > undoSymbolIdx + 1) {
       delete undoSymbol.last();
       undoSymbol.pop_back();
     }
 
-    undoSymbol.append(new QString(createSymbolUndoString(Op)));
+    undoSymbol.append(new UndoState(createSymbolUndoString(Op),
+                      undoSymbol.isEmpty() ? 0 : undoSymbol.last()));
     undoSymbolIdx++;
 
     emit signalUndoState(true);
@@ -279,20 +453,26 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
 
   // ................................................
   // for schematic edit mode
+  if(!undoAction.isEmpty())
+    undoAction.at(undoActionIdx)->expand();
   while(undoAction.size() > undoActionIdx + 1) {
     delete undoAction.last();
     undoAction.pop_back();
   }
 
   if(Op == 'm') {   // only one for move marker
-    if (undoAction.at(undoActionIdx)->at(0) == Op) {
+    if ((undoActionIdx > 0) && (undoAction.at(undoActionIdx)->op() == Op)) {
+      // the predecessor is patched from the last state, so it has to take
+      // back all lines before that one goes away
+      undoAction.at(undoActionIdx-1)->expand();
       delete undoAction.last();
       undoAction.pop_back();
       undoActionIdx--;
     }
   }
 
-  undoAction.append(new QString(createUndoString(Op)));
+  undoAction.append(new UndoState(createUndoString(Op),
+                    undoAction.isEmpty() ? 0 : undoAction.last()));
   undoActionIdx++;
 
   emit signalUndoState(true);
@@ -405,26 +585,56 @@ void Schematic::drawContents(QPainter *p, int, int, int, int)
   if(!symbolMode)
     paintFrame(&Painter);
 
-  for(Component *pc = Components->first(); pc != 0; pc = Components->next())
+  // visible area in schematic coordinates, elements completely outside
+  // of it are not painted. The margin covers pen widths and port circles.
+  int vx1 = int(float(contentsX())/Scale) + ViewX1 - 8;
+  int vy1 = int(float(contentsY())/Scale) + ViewY1 - 8;
+  int vx2 = int(float(contentsX()+visibleWidth())/Scale) + ViewX1 + 8;
+  int vy2 = int(float(contentsY()+visibleHeight())/Scale) + ViewY1 + 8;
+
+  float Corr = textCorr();
+  int x1, y1, x2, y2;
+  for(Component *pc = Components->first(); pc != 0; pc = Components->next()) {
+    // simulation components set their size while painting, always paint them
+    if(pc->Model.at(0) != '.') {
+      // the text only extends to the right of and below (tx, ty), so most
+      // invisible components are found without measuring it
+      x1 = pc->cx + qMin(pc->x1, pc->tx);
+      y1 = pc->cy + qMin(pc->y1, pc->ty);
+      if((x1 > vx2) || (y1 > vy2))  continue;
+      if((pc->cx+pc->x2 < vx1) || (pc->cy+pc->y2 < vy1)) {
+        pc->entireBounds(x1, y1, x2, y2, Corr);
+        if((x2 < vx1) || (y2 < vy1))  continue;
+      }
+    }
     pc->paint(&Painter);
+  }
 
   for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next()) {
-    pw->paint(&Painter);
+    if((qMax(pw->x1, pw->x2) >= vx1) && (qMin(pw->x1, pw->x2) <= vx2) &&
+       (qMax(pw->y1, pw->y2) >= vy1) && (qMin(pw->y1, pw->y2) <= vy2))
+      pw->paint(&Painter);
     if(pw->Label)
       pw->Label->paint(&Painter);  // separate because of paintSelected
   }
 
   Node *pn;
   for(pn = Nodes->first(); pn != 0; pn = Nodes->next()) {
-    pn->paint(&Painter);
+    if((pn->cx >= vx1) && (pn->cx <= vx2) && (pn->cy >= vy1) && (pn->cy <= vy2))
+      pn->paint(&Painter);
     if(pn->Label)
       pn->Label->paint(&Painter);  // separate because of paintSelected
   }
 
   // FIXME disable here, issue with select box goes away
   // also, instead of red, line turns blue
-  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
+  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next()) {
     pd->paint(&Painter);
+    if(GraphLoader::instance()->isLoading(pd)) {  // data not yet available
+      Painter.Painter->setPen(Qt::gray);
+      Painter.drawText(tr("loading data ..."), pd->cx+4, pd->cy-pd->y2+4);
+    }
+  }
 
   for(Painting *pp = Paintings->first(); pp != 0; pp = Paintings->next())
     pp->paint(&Painter);
@@ -1262,11 +1472,26 @@ bool Schematic::mirrorYComponents()
 
 // ---------------------------------------------------
 // Updates the graph data of all diagrams (load from data files).
-void Schematic::reloadGraphs()
+// With "background" set, the files are read by worker threads and each
+// diagram is repainted as soon as its data is ready.
+void Schematic::reloadGraphs(bool background)
 {
   QFileInfo Info(DocName);
-  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
-    pd->loadGraphData(Info.path()+QDir::separator()+DataSet);
+  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next()) {
+    if(background)
+      GraphLoader::instance()->load(pd, Info.path()+QDir::separator()+DataSet);
+    else
+      pd->loadGraphData(Info.path()+QDir::separator()+DataSet);
+  }
+  if(background)
+    viewport()->update();   // show the placeholders
+}
+
+// ---------------------------------------------------
+void Schematic::slotDiagramLoaded(Diagram *pd)
+{
+  if(Diagrams->containsRef(pd))
+    viewport()->update();
 }
 
 // Copy function, 
@@ -1302,6 +1527,8 @@ bool Schematic::load()
   DocComps.clear();
   DocWires.clear();
   DocNodes.clear();
+  NodeMap.clear();
+  WireMap.clear();
   DocDiags.clear();
   DocPaints.clear();
   SymbolPaints.clear();
@@ -1321,11 +1548,11 @@ bool Schematic::load()
   symbolMode = true;
   setChanged(false, true); // "not changed" state, but put on undo stack
   undoSymbolIdx = 0;
-  undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+  undoSymbol.at(undoSymbolIdx)->setUnchanged(true);
   symbolMode = false;
   setChanged(false, true); // "not changed" state, but put on undo stack
   undoActionIdx = 0;
-  undoAction.at(undoActionIdx)->replace(1, 1, 'i');
+  undoAction.at(undoActionIdx)->setUnchanged(true);
 
   // The undo stack of the circuit symbol is initialized when first
   // entering its edit mode.
@@ -1358,18 +1585,16 @@ int Schematic::save()
   if(result >= 0) {
     setChanged(false);
 
-    QVector<QString *>::iterator it;
+    QVector<UndoState *>::iterator it;
     for (it = undoAction.begin(); it != undoAction.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
+      (*it)->setUnchanged(false);   // state of being changed
     }
-    //(1) = 'i';   // state of being unchanged
-    undoAction.at(undoActionIdx)->replace(1, 1, 'i');
+    undoAction.at(undoActionIdx)->setUnchanged(true);
 
     for (it = undoSymbol.begin(); it != undoSymbol.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
+      (*it)->setUnchanged(false);   // state of being changed
     }
-    //at(1) = 'i';   // state of being unchanged
-    undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+    undoSymbol.at(undoSymbolIdx)->setUnchanged(true);
   }
   // update the subcircuit file lookup hashes
   QucsMain->updateSchNameHash();
@@ -1621,14 +1846,15 @@ bool Schematic::undo()
   if(symbolMode) {
     if (undoSymbolIdx == 0) { return false; }
 
-    rebuildSymbol(undoSymbol.at(--undoSymbolIdx));
+    QString s = undoSymbol.at(--undoSymbolIdx)->text();
+    rebuildSymbol(&s);
     adjustPortNumbers();  // set port names
 
     emit signalUndoState(undoSymbolIdx != 0);
     emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i' && 
-        undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.at(undoSymbolIdx)->isUnchanged() && 
+        undoAction.at(undoActionIdx)->isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1641,18 +1867,19 @@ bool Schematic::undo()
   // ...... for schematic edit mode .......
   if (undoActionIdx == 0) { return false; }
 
-  rebuild(undoAction.at(--undoActionIdx));
-  reloadGraphs();  // load recent simulation data
+  QString s = undoAction.at(--undoActionIdx)->text();
+  rebuild(&s);
+  reloadGraphs(true);  // load recent simulation data
 
   emit signalUndoState(undoActionIdx != 0);
   emit signalRedoState(undoActionIdx != undoAction.size()-1);
 
-  if(undoAction.at(undoActionIdx)->at(1) == 'i') {
+  if(undoAction.at(undoActionIdx)->isUnchanged()) {
     if(undoSymbol.isEmpty()) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.at(undoSymbolIdx)->isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1668,14 +1895,15 @@ bool Schematic::redo()
   if(symbolMode) {
     if (undoSymbolIdx == undoSymbol.size() - 1) { return false; }
 
-    rebuildSymbol(undoSymbol.at(++undoSymbolIdx));
+    QString s = undoSymbol.at(++undoSymbolIdx)->text();
+    rebuildSymbol(&s);
     adjustPortNumbers();  // set port names
 
     emit signalUndoState(undoSymbolIdx != 0);
     emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i'
-        && undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.at(undoSymbolIdx)->isUnchanged()
+        && undoAction.at(undoActionIdx)->isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1689,18 +1917,19 @@ bool Schematic::redo()
   // ...... for schematic edit mode .......
   if (undoActionIdx == undoAction.size()-1) { return false; }
 
-  rebuild(undoAction.at(++undoActionIdx));
-  reloadGraphs();  // load recent simulation data
+  QString s = undoAction.at(++undoActionIdx)->text();
+  rebuild(&s);
+  reloadGraphs(true);  // load recent simulation data
 
   emit signalUndoState(undoActionIdx != 0);
   emit signalRedoState(undoActionIdx != undoAction.size()-1);
 
-  if (undoAction.at(undoActionIdx)->at(1) == 'i') {
+  if (undoAction.at(undoActionIdx)->isUnchanged()) {
     if(undoSymbol.isEmpty()) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.at(undoSymbolIdx)->isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -34,12 +34,16 @@
 #include "diagrams/diagram.h"
 #include "paintings/painting.h"
 #include "components/component.h"
+#include "nodeindex.h"
+#include "wireindex.h"
 
 #include <Q3ScrollView>
 #include <Q3PtrList>
 #include <QVector>
 #include <QStringList>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
 
 class QTextStream;
 class QTextEdit;
@@ -92,6 +96,42 @@ class ComponentList : public Q3PtrList<Component> {
 class PaintingList : public Q3PtrList<Painting> {
 };
 
+// One state of the undo stack, i.e. the document as created by
+// "createUndoString()". Only the newest state keeps all lines, every
+// older one just the changes that turn its successor back into it, so a
+// state costs about the lines changed by one edit. That is the memory
+// only: a new state still serializes and compares the whole document,
+// and undo/redo still rebuild it from text. A state must be expanded
+// before its successor is deleted.
+class UndoState {
+public:
+  UndoState(const QString&, UndoState *prev=0);
+
+  QChar op() const { return Op; }
+  bool isUnchanged() const { return Unchanged; }  // same as saved file ?
+  void setUnchanged(bool u) { Unchanged = u; }
+  QString text() const;
+  void expand();   // keeps all lines again, before its successors are deleted
+
+private:
+  // "Removed" lines of the successor at "Pos" are replaced by "Lines"
+  struct Hunk {
+    int Pos;
+    int Removed;
+    QStringList Lines;
+  };
+
+  QStringList lines() const;
+  QStringList patch(const QStringList&) const;
+  static QList<Hunk> diff(const QStringList&, const QStringList&);
+
+  QChar Op;
+  bool  Unchanged;
+  QStringList Lines;        // the newest state only
+  QList<Hunk> Delta;        // changes to "Next"
+  UndoState const* Next;    // successor, 0 for the newest state
+};
+
 class Schematic : public Q3ScrollView, public QucsDoc {
   Q_OBJECT
 public:
@@ -123,7 +163,7 @@ public:
   void  enlargeView(int, int, int, int);
   void  switchPaintMode();
   int   adjustPortNumbers();
-  void  reloadGraphs();
+  void  reloadGraphs(bool background=false);
   bool  createSubcircuitSymbol();
 
   void    cut();
@@ -177,9 +217,9 @@ public:
   int tmpUsedX1, tmpUsedY1, tmpUsedX2, tmpUsedY2;
 
   int undoActionIdx;
-  QVector<QString *> undoAction;
+  QVector<UndoState *> undoAction;
   int undoSymbolIdx;
-  QVector<QString *> undoSymbol;    // undo stack for circuit symbol
+  QVector<UndoState *> undoSymbol;    // undo stack for circuit symbol
 
   /*! \brief Get (schematic) file reference */
   QFileInfo getFileInfo (void) { return FileInfo; }
@@ -212,6 +252,7 @@ protected slots:
   void slotScrollDown();
   void slotScrollLeft();
   void slotScrollRight();
+  void slotDiagramLoaded(Diagram*);
 
 private:
   bool dragIsOkay;
@@ -303,12 +344,14 @@ public:
   int  prepareNetlist(QTextStream&, QStringList&, QPlainTextEdit*);
   QString createNetlist(QTextStream&, int);
   bool loadDocument();
+  static Schematic* loadSubcircuit(const QString&);
   void highlightWireLabels (void);
 
 private:
   int  saveDocument();
 
   bool loadProperties(QTextStream*);
+  Node* simpleInsertNode(int, int);
   void simpleInsertComponent(Component*);
   bool loadComponents(QTextStream*, Q3PtrList<Component> *List=0);
   void simpleInsertWire(Wire*);
@@ -325,9 +368,19 @@ private:
   QString createSymbolUndoString(char);
   bool    rebuildSymbol(QString *);
 
+  // positions of the nodes in "DocNodes" and of the wires in
+  // "DocWires", built when first needed
+  NodeIndex NodeMap;
+  Node* findNode(int, int);
+  void  appendNode(Node*);
+  void  removeNode(Node*);
+  WireIndex WireMap;
+  Wire* findWire(int, int);
+  void  appendWire(Wire*);
+  void  removeWire(Wire*);
+
   static void createNodeSet(QStringList&, int&, Conductor*, Node*);
-  void throughAllNodes(bool, QStringList&, int&);
-  void propagateNode(QStringList&, int&, Node*);
+  void throughAllNodes(QStringList&, int&);
   void collectDigitalSignals(void);
   bool giveNodeNames(QTextStream *, int&, QStringList&, QPlainTextEdit*, int);
   void beginNetlistDigital(QTextStream &);
@@ -337,6 +390,13 @@ private:
   DigMap Signals; // collecting node names for VHDL signal declarations
   QStringList PortTypes;
 
+  // netlist block of the last run as subcircuit, see createSubNetlist()
+  QString SubNetlist;
+  QString SubNetlistName;  // "DocName" it was created with
+  SubMap  SubNetlistFiles; // entries it added to "FileList"
+  QHash<QString, QDateTime> SubNetlistDeps; // files of the hierarchy below
+  QString NetlistDocName;  // "DocName" of the last netlist run
+
 public: // for now. move to parser asap
 	Component* loadComponent(const QString& _s, Component* c) const;
 
@@ -32,24 +32,74 @@
 // the coordinates are identical. The node is returned.
 Node* Schematic::insertNode(int x, int y, Element *e)
 {
-    Node *pn;
     // check if new node lies upon existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == x) if(pn->cy == y)
-            {
-                pn->Connections.append(e);
-                break;
-            }
+    Node *pn = findNode(x, y);
+    if(pn)
+        pn->Connections.append(e);
 
     if(pn == 0)   // create new node, if no existing one lies at this position
     {
         pn = new Node(x, y);
-        Nodes->append(pn);
+        appendNode(pn);
         pn->Connections.append(e);  // connect schematic node to component node
     }
     else return pn;   // return, if node is not new
 
     // check if the new node lies upon an existing wire
+    Wire *pw = findWire(x, y);
+    if(pw)
+        splitWire(pw, pn);   // split the wire into two wires
+
+    return pn;
+}
+
+// ---------------------------------------------------
+Node* Schematic::selectedNode(int x, int y)
+{
+    if(Nodes == &DocNodes)
+    {
+        if(!NodeMap.isBuilt())  NodeMap.build(&DocNodes);
+        return NodeMap.selected(x, y);
+    }
+
+    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next()) // test nodes
+        if(pn->getSelected(x, y))
+            return pn;
+
+    return 0;
+}
+
+// ---------------------------------------------------
+// Returns the node at x/y, 0 if there is none. The nodes of the
+// schematic are found by their position (see NodeIndex), those of the
+// symbol by a walk through the list.
+Node* Schematic::findNode(int x, int y)
+{
+    if(Nodes == &DocNodes)
+    {
+        if(!NodeMap.isBuilt())  NodeMap.build(&DocNodes);
+        return NodeMap.find(x, y);
+    }
+
+    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next())
+        if(pn->cx == x) if(pn->cy == y)
+            return pn;
+
+    return 0;
+}
+
+// ---------------------------------------------------
+// Returns the first wire x/y lies on, its ends included, 0 if there is
+// none. As with the nodes, the wires of the schematic are found by their
+// position (see WireIndex).
+Wire* Schematic::findWire(int x, int y)
+{
+    if(Wires == &DocWires)
+    {
+        if(!WireMap.isBuilt())  WireMap.build(&DocWires);
+        return WireMap.find(x, y);
+    }
+
     for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
     {
         if(pw->x1 == x)
@@ -63,23 +113,44 @@ Node* Schematic::insertNode(int x, int y, Element *e)
             if(pw->x2 < x) continue;
         }
         else continue;
-
-        // split the wire into two wires
-        splitWire(pw, pn);
-        return pn;
+        return pw;
     }
 
-    return pn;
+    return 0;
 }
 
 // ---------------------------------------------------
-Node* Schematic::selectedNode(int x, int y)
+// Every node enters and leaves "Nodes" by these two, so that the index
+// of the nodes stays up to date.
+void Schematic::appendNode(Node *pn)
 {
-    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next()) // test nodes
-        if(pn->getSelected(x, y))
-            return pn;
+    Nodes->append(pn);
+    if(Nodes == &DocNodes)
+        NodeMap.insert(pn);
+}
 
-    return 0;
+// ---------------------------------------------------
+void Schematic::removeNode(Node *pn)
+{
+    NodeMap.remove(pn);
+    Nodes->removeRef(pn);   // deletes the node
+}
+
+// ---------------------------------------------------
+// The same for the wires. Those taken out of "Wires" without deleting
+// them leave the index by WireMap.remove().
+void Schematic::appendWire(Wire *pw)
+{
+    Wires->append(pw);
+    if(Wires == &DocWires)
+        WireMap.insert(pw);
+}
+
+// ---------------------------------------------------
+void Schematic::removeWire(Wire *pw)
+{
+    WireMap.remove(pw);
+    Wires->removeRef(pw);   // deletes the wire
 }
 
 
@@ -94,10 +165,8 @@ Node* Schematic::selectedNode(int x, int y)
 // If 2 is returned, the wire line ended.
 int Schematic::insertWireNode1(Wire *w)
 {
-    Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next()) // check every node
-        if(pn->cx == w->x1) if(pn->cy == w->y1) break;
+    Node *pn = findNode(w->x1, w->y1);
 
     if(pn != 0)
     {
@@ -109,13 +178,11 @@ int Schematic::insertWireNode1(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    Wire *ptr2 = findWire(w->x1, w->y1);
+    if(ptr2)
     {
         if(ptr2->x1 == w->x1)
         {
-            if(ptr2->y1 > w->y1) continue;
-            if(ptr2->y2 < w->y1) continue;
-
             if(ptr2->isHorizontal() == w->isHorizontal())   // ptr2-wire is vertical
             {
                 if(ptr2->y2 >= w->y2)
@@ -138,8 +205,8 @@ int Schematic::insertWireNode1(Wire *w)
                         }
                         ptr2->Port1->Connections.removeRef(ptr2);  // two -> one wire
                         ptr2->Port1->Connections.append(w);
-                        Nodes->removeRef(ptr2->Port2);
-                        Wires->removeRef(ptr2);
+                        removeNode(ptr2->Port2);
+                        removeWire(ptr2);
                         return 2;
                     }
                     else
@@ -152,11 +219,8 @@ int Schematic::insertWireNode1(Wire *w)
                 }
             }
         }
-        else if(ptr2->y1 == w->y1)
+        else   // ptr2->y1 == w->y1
         {
-            if(ptr2->x1 > w->x1) continue;
-            if(ptr2->x2 < w->x1) continue;
-
             if(ptr2->isHorizontal() == w->isHorizontal())   // ptr2-wire is horizontal
             {
                 if(ptr2->x2 >= w->x2)
@@ -179,8 +243,8 @@ int Schematic::insertWireNode1(Wire *w)
                         }
                         ptr2->Port1->Connections.removeRef(ptr2); // two -> one wire
                         ptr2->Port1->Connections.append(w);
-                        Nodes->removeRef(ptr2->Port2);
-                        Wires->removeRef(ptr2);
+                        removeNode(ptr2->Port2);
+                        removeWire(ptr2);
                         return 2;
                     }
                     else
@@ -193,10 +257,9 @@ int Schematic::insertWireNode1(Wire *w)
                 }
             }
         }
-        else continue;
 
         pn = new Node(w->x1, w->y1);   // create new node
-        Nodes->append(pn);
+        appendNode(pn);
         pn->Connections.append(w);  // connect schematic node to the new wire
         w->Port1 = pn;
 
@@ -206,7 +269,7 @@ int Schematic::insertWireNode1(Wire *w)
     }
 
     pn = new Node(w->x1, w->y1);   // create new node
-    Nodes->append(pn);
+    appendNode(pn);
     pn->Connections.append(w);  // connect schematic node to the new wire
     w->Port1 = pn;
     return 1;
@@ -240,10 +303,10 @@ bool Schematic::connectHWires1(Wire *w)
             }
             w->x1 = pw->x1;
             w->Port1 = pw->Port1;      // new wire lengthens an existing one
-            Nodes->removeRef(n);
+            removeNode(n);
             w->Port1->Connections.removeRef(pw);
             w->Port1->Connections.append(w);
-            Wires->removeRef(pw);
+            removeWire(pw);
             return true;
         }
         if(pw->x2 >= w->x2)    // new wire lies within an existing one ?
@@ -261,8 +324,8 @@ bool Schematic::connectHWires1(Wire *w)
                 w->Label->pOwner = w;
             }
             pw->Port1->Connections.removeRef(pw);
-            Nodes->removeRef(pw->Port2);
-            Wires->removeRef(pw);
+            removeNode(pw->Port2);
+            removeWire(pw);
             return true;
         }
         w->x1 = pw->x2;    // shorten new wire according to an existing one
@@ -303,10 +366,10 @@ bool Schematic::connectVWires1(Wire *w)
             }
             w->y1 = pw->y1;
             w->Port1 = pw->Port1;         // new wire lengthens an existing one
-            Nodes->removeRef(n);
+            removeNode(n);
             w->Port1->Connections.removeRef(pw);
             w->Port1->Connections.append(w);
-            Wires->removeRef(pw);
+            removeWire(pw);
             return true;
         }
         if(pw->y2 >= w->y2)    // new wire lies complete within an existing one ?
@@ -324,8 +387,8 @@ bool Schematic::connectVWires1(Wire *w)
                 w->Label->pOwner = w;
             }
             pw->Port1->Connections.removeRef(pw);
-            Nodes->removeRef(pw->Port2);
-            Wires->removeRef(pw);
+            removeNode(pw->Port2);
+            removeWire(pw);
             return true;
         }
         w->y1 = pw->y2;    // shorten new wire according to an existing one
@@ -344,10 +407,8 @@ bool Schematic::connectVWires1(Wire *w)
 // If 2 is returned, the wire line ended.
 int Schematic::insertWireNode2(Wire *w)
 {
-    Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == w->x2) if(pn->cy == w->y2) break;
+    Node *pn = findNode(w->x2, w->y2);
 
     if(pn != 0)
     {
@@ -359,13 +420,11 @@ int Schematic::insertWireNode2(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    Wire *ptr2 = findWire(w->x2, w->y2);
+    if(ptr2)
     {
         if(ptr2->x1 == w->x2)
         {
-            if(ptr2->y1 > w->y2) continue;
-            if(ptr2->y2 < w->y2) continue;
-
             // (if new wire lies within an existing wire, was already check before)
             if(ptr2->isHorizontal() == w->isHorizontal())   // ptr2-wire is vertical
             {
@@ -382,8 +441,8 @@ int Schematic::insertWireNode2(Wire *w)
                     w->Port2 = ptr2->Port2;
                     ptr2->Port2->Connections.removeRef(ptr2);  // two -> one wire
                     ptr2->Port2->Connections.append(w);
-                    Nodes->removeRef(ptr2->Port1);
-                    Wires->removeRef(ptr2);
+                    removeNode(ptr2->Port1);
+                    removeWire(ptr2);
                     return 2;
                 }
                 else
@@ -395,11 +454,8 @@ int Schematic::insertWireNode2(Wire *w)
                 }
             }
         }
-        else if(ptr2->y1 == w->y2)
+        else   // ptr2->y1 == w->y2
         {
-            if(ptr2->x1 > w->x2) continue;
-            if(ptr2->x2 < w->x2) continue;
-
             // (if new wire lies within an existing wire, was already check before)
             if(ptr2->isHorizontal() == w->isHorizontal())   // ptr2-wire is horizontal
             {
@@ -416,8 +472,8 @@ int Schematic::insertWireNode2(Wire *w)
                     w->Port2 = ptr2->Port2;
                     ptr2->Port2->Connections.removeRef(ptr2);  // two -> one wire
                     ptr2->Port2->Connections.append(w);
-                    Nodes->removeRef(ptr2->Port1);
-                    Wires->removeRef(ptr2);
+                    removeNode(ptr2->Port1);
+                    removeWire(ptr2);
                     return 2;
                 }
                 else
@@ -429,10 +485,9 @@ int Schematic::insertWireNode2(Wire *w)
                 }
             }
         }
-        else continue;
 
         pn = new Node(w->x2, w->y2);   // create new node
-        Nodes->append(pn);
+        appendNode(pn);
         pn->Connections.append(w);  // connect schematic node to the new wire
         w->Port2 = pn;
 
@@ -442,7 +497,7 @@ int Schematic::insertWireNode2(Wire *w)
     }
 
     pn = new Node(w->x2, w->y2);   // create new node
-    Nodes->append(pn);
+    appendNode(pn);
     pn->Connections.append(w);  // connect schematic node to the new wire
     w->Port2 = pn;
     return 1;
@@ -470,10 +525,10 @@ bool Schematic::connectHWires2(Wire *w)
             }
             w->x2 = pw->x2;
             w->Port2 = pw->Port2;      // new wire lengthens an existing one
-            Nodes->removeRef(n);
+            removeNode(n);
             w->Port2->Connections.removeRef(pw);
             w->Port2->Connections.append(w);
-            Wires->removeRef(pw);
+            removeWire(pw);
             return true;
         }
         // (if new wire lies complete within an existing one, was already
@@ -488,8 +543,8 @@ bool Schematic::connectHWires2(Wire *w)
                 w->Label->pOwner = w;
             }
             pw->Port2->Connections.removeRef(pw);
-            Nodes->removeRef(pw->Port1);
-            Wires->removeRef(pw);
+            removeNode(pw->Port1);
+            removeWire(pw);
             return true;
         }
         w->x2 = pw->x1;    // shorten new wire according to an existing one
@@ -524,10 +579,10 @@ bool Schematic::connectVWires2(Wire *w)
             }
             w->y2 = pw->y2;
             w->Port2 = pw->Port2;     // new wire lengthens an existing one
-            Nodes->removeRef(n);
+            removeNode(n);
             w->Port2->Connections.removeRef(pw);
             w->Port2->Connections.append(w);
-            Wires->removeRef(pw);
+            removeWire(pw);
             return true;
         }
         // (if new wire lies complete within an existing one, was already
@@ -542,8 +597,8 @@ bool Schematic::connectVWires2(Wire *w)
                 w->Label->pOwner = w;
             }
             pw->Port2->Connections.removeRef(pw);
-            Nodes->removeRef(pw->Port1);
-            Wires->removeRef(pw);
+            removeNode(pw->Port1);
+            removeWire(pw);
             return true;
         }
         w->y2 = pw->y1;    // shorten new wire according to an existing one
@@ -607,7 +662,7 @@ int Schematic::insertWire(Wire *w)
     // change node 1 and 2
     if(con > 255) con = ((con >> 1) & 1) | ((con << 1) & 2);
 
-    Wires->append(w);    // add wire to the schematic
+    appendWire(w);    // add wire to the schematic
 
 
 
@@ -671,7 +726,7 @@ int Schematic::insertWire(Wire *w)
                 n2  = pn2->Connections.count();
                 if(n1 == 1)
                 {
-                    Nodes->removeRef(pn);     // delete node 1 if open
+                    removeNode(pn);     // delete node 1 if open
                     pn2->Connections.removeRef(nw);   // remove connection
                     pn = pn2;
                 }
@@ -679,7 +734,7 @@ int Schematic::insertWire(Wire *w)
                 if(n2 == 1)
                 {
                     pn->Connections.removeRef(nw);   // remove connection
-                    Nodes->removeRef(pn2);     // delete node 2 if open
+                    removeNode(pn2);     // delete node 2 if open
                     pn2 = pn;
                 }
 
@@ -690,7 +745,7 @@ int Schematic::insertWire(Wire *w)
                         pw->Label = nw->Label;
                         pw->Label->pOwner = pw;
                     }
-                    Wires->removeRef(nw);    // delete wire
+                    removeWire(nw);    // delete wire
                     Wires->findRef(pw);      // set back to current wire
                 }
                 break;
@@ -702,7 +757,7 @@ int Schematic::insertWire(Wire *w)
             {
                 nw = new Wire(pw->x1, pw->y1, pn->cx, pn->cy, pw->Port1, pn);
                 pn->Connections.append(nw);
-                Wires->append(nw);
+                appendWire(nw);
                 Wires->findRef(pw);
                 pw->Port1->Connections.append(nw);
             }
@@ -743,6 +798,12 @@ void Schematic::selectWireLine(Element *pe, Node *pn, bool ctrl)
 // ---------------------------------------------------
 Wire* Schematic::selectedWire(int x, int y)
 {
+    if(Wires == &DocWires)
+    {
+        if(!WireMap.isBuilt())  WireMap.build(&DocWires);
+        return WireMap.selected(x, y);
+    }
+
     for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
         if(pw->getSelected(x, y))
             return pw;
@@ -765,7 +826,7 @@ Wire* Schematic::splitWire(Wire *pw, Node *pn)
     pn->Connections.prepend(pw);
     pn->Connections.prepend(newWire);
     newWire->Port2->Connections.removeRef(pw);
-    Wires->append(newWire);
+    appendWire(newWire);
 
     if(pw->Label)
         if((pw->Label->cx > pn->cx) || (pw->Label->cy > pn->cy))
@@ -813,10 +874,10 @@ bool Schematic::oneTwoWires(Node *n)
                 e1->x2 = e2->x2;
                 e1->y2 = e2->y2;
                 e1->Port2 = e2->Port2;
-                Nodes->removeRef(n);    // delete node (is auto delete)
+                removeNode(n);    // delete node (is auto delete)
                 e1->Port2->Connections.removeRef(e2);
                 e1->Port2->Connections.append(e1);
-                Wires->removeRef(e2);
+                removeWire(e2);
                 return true;
             }
     return false;
@@ -829,7 +890,7 @@ void Schematic::deleteWire(Wire *w)
     if(w->Port1->Connections.count() == 1)
     {
         if(w->Port1->Label) delete w->Port1->Label;
-        Nodes->removeRef(w->Port1);     // delete node 1 if open
+        removeNode(w->Port1);     // delete node 1 if open
     }
     else
     {
@@ -841,7 +902,7 @@ void Schematic::deleteWire(Wire *w)
     if(w->Port2->Connections.count() == 1)
     {
         if(w->Port2->Label) delete w->Port2->Label;
-        Nodes->removeRef(w->Port2);     // delete node 2 if open
+        removeNode(w->Port2);     // delete node 2 if open
     }
     else
     {
@@ -855,7 +916,7 @@ void Schematic::deleteWire(Wire *w)
         delete w->Label;
         w->Label = 0;
     }
-    Wires->removeRef(w);
+    removeWire(w);
 }
 
 // ---------------------------------------------------
@@ -1663,6 +1724,7 @@ void Schematic::newMovingWires(Q3PtrList<Element> *p, Node *pn, int pos)
         pw->Port1->State |= 16+4;
         pw->Port2->Connections.removeRef(pw);   // remove connection 2
         pw->Port2->State |= 16+4;
+        WireMap.remove(pw);
         Wires->take(Wires->findRef(pw));
 
         if(pw->isHorizontal()) mask = 2;
@@ -1711,6 +1773,7 @@ void Schematic::newMovingWires(Q3PtrList<Element> *p, Node *pn, int pos)
         pw2->Port1->State |= 16+4;
         pw2->Port2->Connections.removeRef(pw2);   // remove connection 2
         pw2->Port2->State |= 16+4;
+        WireMap.remove(pw2);
         Wires->take(Wires->findRef(pw2));
 
         if(pw2->Port1 != pn2)
@@ -1784,6 +1847,7 @@ int Schematic::copySelectedElements(Q3PtrList<Element> *p)
             pw->Port1->State = 4;
             pw->Port2->Connections.removeRef(pw);   // remove connection 2
             pw->Port2->State = 4;
+            WireMap.remove(pw);
             Wires->take();
             pw = Wires->current();
         }
@@ -1841,6 +1905,7 @@ int Schematic::copySelectedElements(Q3PtrList<Element> *p)
                 else if(pn->State & 2) pn->Label->Type = isVMovingLabel;
                 p->append(pn->Label);    // do not forget the node labels
             }
+            NodeMap.remove(pn);
             Nodes->remove();
             pn = Nodes->current();
             continue;
@@ -2771,7 +2836,7 @@ void Schematic::setCompPorts(Component *pc)
                 pl->cx = pp->x + pc->cx;
                 pl->cy = pp->y + pc->cy;
             }
-            Nodes->removeRef(pp->Connection);
+            removeNode(pp->Connection);
             break;
         case 2:
             oneTwoWires(pp->Connection); // try to connect two wires to one
@@ -2854,7 +2919,7 @@ void Schematic::deleteComp(Component *c)
         {
         case 1  :
             if(pn->Connection->Label) delete pn->Connection->Label;
-            Nodes->removeRef(pn->Connection);  // delete open nodes
+            removeNode(pn->Connection);  // delete open nodes
             pn->Connection = 0;		  //  (auto-delete)
             break;
         case 3  :
@@ -3127,7 +3192,7 @@ void Schematic::insertNodeLabel(WireLabel *pl)
 
 
     Node *pn = new Node(pl->cx, pl->cy);
-    Nodes->append(pn);
+    appendNode(pn);
 
     pn->Label = pl;
     pl->Type  = isNodeLabel;
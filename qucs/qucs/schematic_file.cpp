@@ -33,6 +33,7 @@
 #include "qucs.h"
 #include "node.h"
 #include "schematic.h"
+#include "connectivity.h"
 #include "diagrams/diagrams.h"
 #include "paintings/paintings.h"
 #include "components/spicefile.h"
@@ -610,31 +611,30 @@ bool Schematic::loadProperties(QTextStream *stream)
 }
 
 // ---------------------------------------------------
+// Returns the node at x/y of the document, a new one if no node lies at
+// this position.
+Node* Schematic::simpleInsertNode(int x, int y)
+{
+  if(!NodeMap.isBuilt())  NodeMap.build(&DocNodes);
+  Node *pn = NodeMap.find(x, y);
+  if(!pn) {
+    pn = new Node(x, y);
+    DocNodes.append(pn);
+    NodeMap.insert(pn);
+  }
+  return pn;
+}
+
+// -------------------------------------------------------------
 // Inserts a component without performing logic for wire optimization.
 void Schematic::simpleInsertComponent(Component *c)
 {
   Node *pn;
-  int x, y;
   // connect every node of component
   foreach(Port *pp, c->Ports) {
-    x = pp->x+c->cx;
-    y = pp->y+c->cy;
-
-    // check if new node lies upon existing node
-    for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-      if(pn->cx == x) if(pn->cy == y) {
-	if (!pn->DType.isEmpty()) {
-	  pp->Type = pn->DType;
-	}
-	if (!pp->Type.isEmpty()) {
-	  pn->DType = pp->Type;
-	}
-	break;
-      }
-
-    if(pn == 0) { // create new node, if no existing one lies at this position
-      pn = new Node(x, y);
-      DocNodes.append(pn);
+    pn = simpleInsertNode(pp->x+c->cx, pp->y+c->cy);
+    if (!pn->DType.isEmpty()) {
+      pp->Type = pn->DType;
     }
     pn->Connections.append(c);  // connect schematic node to component node
     if (!pp->Type.isEmpty()) {
@@ -682,15 +682,8 @@ bool Schematic::loadComponents(QTextStream *stream, Q3PtrList<Component> *List)
 // Inserts a wire without performing logic for optimizing.
 void Schematic::simpleInsertWire(Wire *pw)
 {
-  Node *pn;
-  // check if first wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x1) if(pn->cy == pw->y1) break;
-
-  if(!pn) {   // create new node, if no existing one lies at this position
-    pn = new Node(pw->x1, pw->y1);
-    DocNodes.append(pn);
-  }
+  // first wire node, maybe lies upon existing node
+  Node *pn = simpleInsertNode(pw->x1, pw->y1);
 
   if(pw->x1 == pw->x2) if(pw->y1 == pw->y2) {
     pn->Label = pw->Label;   // wire with length zero are just node labels
@@ -704,18 +697,13 @@ void Schematic::simpleInsertWire(Wire *pw)
   pn->Connections.append(pw);  // connect schematic node to component node
   pw->Port1 = pn;
 
-  // check if second wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x2) if(pn->cy == pw->y2) break;
-
-  if(!pn) {   // create new node, if no existing one lies at this position
-    pn = new Node(pw->x2, pw->y2);
-    DocNodes.append(pn);
-  }
+  // second wire node, maybe lies upon existing node
+  pn = simpleInsertNode(pw->x2, pw->y2);
   pn->Connections.append(pw);  // connect schematic node to component node
   pw->Port2 = pn;
 
   DocWires.append(pw);
+  WireMap.insert(pw);
 }
 
 // -------------------------------------------------------------
@@ -1002,6 +990,8 @@ bool Schematic::rebuild(QString *s)
 {
   DocWires.clear();	// delete whole document
   DocNodes.clear();
+  NodeMap.clear();
+  WireMap.clear();
   DocComps.clear();
   DocDiags.clear();
   DocPaints.clear();
@@ -1055,31 +1045,67 @@ void Schematic::createNodeSet(QStringList& Collect, int& countInit,
 }
 
 // ---------------------------------------------------
-void Schematic::throughAllNodes(bool User, QStringList& Collect,
-				int& countInit)
+// Gives every unnamed node the name of the net it belongs to. Unnamed
+// nodes connected by wires form a region, which takes the name of the
+// first named node (in the order of "DocNodes") wired to it. Regions
+// without such a node get numbered names.
+void Schematic::throughAllNodes(QStringList& Collect, int& countInit)
 {
   Node *pn;
-  int z=0;
+  Wire *pw;
+  Connectivity Regions;
+
+  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
+    Regions.add(pn);
+  for(pw = DocWires.first(); pw != 0; pw = DocWires.next())
+    if(pw->Port1->Name.isEmpty() && pw->Port2->Name.isEmpty())
+      Regions.unite(pw->Port1, pw->Port2);
+
+  QVector<Node*> Owner(Regions.size(), 0);  // per region representative
+  QVector<QString> RegionName(Regions.size());
 
+  // work on named nodes first in order to preserve the user given names
   for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next()) {
-    if(pn->Name.isEmpty() == User) {
-      continue;  // already named ?
-    }
-    if(!User) {
-      if(isAnalog)
-	pn->Name = "_net";
-      else
-	pn->Name = "net_net";   // VHDL names must not begin with '_'
-      pn->Name += QString::number(z++);  // create numbered node name
-    }
-    else if(pn->State) {
-      continue;  // already worked on
+    if(pn->Name.isEmpty())  continue;
+    if(isAnalog) createNodeSet(Collect, countInit, pn, pn);
+
+    Q3PtrListIterator<Element> it(pn->Connections);
+    for(Element *pe; (pe = it.current()) != 0; ++it) {
+      if(pe->Type != isWire)  continue;
+      pw = (Wire*)pe;
+      Node *p2 = (pw->Port1 == pn) ? pw->Port2 : pw->Port1;
+      if(!p2->Name.isEmpty())  continue;
+
+      int r = Regions.find(p2);
+      if(!Owner[r]) {
+        Owner[r] = pn;
+        RegionName[r] = pn->Name;
+      }
+      else if(Owner[r] != pn)
+        continue;   // named by an earlier node already
+      if(isAnalog) createNodeSet(Collect, countInit, pw, pn);
     }
+  }
 
-    if(isAnalog) createNodeSet(Collect, countInit, pn, pn);
+  // give names to the remaining (unnamed) regions
+  int z=0;
+  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next()) {
+    if(pn->Name.isEmpty()) {
+      int r = Regions.find(pn);
+      if(RegionName[r].isEmpty()) {
+        if(isAnalog)
+          RegionName[r] = "_net";
+        else
+          RegionName[r] = "net_net";   // VHDL names must not begin with '_'
+        RegionName[r] += QString::number(z++);  // create numbered node name
+      }
+    }
+  }
 
+  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next()) {
+    if(pn->Name.isEmpty())
+      pn->Name = RegionName[Regions.find(pn)];
     pn->State = 1;
-    propagateNode(Collect, countInit, pn);
   }
 }
 
@@ -1095,12 +1121,9 @@ int Schematic::testFile(const QString& DocName)
 
   QString Line;
   // .........................................
-  // To strongly speed up the file read operation the whole file is
-  // read into the memory in one piece.
-  QTextStream ReadWhole(&file);
-  QString FileString = ReadWhole.readAll();
-  file.close();
-  QTextStream stream(&FileString, QIODevice::ReadOnly);
+  // The file is read line by line only up to the end of the components,
+  // the wires, diagrams and paintings after them are not needed.
+  QTextStream stream(&file);
 
 
   // read header ........................
@@ -1166,48 +1189,100 @@ void Schematic::collectDigitalSignals(void)
   }
 }
 
-// ---------------------------------------------------
-// Propagates the given node to connected component ports.
-void Schematic::propagateNode(QStringList& Collect,
-			      int& countInit, Node *pn)
+#include <iostream>
+
+// -------------------------------------------------------------
+// Subcircuit documents loaded for netlisting. They are kept across
+// netlist runs and reused as long as neither their file nor one of the
+// files their components were created from (subcircuits, libraries,
+// SPICE files ...) has changed.
+struct SubcircuitDoc {
+  Schematic *Doc;
+  QHash<QString, QDateTime> Files;   // file name -> modification time
+};
+static QHash<QString, SubcircuitDoc> SubcircuitDocs;
+#define SUBCIRCUIT_CACHE_SIZE  64
+
+static bool filesUnchanged(QHash<QString, QDateTime> const& Files)
 {
-  bool setName=false;
-  Q3PtrList<Node> Cons;
-  Node *p2;
-  Wire *pw;
-  Element *pe;
-
-  Cons.append(pn);
-  for(p2 = Cons.first(); p2 != 0; p2 = Cons.next())
-    for(pe = p2->Connections.first(); pe != 0; pe = p2->Connections.next())
-      if(pe->Type == isWire) {
-	pw = (Wire*)pe;
-	if(p2 != pw->Port1) {
-	  if(pw->Port1->Name.isEmpty()) {
-	    pw->Port1->Name = pn->Name;
-	    pw->Port1->State = 1;
-	    Cons.append(pw->Port1);
-	    setName = true;
-	  }
-	}
-	else {
-	  if(pw->Port2->Name.isEmpty()) {
-	    pw->Port2->Name = pn->Name;
-	    pw->Port2->State = 1;
-	    Cons.append(pw->Port2);
-	    setName = true;
-	  }
-	}
-	if(setName) {
-	  Cons.findRef(p2);   // back to current Connection
-	  if (isAnalog) createNodeSet(Collect, countInit, pw, pn);
-	  setName = false;
-	}
-      }
-  Cons.clear();
+  QHash<QString, QDateTime>::const_iterator it;
+  for(it = Files.constBegin(); it != Files.constEnd(); ++it)
+    if(QFileInfo(it.key()).lastModified() != it.value())
+      return false;
+  return true;
 }
 
-#include <iostream>
+/*!
+ * \brief Schematic::loadSubcircuit
+ * Returns the loaded subcircuit schematic "File" from the cache, or loads
+ * it if it is not cached or out of date. The document stays owned by the
+ * cache. Returns 0 if the file cannot be loaded.
+ */
+Schematic* Schematic::loadSubcircuit(const QString& File)
+{
+  QString Key = QFileInfo(File).absoluteFilePath();
+  QHash<QString, SubcircuitDoc>::iterator it = SubcircuitDocs.find(Key);
+  if(it != SubcircuitDocs.end()) {
+    if(filesUnchanged(it.value().Files))
+      return it.value().Doc;
+    delete it.value().Doc;
+    SubcircuitDocs.erase(it);
+  }
+
+  SubcircuitDoc sub;
+  sub.Files.insert(Key, QFileInfo(Key).lastModified());
+  sub.Doc = new Schematic(0, File);
+  if(!sub.Doc->loadDocument()) {
+    delete sub.Doc;
+    return 0;
+  }
+
+  for(Component *pc = sub.Doc->DocComps.first(); pc != 0;
+      pc = sub.Doc->DocComps.next()) {
+    QString f = pc->getSubcircuitFile();
+    if(!f.isEmpty())
+      sub.Files.insert(f, QFileInfo(f).lastModified());
+  }
+
+  SubcircuitDocs.insert(Key, sub);
+  return sub.Doc;
+}
+
+// Adds the files the cached subcircuit document "Doc" and the subcircuit
+// documents in "Files" depend on to "Deps", with the modification times
+// they were loaded with. Returns false if one of them is not cached.
+static bool subcircuitDependencies(const Schematic *Doc, const SubMap& Files,
+                                   QHash<QString, QDateTime>& Deps)
+{
+  QList<const SubcircuitDoc*> Docs;
+  QHash<QString, SubcircuitDoc>::const_iterator it;
+  for(it = SubcircuitDocs.constBegin(); it != SubcircuitDocs.constEnd(); ++it)
+    if(it.value().Doc == Doc)  Docs.append(&it.value());
+  if(Docs.isEmpty())  return false;
+
+  for(SubMap::const_iterator f = Files.constBegin(); f != Files.constEnd(); ++f) {
+    if(f.value().Type != "SCH")  continue;
+    it = SubcircuitDocs.constFind(QFileInfo(f.key()).absoluteFilePath());
+    if(it == SubcircuitDocs.constEnd())  return false;
+    Docs.append(&it.value());
+  }
+
+  foreach(const SubcircuitDoc *d, Docs)
+    for(QHash<QString, QDateTime>::const_iterator t = d->Files.constBegin();
+        t != d->Files.constEnd(); ++t)
+      Deps.insert(t.key(), t.value());
+  return true;
+}
+
+// Documents may still be in use while subcircuits are netlisted, so the
+// cache is only trimmed once the whole hierarchy is done.
+static void trimSubcircuitCache()
+{
+  if(SubcircuitDocs.size() <= SUBCIRCUIT_CACHE_SIZE)  return;
+  foreach(SubcircuitDoc const& d, SubcircuitDocs)
+    delete d.Doc;
+  SubcircuitDocs.clear();
+}
 
 /*!
  * \brief Schematic::throughAllComps
@@ -1226,6 +1301,39 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
   bool r;
   QString s;
 
+  // SPICE files missing in the conversion cache are converted all at
+  // once, the loop below then only reads them. a file that cannot be
+  // read or converted here would fail there as well, so stop right away.
+  QList<SpiceConversion> Cold;
+  QStringList ColdKeys;
+  QString ColdErrors;
+  int ColdFailed = 0;
+  for(Component *pc = DocComps.first(); isAnalog && pc != 0;
+      pc = DocComps.next()) {
+    if(pc->isActive != COMP_IS_ACTIVE) continue;
+    if(pc->obsolete_model_hack() != "SPICE") continue;
+    if(pc->Props.first()->Value.isEmpty()) continue;
+    pc->setSchematic (this);
+    SpiceConversion c = ((SpiceFile*)pc)->conversion();
+    if(!SpiceCache::prepare(c, ColdErrors)) {
+      ColdFailed++;
+      continue;
+    }
+    if(SpiceCache::contains(c)) continue;
+    if(ColdKeys.contains(c.Key)) continue;
+    ColdKeys.append(c.Key);
+    Cold.append(c);
+  }
+  if(Cold.size() > 1) {
+    SpiceConverter Converter;
+    ColdFailed += Converter.run(Cold, QThread::idealThreadCount());
+    ColdErrors += Converter.errorText();
+  }
+  if(!ColdErrors.isEmpty())
+    ErrText->appendPlainText(ColdErrors);
+  if(ColdFailed > 0)
+    return false;
+
   // give the ground nodes the name "gnd", and insert subcircuits etc.
   Q3PtrListIterator<Component> it(DocComps);
   Component *pc;
@@ -1281,12 +1389,11 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
       FileList.insert(f, sub);
 
 
-      // load subcircuit schematic
+      // load subcircuit schematic, unless it is loaded already
       s = pc->Props.first()->Value;
-      Schematic *d = new Schematic(0, pc->getSubcircuitFile());
-      if(!d->loadDocument())      // load document if possible
+      Schematic *d = loadSubcircuit(pc->getSubcircuitFile());
+      if(!d)
       {
-          delete d;
           /// \todo implement error/warning message dispatcher for GUI and CLI modes.
           QString message = QObject::tr("ERROR: Cannot load subcircuit \"%1\".").arg(s);
           if (QucsMain) // GUI is running
@@ -1314,7 +1421,6 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
         sub.PortTypes = d->PortTypes;
         FileList.insert(f, sub);
       }
-      delete d;
       if(!r)
       {
         return false;
@@ -1423,6 +1529,13 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
 bool Schematic::giveNodeNames(QTextStream *stream, int& countInit,
                    QStringList& Collect, QPlainTextEdit *ErrText, int NumPorts)
 {
+  // file names in the netlist lines may be relative to the document
+  if(NetlistDocName != DocName) {
+    for(Component *pc = DocComps.first(); pc != 0; pc = DocComps.next())
+      pc->invalidateNetlist();
+    NetlistDocName = DocName;
+  }
+
   // delete the node names
   for(Node *pn = DocNodes.first(); pn != 0; pn = DocNodes.next()) {
     pn->State = 0;
@@ -1450,11 +1563,8 @@ bool Schematic::giveNodeNames(QTextStream *stream, int& countInit,
     return false;
   }
 
-  // work on named nodes first in order to preserve the user given names
-  throughAllNodes(true, Collect, countInit);
-
-  // give names to the remaining (unnamed) nodes
-  throughAllNodes(false, Collect, countInit);
+  // name the nets
+  throughAllNodes(Collect, countInit);
 
   if(!isAnalog) // collect all node names for VHDL signal declaration
     collectDigitalSignals();
@@ -1629,7 +1739,7 @@ int NumPorts)
 
     // write all components with node names into netlist file
     for(pc = DocComps.first(); pc != 0; pc = DocComps.next())
-      (*tstream) << pc->getNetlist();
+      pc->getNetlist(*tstream);
 
     (*tstream) << ".Def:End\n";
 
@@ -1771,14 +1881,41 @@ int NumPorts)
 }
 // ---------------------------------------------------
 // Write the netlist as subcircuit to the text stream 'stream'.
+// Subcircuit documents are kept as long as their files do not change
+// (see loadSubcircuit()), so the analog block of the last run is written
+// again, unless a file it includes has been written by now already or
+// one of the files of the whole hierarchy below has changed.
 bool Schematic::createSubNetlist(QTextStream *stream, int& countInit,
                      QStringList& Collect, QPlainTextEdit *ErrText, int NumPorts)
 {
-//  int Collect_count = Collect.count();   // position for this subcircuit
+  bool useCache = isAnalog && !creatingLib;
+  SubMap::const_iterator it;
+  if(useCache && !SubNetlist.isNull() && SubNetlistName == DocName
+     && filesUnchanged(SubNetlistDeps)) {
+    for(it = SubNetlistFiles.constBegin(); it != SubNetlistFiles.constEnd(); ++it)
+      if(FileList.contains(it.key()))  break;
+    if(it == SubNetlistFiles.constEnd()) {
+      for(it = SubNetlistFiles.constBegin(); it != SubNetlistFiles.constEnd(); ++it)
+        FileList.insert(it.key(), it.value());
+      (*stream) << SubNetlist;
+      return true;
+    }
+  }
+  SubNetlist = QString();
+
+  QTextStream *out = stream;
+  QTextStream str(&SubNetlist);
+  SubMap FilesBefore = FileList;
+  int Collect_count = Collect.count();   // position for this subcircuit
+  if(useCache) {
+    SubNetlist = "";
+    out = &str;
+  }
 
   // TODO: NodeSets have to be put into the subcircuit block.
-  if(!giveNodeNames(stream, countInit, Collect, ErrText, NumPorts)){
+  if(!giveNodeNames(out, countInit, Collect, ErrText, NumPorts)){
     fprintf(stderr, "Error giving NodeNames in createSubNetlist\n");
+    SubNetlist = QString();
     return false;
   }
 
@@ -1791,9 +1928,28 @@ bool Schematic::createSubNetlist(QTextStream *stream, int& countInit,
       else it++;*/
 
   // Emit subcircuit components
-  createSubNetlistPlain(stream, ErrText, NumPorts);
+  createSubNetlistPlain(out, ErrText, NumPorts);
 
   Signals.clear();  // was filled in "giveNodeNames()"
+
+  if(useCache) {
+    str.flush();
+    (*stream) << SubNetlist;
+
+    // NodeSets and includes are numbered and collected per netlist run
+    if(Collect.count() != Collect_count) {
+      SubNetlist = QString();
+      return true;
+    }
+    SubNetlistName = DocName;
+    SubNetlistFiles.clear();
+    for(it = FileList.constBegin(); it != FileList.constEnd(); ++it)
+      if(!FilesBefore.contains(it.key()))
+        SubNetlistFiles.insert(it.key(), it.value());
+    SubNetlistDeps.clear();
+    if(!subcircuitDependencies(this, SubNetlistFiles, SubNetlistDeps))
+      SubNetlist = QString();
+  }
   return true;
 }
 
@@ -1945,11 +2101,12 @@ QString Schematic::createNetlist(QTextStream& stream, int NumPorts)
 
   Signals.clear();  // was filled in "giveNodeNames()"
   FileList.clear();
+  trimSubcircuitCache();
 
   QString s, Time;
   for(Component *pc = DocComps.first(); pc != 0; pc = DocComps.next()) {
     if(isAnalog) {
-      s = pc->getNetlist();
+      pc->getNetlist(stream);
     }
     else {
       if(pc->obsolete_model_hack() == ".Digi" && pc->isActive) {  // simulation component ?
@@ -0,0 +1,400 @@
+/*
+ * sweepsplitter.cpp - run the outermost parameter sweep in slices
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sweepsplitter.h"
+#include "misc.h"
+#include "diagrams/datasetcache.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegExp>
+#include <QSet>
+#include <QTextStream>
+#include <QDebug>
+
+// ---------------------------------------------------------------------
+// "netlist.txt" -> "netlist_3.txt"
+QString SweepSplitter::sliceName(const QString& fileName, int slice)
+{
+  QFileInfo Info(fileName);
+  QString Name = Info.completeBaseName() + "_" + QString::number(slice);
+  if(!Info.suffix().isEmpty())
+    Name += "." + Info.suffix();
+  return Info.dir().filePath(Name);
+}
+
+// ---------------------------------------------------------------------
+// value of a number with optional unit, e.g. "5 Ohm" or "1.2 GHz".
+static bool sweepValue(const QString& s, double& Value)
+{
+  QRegExp Expr("^\\s*[-+]?(\\d+\\.?\\d*|\\.\\d+)([eE][-+]?\\d+)?\\s*[a-zA-Z]*\\s*$");
+  if(!Expr.exactMatch(s))  return false;  // variable or expression
+
+  QString Unit;
+  double Factor;
+  misc::str2num(s, Value, Unit, Factor);
+  Value *= Factor;
+  return true;
+}
+
+// replace the value of property Name in a netlist line.
+static void setProperty(QString& Line, const QString& Name, const QString& Value)
+{
+  QRegExp Expr("\\s" + Name + "=\"[^\"]*\"");
+  Line.replace(Expr, " " + Name + "=\"" + Value + "\"");
+}
+
+/*!
+ * write the slices of netlist next to it, see sliceName(). returns the
+ * number of slices written, with sweepVar set to the swept parameter,
+ * or 0 if the netlist cannot be split. less than the requested number
+ * of slices is written if the sweep has too few points.
+ */
+int SweepSplitter::split(const QString& netlist, int slices,
+                         QStringList& netlists, QString& sweepVar)
+{
+  netlists.clear();
+  if(slices < 2)  return 0;
+
+  QFile file(netlist);
+  if(!file.open(QIODevice::ReadOnly))  return 0;
+  QStringList Lines = QString(file.readAll()).split('\n');
+  file.close();
+
+  // find the sweep that is not swept itself
+  QRegExp SweepExpr("^\\s*\\.SW:(\\S+)\\s");
+  QRegExp PropExpr("(\\w+)=\"([^\"]*)\"");
+  QSet<QString> Swept;
+  QList<int> Sweeps;
+  for(int i=0; i<Lines.size(); i++) {
+    if(SweepExpr.indexIn(Lines.at(i)) < 0)  continue;
+    Sweeps.append(i);
+    int pos = 0;
+    while((pos = PropExpr.indexIn(Lines.at(i), pos)) >= 0) {
+      if(PropExpr.cap(1) == "Sim")
+        Swept.insert(PropExpr.cap(2));
+      pos += PropExpr.matchedLength();
+    }
+  }
+
+  int Outer = -1;
+  QMap<QString, QString> Props;
+  foreach(int i, Sweeps) {
+    SweepExpr.indexIn(Lines.at(i));
+    if(Swept.contains(SweepExpr.cap(1)))  continue;
+    if(Outer >= 0)  return 0;   // several independent sweeps
+    Outer = i;
+  }
+  if(Outer < 0)  return 0;
+
+  int pos = 0;
+  while((pos = PropExpr.indexIn(Lines.at(Outer), pos)) >= 0) {
+    Props.insert(PropExpr.cap(1), PropExpr.cap(2));
+    pos += PropExpr.matchedLength();
+  }
+  sweepVar = Props.value("Param");
+  if(sweepVar.isEmpty())  return 0;
+
+  // the sweep line of every slice
+  QStringList SliceLines;
+  QString Type = Props.value("Type");
+  if((Type == "lin") || (Type == "log")) {
+    double Start, Stop;
+    if(!sweepValue(Props.value("Start"), Start))  return 0;
+    if(!sweepValue(Props.value("Stop"), Stop))  return 0;
+    int Points = int(Props.value("Points").toDouble());
+    if((Type == "log") && ((Start <= 0.0) || (Stop <= 0.0)))  return 0;
+
+    slices = qMin(slices, Points / 2);  // at least two points per slice
+    for(int k=0; k<slices; k++) {
+      int a = k * Points / slices;
+      int b = (k+1) * Points / slices - 1;
+      double va, vb;
+      if(Type == "lin") {
+        va = Start + (Stop-Start) * double(a) / double(Points-1);
+        vb = Start + (Stop-Start) * double(b) / double(Points-1);
+      }
+      else {
+        va = Start * pow(Stop/Start, double(a) / double(Points-1));
+        vb = Start * pow(Stop/Start, double(b) / double(Points-1));
+      }
+      QString Line = Lines.at(Outer);
+      setProperty(Line, "Start", QString::number(va, 'g', 17));
+      setProperty(Line, "Stop", QString::number(vb, 'g', 17));
+      setProperty(Line, "Points", QString::number(b-a+1));
+      SliceLines.append(Line);
+    }
+  }
+  else if(Type == "list") {
+    QString Values = Props.value("Values").trimmed();
+    if(Values.startsWith('['))  Values.remove(0, 1);
+    if(Values.endsWith(']'))  Values.chop(1);
+    QStringList List = Values.split(';');
+
+    slices = qMin(slices, List.size());
+    for(int k=0; k<slices; k++) {
+      int a = k * List.size() / slices;
+      int b = (k+1) * List.size() / slices;
+      QString Line = Lines.at(Outer);
+      setProperty(Line, "Values", "[" + QStringList(List.mid(a, b-a)).join(";") + "]");
+      SliceLines.append(Line);
+    }
+  }
+  if(slices < 2)  return 0;
+
+  for(int k=0; k<slices; k++) {
+    QString Name = sliceName(netlist, k+1);
+    QFile out(Name);
+    if(!out.open(QIODevice::WriteOnly)) {
+      netlists.clear();
+      return 0;
+    }
+    QTextStream stream(&out);
+    for(int i=0; i<Lines.size(); i++) {
+      stream << ((i == Outer) ? SliceLines.at(k) : Lines.at(i));
+      if(i < Lines.size()-1)  stream << '\n';
+    }
+    out.close();
+    netlists.append(Name);
+  }
+
+  return slices;
+}
+
+// ---------------------------------------------------------------------
+// the values of one variable, without the leading line break.
+static QByteArray variableData(CachedDataSet const& Data,
+                               CachedDataSet::Variable const& v)
+{
+  const char *p = Data.data(v);
+  const char *e = Data.data() + v.end;
+  while((p < e) && ((*p == '\n') || (*p == '\r')))  p++;
+  return QByteArray(p, e-p);
+}
+
+/*!
+ * merge the datasets of the slices in the order given into outFile. if
+ * sweepVar is empty, it is the only independent variable whose values
+ * differ between the slices.
+ */
+bool SweepSplitter::merge(const QStringList& datasets, const QString& outFile,
+                          QString sweepVar, QString& error)
+{
+  QList<DataSetPtr> Parts;
+  foreach(QString Name, datasets) {
+    QFile file(Name);
+    if(!file.open(QIODevice::ReadOnly)) {
+      error = QObject::tr("Cannot read dataset \"%1\".").arg(Name);
+      return false;
+    }
+    DataSetPtr d(new CachedDataSet(Name, file.readAll(), QDateTime()));
+    file.close();
+    if(!d->isValid()) {
+      error = QObject::tr("Dataset \"%1\" is incomplete.").arg(Name);
+      return false;
+    }
+    Parts.append(d);
+  }
+  if(Parts.isEmpty())  return false;
+  CachedDataSet const& First = *Parts.first();
+
+  QStringList Names = First.variables();
+  Names.sort();
+  foreach(DataSetPtr d, Parts)
+    foreach(QString Name, Names)
+      if(!d->find(Name)) {
+        error = QObject::tr("Variable \"%1\" missing in \"%2\".")
+                  .arg(Name).arg(d->fileName());
+        return false;
+      }
+
+  if(sweepVar.isEmpty()) {
+    foreach(QString Name, Names) {
+      CachedDataSet::Variable const* v = First.find(Name);
+      if(!v->isIndep)  continue;
+      QByteArray Values = variableData(First, *v);
+      for(int k=1; k<Parts.size(); k++)
+        if(variableData(*Parts.at(k), *Parts.at(k)->find(Name)) != Values) {
+          if(!sweepVar.isEmpty()) {
+            error = QObject::tr("Cannot determine the sweep variable.");
+            return false;
+          }
+          sweepVar = Name;
+          break;
+        }
+    }
+  }
+  CachedDataSet::Variable const* Swept = First.find(sweepVar);
+  if(!Swept || !Swept->isIndep) {
+    error = QObject::tr("Sweep variable \"%1\" not found.").arg(sweepVar);
+    return false;
+  }
+
+  QFile out(outFile);
+  if(!out.open(QIODevice::WriteOnly)) {
+    error = QObject::tr("Cannot write dataset \"%1\".").arg(outFile);
+    return false;
+  }
+
+  // keep the header line of the simulator
+  const char *Header = First.data();
+  const char *HeaderEnd = strchr(Header, '\n');
+  if(HeaderEnd)
+    out.write(Header, HeaderEnd - Header + 1);
+
+  // independent variables first, as qucsator writes them
+  for(int pass=0; pass<2; pass++)
+    foreach(QString Name, Names) {
+      CachedDataSet::Variable const* v = First.find(Name);
+      if(v->isIndep != (pass == 0))  continue;
+
+      bool concat;
+      if(v->isIndep)
+        concat = (Name == sweepVar);
+      else {
+        QStringList Deps = v->dependencies.split(' ', QString::SkipEmptyParts);
+        concat = Deps.contains(sweepVar);
+        if(concat && (Deps.last() != sweepVar)) {  // not the slowest index
+          out.close();
+          out.remove();
+          error = QObject::tr("Cannot merge variable \"%1\".").arg(Name);
+          return false;
+        }
+      }
+
+      QByteArray Values;
+      int Count = 0;
+      if(concat)
+        foreach(DataSetPtr d, Parts) {
+          CachedDataSet::Variable const* p = d->find(Name);
+          Values += variableData(*d, *p);
+          Count += p->dependencies.toInt();
+        }
+      else
+        Values = variableData(First, *v);
+
+      if(v->isIndep)
+        out.write("<indep " + Name.toLatin1() + " " +
+                  QByteArray::number(concat ? Count : v->dependencies.toInt())
+                  + ">\n" + Values + "</indep>\n");
+      else
+        out.write("<dep " + Name.toLatin1() + " " +
+                  v->dependencies.toLatin1() + ">\n" + Values + "</dep>\n");
+    }
+
+  out.close();
+  if(out.error() != QFile::NoError) {
+    error = QObject::tr("Cannot write dataset \"%1\".").arg(outFile);
+    return false;
+  }
+  return true;
+}
+
+
+// ---------------------------------------------------------------------
+SweepRunner::SweepRunner(const QString& program, const QStringList& netlists,
+                         const QStringList& datasets, QObject *parent)
+  : QObject(parent), Program(program), Netlists(netlists),
+    DataSets(datasets), Done(0), Status(0)
+{
+}
+
+SweepRunner::~SweepRunner()
+{
+  foreach(QProcess *p, Processes) {
+    p->disconnect(this);
+    if(p->state() != QProcess::NotRunning) {
+      p->kill();
+      p->waitForFinished(1000);
+    }
+  }
+  qDeleteAll(Processes);
+}
+
+// ---------------------------------------------------------------------
+void SweepRunner::start()
+{
+  for(int i=0; i<Netlists.size(); i++) {
+    QProcess *p = new QProcess();
+    // the progress output is of no use for several processes
+    p->setStandardOutputFile(Netlists.at(i) + ".log");
+    connect(p, SIGNAL(readyReadStandardError()), SLOT(slotReadError()));
+    connect(p, SIGNAL(finished(int, QProcess::ExitStatus)),
+               SLOT(slotFinished(int, QProcess::ExitStatus)));
+    connect(p, SIGNAL(error(QProcess::ProcessError)),
+               SLOT(slotError(QProcess::ProcessError)));
+    Processes.append(p);
+
+    QStringList Arguments;
+    Arguments << "-b" << "-g" << "-i" << Netlists.at(i)
+              << "-o" << DataSets.at(i);
+    qDebug() << "Command :" << Program << Arguments.join(" ");
+    p->start(Program, Arguments);
+  }
+  emit progress(0, Processes.size());
+}
+
+// ---------------------------------------------------------------------
+void SweepRunner::kill()
+{
+  Status = -1;
+  foreach(QProcess *p, Processes)
+    if(p->state() != QProcess::NotRunning)
+      p->kill();
+}
+
+// ---------------------------------------------------------------------
+void SweepRunner::slotReadError()
+{
+  QProcess *p = qobject_cast<QProcess*>(sender());
+  if(p)
+    emit output(QString(p->readAllStandardError()));
+}
+
+// ---------------------------------------------------------------------
+void SweepRunner::slotFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+  if((exitStatus != QProcess::NormalExit) || (exitCode != 0))
+    Status = -1;
+
+  emit progress(++Done, Processes.size());
+  if(Done == Processes.size())
+    emit finished(Status);
+}
+
+// ---------------------------------------------------------------------
+// a process that failed to start never emits finished().
+void SweepRunner::slotError(QProcess::ProcessError error)
+{
+  if(error != QProcess::FailedToStart)  return;
+
+  emit output(tr("ERROR: Cannot start %1\n").arg(Program));
+  slotFinished(-1, QProcess::NormalExit);
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,83 @@
+/*
+ * sweepsplitter.h - run the outermost parameter sweep in slices
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SWEEPSPLITTER_H_
+#define SWEEPSPLITTER_H_ value
+
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+/*!
+ * splits the outermost parameter sweep (.SW) of a qucsator netlist
+ * into slices, each covering a part of the sweep points, and merges
+ * the datasets of the slices back into one.
+ *
+ * a netlist is split only if it has exactly one outermost sweep of type
+ * lin, log or list with plain numbers as start and stop values. in the
+ * merged dataset the values of the sweep variable and of every variable
+ * depending on it are concatenated, everything else is taken from the
+ * first slice.
+ */
+class SweepSplitter {
+public:
+  static int split(const QString& netlist, int slices,
+                   QStringList& netlists, QString& sweepVar);
+  static bool merge(const QStringList& datasets, const QString& outFile,
+                    QString sweepVar, QString& error);
+  static QString sliceName(const QString& fileName, int slice);
+};
+
+/*!
+ * runs one simulator process per slice netlist, all at the same time.
+ * finished() reports 0 if every slice succeeded.
+ */
+class SweepRunner : public QObject {
+Q_OBJECT
+public:
+  SweepRunner(const QString& program, const QStringList& netlists,
+              const QStringList& datasets, QObject *parent=0);
+ ~SweepRunner();
+
+  void start();
+  void kill();
+
+signals:
+  void output(const QString&);
+  void progress(int done, int total);
+  void finished(int status);
+
+private slots:
+  void slotReadError();
+  void slotFinished(int, QProcess::ExitStatus);
+  void slotError(QProcess::ProcessError);
+
+private:
+  QString Program;
+  QStringList Netlists, DataSets;
+  QList<QProcess*> Processes;
+  int Done, Status;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * ConnectivityTests.cpp - Unit tests for the Connectivity class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "connectivity.h"
+#include "node.h"
+#include "schematic.h"
+
+#include <QPlainTextEdit>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QTest>
+
+#include "ConnectivityTests.h"
+
+// netlist sch as the simulation would and return the node names.
+static QStringList netNames(Schematic& sch)
+{
+    QString netlist;
+    QTextStream stream(&netlist);
+    QStringList Collect;
+    QPlainTextEdit ErrText;
+    sch.prepareNetlist(stream, Collect, &ErrText);
+
+    QStringList Names;
+    for(Node *pn = sch.DocNodes.first(); pn != 0; pn = sch.DocNodes.next())
+        Names.append(pn->Name);
+    return Names;
+}
+
+// a schematic of wire chains, every "labeled"th chain carries a label.
+static bool writeChains(QTemporaryFile& file, int chains, int length,
+                        int labeled)
+{
+    if(!file.open())  return false;
+    QTextStream stream(&file);
+    stream << "<Qucs Schematic 0.0.0>\n<Wires>\n";
+    for(int c = 0; c < chains; c++)
+        for(int i = 0; i < length; i++) {
+            stream << "<" << 10*i << " " << 20*c << " "
+                   << 10*(i+1) << " " << 20*c;
+            if((i == 0) && (c % labeled == 0))
+                stream << " \"in" << c << "\" " << 0 << " " << 20*c-10
+                       << " 0 \"\">\n";
+            else
+                stream << " \"\" 0 0 0 \"\">\n";
+        }
+    stream << "</Wires>\n";
+    stream.flush();
+    file.close();
+    return true;
+}
+
+void ConnectivityTests::testUnite() {
+    Node a(0, 0), b(10, 0), c(20, 0), d(30, 0);
+    Connectivity c1;
+    c1.add(&a);
+    c1.add(&b);
+    c1.add(&c);
+    c1.add(&d);
+    QCOMPARE(c1.size(), 4);
+    QCOMPARE(c1.add(&b), 1);
+    QCOMPARE(c1.find(&c), 2);
+
+    c1.unite(&a, &b);
+    c1.unite(&c, &d);
+    QCOMPARE(c1.find(&a), c1.find(&b));
+    QVERIFY(c1.find(&b) != c1.find(&c));
+
+    c1.unite(&b, &d);
+    QCOMPARE(c1.find(&a), c1.find(&c));
+    QCOMPARE(c1.find(&d), c1.find(c1.index(&b)));
+}
+
+void ConnectivityTests::testUnknown() {
+    Node a(0, 0), b(10, 0), c(20, 0), d(30, 0);
+    Connectivity c1;
+    c1.add(&a);
+    QCOMPARE(c1.find(&b), -1);
+    QCOMPARE(c1.index(&c), -1);
+
+    c1.unite(&a, &b);
+    QCOMPARE(c1.size(), 2);
+    QCOMPARE(c1.find(&a), c1.find(&b));
+    QCOMPARE(c1.find(&d), -1);
+}
+
+void ConnectivityTests::testNetNames() {
+    // a labeled and an unlabeled chain of three wires each
+    QTemporaryFile file;
+    QVERIFY(writeChains(file, 2, 3, 2));
+
+    Schematic sch(0, file.fileName());
+    QVERIFY(sch.loadDocument());
+    QCOMPARE(int(sch.DocNodes.count()), 8);
+
+    QStringList Names = netNames(sch);
+    QCOMPARE(Names.count("in0"), 4);
+    QCOMPARE(Names.count("_net0"), 4);
+}
+
+void ConnectivityTests::benchmarkNetNames() {
+    const int chains = 5000, length = 10;
+    QTemporaryFile file;
+    QVERIFY(writeChains(file, chains, length, 2));
+
+    Schematic sch(0, file.fileName());
+    QVERIFY(sch.loadDocument());
+
+    QStringList Names;
+    QBENCHMARK {
+        Names = netNames(sch);
+    }
+    QCOMPARE(Names.size(), chains*(length+1));
+    QCOMPARE(Names.count("in0"), length+1);
+    QCOMPARE(Names.count("_net" + QString::number(chains/2 - 1)), length+1);
+}
+
+QTEST_MAIN(ConnectivityTests)
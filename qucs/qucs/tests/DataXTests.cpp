@@ -0,0 +1,152 @@
+/*
+ * DataXTests.cpp - Unit tests for the searches of DataX
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "diagrams/graph.h"
+
+#include <cmath>
+
+#include <QVector>
+#include <QTest>
+
+#include "DataXTests.h"
+
+// the walks DataX::nearest() and firstNotBelow() replace
+static int linearNearest(const QVector<double>& p, double v)
+{
+  int i = 0;
+  for( ; i < p.size()-1; i++)
+    if(fabs(v-p.at(i)) < fabs(v-p.at(i+1)))  break;
+  return i;
+}
+
+static int linearFirstNotBelow(const QVector<double>& p, double v)
+{
+  int i = 0;
+  for( ; i < p.size(); i++)
+    if(v <= p.at(i))  break;
+  return i;
+}
+
+// the axis owns its points
+static DataX *axis(const QVector<double>& p)
+{
+  double *Points = new double[qMax(p.size(), 1)];
+  for(int i = 0; i < p.size(); i++)
+    Points[i] = p.at(i);
+  return new DataX("x", Points, p.size());
+}
+
+void DataXTests::testNearest() {
+    QVector<double> up;
+    up << 0 << 1 << 1 << 1 << 2 << 4;
+    DataX *x = axis(up);
+    QCOMPARE(x->order(), 1);
+    QCOMPARE(x->nearest(-3), 0);
+    QCOMPARE(x->nearest(0.4), 0);
+    QCOMPARE(x->nearest(0.5), 3);    // tie, the last of equal samples
+    QCOMPARE(x->nearest(1), 3);
+    QCOMPARE(x->nearest(3), 5);      // tie
+    QCOMPARE(x->nearest(9), 5);
+    QCOMPARE(x->nearest(NAN), 5);
+    QCOMPARE(x->nearest(-INFINITY), 5);
+    delete x;
+
+    QVector<double> down;
+    down << 4 << 2 << 2 << 0 << -1;
+    x = axis(down);
+    QCOMPARE(x->order(), -1);
+    QCOMPARE(x->nearest(5), 0);
+    QCOMPARE(x->nearest(3), 2);      // tie
+    QCOMPARE(x->nearest(1.5), 2);
+    QCOMPARE(x->nearest(-0.5), 4);   // tie
+    QCOMPARE(x->nearest(-7), 4);
+    delete x;
+
+    QVector<double> none;
+    none << 0 << 3 << 1 << NAN << 2;
+    x = axis(none);
+    QCOMPARE(x->order(), 0);
+    QCOMPARE(x->nearest(1), 0);      // the first local minimum
+    QCOMPARE(x->nearest(2.5), 1);
+    delete x;
+
+    x = axis(QVector<double>() << 7);
+    QCOMPARE(x->nearest(1), 0);
+    delete x;
+}
+
+void DataXTests::testFirstNotBelow() {
+    QVector<double> up;
+    up << 0 << 1 << 1 << 1 << 2;
+    DataX *x = axis(up);
+    QCOMPARE(x->firstNotBelow(-1), 0);
+    QCOMPARE(x->firstNotBelow(1), 1);
+    QCOMPARE(x->firstNotBelow(1.5), 4);
+    QCOMPARE(x->firstNotBelow(3), 5);
+    QCOMPARE(x->firstNotBelow(NAN), 5);
+    QCOMPARE(x->firstNotBelow(-INFINITY), 0);
+    delete x;
+
+    QVector<double> down;
+    down << 3 << 2 << 1;
+    x = axis(down);
+    QCOMPARE(x->firstNotBelow(2.5), 0);
+    QCOMPARE(x->firstNotBelow(4), 3);
+    delete x;
+
+    x = axis(QVector<double>());
+    QCOMPARE(x->firstNotBelow(0), 0);
+    QCOMPARE(x->nearest(0), 0);
+    delete x;
+}
+
+// ascending, descending and unordered axes full of equal samples,
+// infinities and NaN give the same sample as the walks
+void DataXTests::testRandom() {
+    const double Special[] = { INFINITY, -INFINITY, NAN, 0, 1 };
+    qsrand(1);
+    for(int n = 0; n < 20000; n++) {
+        QVector<double> p;
+        int count = qrand() % 40;
+        int Sorted = qrand() % 3;   // NaN only on unordered axes
+        for(int i = 0; i < count; i++) {
+            double v = Special[qrand() % 5];
+            if(qrand() % 12 || (Sorted && std::isnan(v)))
+                v = 0.5 * (qrand() % 7) - 1;
+            p << v;
+        }
+        if(Sorted == 1)  qSort(p);
+        else if(Sorted == 2)  qSort(p.begin(), p.end(), qGreater<double>());
+
+        DataX *x = axis(p);
+        for(int i = 0; i < 10; i++) {
+            double v = qrand() % 8 ? 0.25 * (qrand() % 13) - 1.5
+                                   : Special[qrand() % 5];
+            QCOMPARE(x->nearest(v), linearNearest(p, v));
+            QCOMPARE(x->firstNotBelow(v), linearFirstNotBelow(p, v));
+        }
+        delete x;
+    }
+}
+
+QTEST_MAIN(DataXTests)
@@ -0,0 +1,142 @@
+/*
+ * DiagramTests.cpp - Unit tests for the screen points of diagrams
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "diagrams/rectdiagram.h"
+
+#include <math.h>
+
+#include <QMap>
+#include <QPointF>
+#include <QTest>
+
+#include "DiagramTests.h"
+
+// a graph of n samples of a sine with a fast ripple on top
+static Graph *makeGraph(Diagram *d, int n)
+{
+  Graph *g = new Graph(d, "y");
+  double *x = new double[n];
+  g->cPointsY = new double[2*n];
+  for(int i = 0; i < n; i++) {
+    x[i] = i;
+    g->cPointsY[2*i]   = sin(6.0*i/n) + 0.2*sin(1.7*i) * cos(0.013*i);
+    g->cPointsY[2*i+1] = 0.0;
+  }
+  g->mutable_axes().append(new DataX("x", x, n));
+  g->countY = 1;
+  d->Graphs.append(g);
+  d->recalcGraphData();
+  return g;
+}
+
+// the screen points calcData() made
+static QVector<QPointF> screenPoints(Graph *g)
+{
+  QVector<QPointF> v;
+  for(Graph::iterator p = g->begin(); !p->isGraphEnd(); ++p)
+    if(p->isPt())
+      v.append(QPointF(p->getScrX(), p->getScrY()));
+  return v;
+}
+
+// the screen points of all samples, as calcData() made them before
+// dense graphs were thinned out
+static QVector<QPointF> allPoints(Diagram *d, Graph *g)
+{
+  QVector<QPointF> v;
+  double *px = g->axis(0)->Points, *py = g->cPointsY;
+  for(int i = 0; i < g->axis(0)->count; i++) {
+    float fx, fy;
+    d->calcCoordinate(px+i, py+2*i, 0, &fx, &fy, &d->yAxis);
+    v.append(QPointF(fx, fy));
+  }
+  return v;
+}
+
+// lowest and highest point of each pixel column
+static QMap<int, QPointF> envelope(const QVector<QPointF>& v)
+{
+  QMap<int, QPointF> e;
+  foreach(QPointF p, v) {
+    int Column = int(floor(p.x()));
+    if(!e.contains(Column))
+      e.insert(Column, QPointF(p.y(), p.y()));
+    QPointF& r = e[Column];
+    if(p.y() < r.x())  r.setX(p.y());
+    if(p.y() > r.y())  r.setY(p.y());
+  }
+  return e;
+}
+
+void DiagramTests::testSparse() {
+    RectDiagram d;
+    Graph *g = makeGraph(&d, d.x2);
+
+    QVector<QPointF> all = allPoints(&d, g);
+    QCOMPARE(screenPoints(g), all);
+    delete g;
+}
+
+void DiagramTests::testDecimate() {
+    RectDiagram d;
+    int n = 200*DECIMATION_COLUMNS*d.x2;
+    Graph *g = makeGraph(&d, n);
+
+    QVector<QPointF> all = allPoints(&d, g);
+    QVector<QPointF> kept = screenPoints(g);
+    QVERIFY(kept.size() <= 4*DECIMATION_COLUMNS*(d.x2+2));
+    QVERIFY(kept.size() > d.x2);
+
+    // the kept points are samples, in their order, with the same ends
+    QCOMPARE(kept.first(), all.first());
+    QCOMPARE(kept.last(), all.last());
+    int i = 0;
+    foreach(QPointF p, kept) {
+        while((i < all.size()) && (all.at(i) != p))  i++;
+        QVERIFY(i < all.size());
+    }
+
+    // and span the same pixels
+    QCOMPARE(envelope(kept), envelope(all));
+    delete g;
+}
+
+void DiagramTests::benchmarkDecimate_data() {
+    QTest::addColumn<int>("samples");
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+// recalculating the screen points of one graph, samples against time
+void DiagramTests::benchmarkDecimate() {
+    QFETCH(int, samples);
+    RectDiagram d;
+    Graph *g = makeGraph(&d, samples);
+    QBENCHMARK {
+        d.recalcGraphData();
+    }
+    delete g;
+}
+
+QTEST_MAIN(DiagramTests)
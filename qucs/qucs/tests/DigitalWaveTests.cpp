@@ -0,0 +1,83 @@
+/*
+ * DigitalWaveTests.cpp - Unit tests for the DigitalWave class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "diagrams/digitalwave.h"
+
+#include <string.h>
+
+#include <QTest>
+
+#include "DigitalWaveTests.h"
+
+static bool append(DigitalWave& wave, const char *v)
+{
+  return wave.append(v, v + strlen(v));
+}
+
+void DigitalWaveTests::testAppend() {
+    DigitalWave wave;
+    QVERIFY(append(wave, "100ZX0"));
+    QVERIFY(append(wave, "0z1x11"));
+    QVERIFY(!append(wave, "101"));     // of other width
+    QVERIFY(!append(wave, ""));
+    wave.squeeze();
+
+    QCOMPARE(wave.count(), 2);
+    QCOMPARE(wave.width(), 6);
+    QCOMPARE(wave.vector(0), QString("100ZX0"));
+    QCOMPARE(wave.vector(1), QString("0Z1X11"));
+    QCOMPARE(wave.level(0, 3), DigitalWave::HighZ);
+    QCOMPARE(wave.level(1, 3), DigitalWave::Unknown);
+    QCOMPARE(wave.bitChar(1, 2), '1');
+}
+
+// long stable stretches are stored once
+void DigitalWaveTests::testRuns() {
+    DigitalWave wave;
+    for(int i = 0; i < 1000; i++)
+      QVERIFY(append(wave, (i / 100) & 1 ? "1010" : "0Z01"));
+    wave.squeeze();
+
+    QVERIFY(wave.isCompressed());
+    QCOMPARE(wave.countRuns(), 10);
+    QCOMPARE(wave.count(), 1000);
+    QCOMPARE(wave.vector(0), QString("0Z01"));
+    QCOMPARE(wave.vector(99), QString("0Z01"));
+    QCOMPARE(wave.vector(100), QString("1010"));
+    QCOMPARE(wave.vector(999), QString("1010"));
+}
+
+// a bit toggling at every sample is stored sample by sample
+void DigitalWaveTests::testFlat() {
+    DigitalWave wave;
+    for(int i = 0; i < 1000; i++)
+      QVERIFY(append(wave, (i & 1) ? "1" : "0"));
+    wave.squeeze();
+
+    QVERIFY(!wave.isCompressed());
+    QCOMPARE(wave.count(), 1000);
+    for(int i = 0; i < 1000; i++)
+      QCOMPARE(wave.level(i, 0), (i & 1) ? DigitalWave::High : DigitalWave::Low);
+}
+
+QTEST_MAIN(DigitalWaveTests)
@@ -0,0 +1,153 @@
+/*
+ * HiddenLinesTests.cpp - Unit tests for the HiddenLines class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "diagrams/hiddenlines.h"
+
+#include <math.h>
+
+#include <QTest>
+
+#include "HiddenLinesTests.h"
+
+// appends a grid of n x n points with its cross grid and its polygons,
+// laid out like Rect3DDiagram does: a wavy surface seen from above.
+static void makeSurface(int n, int width, int height,
+                        QVector<tPoint3D>& points, HiddenLines& hidden)
+{
+  int First = points.size();
+  QVector<float> z(n*n);
+  for(int r = 0; r < n; r++)
+    for(int c = 0; c < n; c++) {
+      double u = c / double(n-1), v = r / double(n-1);
+      double h = sin(6.0*u + 3.0*v) * cos(5.0*v);
+      tPoint3D p;
+      p.x = int(10 + u*(width-40) + v*20);
+      p.y = int(height - 10 - v*height*0.4 - (h+1.0)*height*0.2);
+      p.No = points.size();
+      p.done = (c == n-1) ? 8 : 0;
+      points.append(p);
+      z[r*n + c] = float(v + 0.1*h);
+    }
+
+  int Cross = points.size();
+  for(int c = 0; c < n; c++)
+    for(int r = 0; r < n; r++) {
+      tPoint3D p = points.at(First + r*n + c);
+      p.No = points.size();
+      p.done = (r == n-1) ? 8 : 0;
+      points.append(p);
+    }
+
+  for(int r = 0; r < n-1; r++)
+    for(int c = 0; c < n-1; c++) {
+      int g = r*n + c;
+      hidden.addPolygon(z[g] + z[g+1] + z[g+n] + z[g+n+1],
+                        First + g, First + g + n,
+                        Cross + c*n + r, Cross + (c+1)*n + r);
+    }
+}
+
+// a square of 2 x 2 points, given as its corners
+static void makeSquare(int x1, int y1, int x2, int y2, float z,
+                       QVector<tPoint3D>& points, HiddenLines& hidden)
+{
+  int First = points.size();
+  int X[4] = { x1, x2, x1, x2 }, Y[4] = { y1, y1, y2, y2 };
+  int Order[8] = { 0, 1, 2, 3, 0, 2, 1, 3 };  // grid, then cross grid
+  for(int i = 0; i < 8; i++) {
+    tPoint3D p = { X[Order[i]], Y[Order[i]], points.size(), (i & 1) ? 8 : 0 };
+    points.append(p);
+  }
+  hidden.addPolygon(z, First, First + 2, First + 4, First + 6);
+}
+
+void HiddenLinesTests::testHide() {
+    QVector<tPoint3D> points;
+    HiddenLines hidden(100, 100);
+    makeSquare(10, 10, 50, 50, 10.0f, points, hidden);  // near
+    makeSquare(0, 28, 60, 32, 1.0f, points, hidden);    // far, behind it
+    hidden.run(points);
+
+    // the upper edge of the far square is cut where the near one
+    // covers it
+    QCOMPARE(points.size(), 16 + 4);
+    QCOMPARE(points.at(8).x, 0);
+    QCOMPARE(points.at(8).done & 4, 0);
+    QCOMPARE(points.at(9).x, 10);
+    QCOMPARE(points.at(9).y, 28);
+    QCOMPARE(points.at(9).done, 4);
+    QCOMPARE(points.at(10).x, 51);
+    QCOMPARE(points.at(10).done, 0);
+    QCOMPARE(points.at(11).x, 60);
+
+    QVERIFY(hidden.isHidden(30, 30));
+    QVERIFY(!hidden.isHidden(55, 60));
+    QVERIFY(!hidden.isHidden(-1, 30));
+
+    QVector<tPoint3D> cut;
+    hidden.cutLine(0, 20, 99, 20, cut);
+    QCOMPARE(cut.size(), 4);
+    QCOMPARE(cut.at(1).x, 10);
+    QCOMPARE(cut.at(1).done, 4);
+    QCOMPARE(cut.at(2).x, 51);
+    QCOMPARE(cut.at(3).x, 99);
+}
+
+// the result must not depend on the number of strips
+void HiddenLinesTests::testStrips() {
+    QVector<tPoint3D> points1, points4;
+    HiddenLines hidden1(400, 300), hidden4(400, 300);
+    makeSurface(60, 400, 300, points1, hidden1);
+    makeSurface(60, 400, 300, points4, hidden4);
+    hidden1.run(points1, 1);
+    hidden4.run(points4, 4);
+
+    QVERIFY(points1.size() > 2*60*60);  // something is hidden
+    QCOMPARE(points4.size(), points1.size());
+    for(int i = 0; i < points1.size(); i++) {
+        QCOMPARE(points4.at(i).x, points1.at(i).x);
+        QCOMPARE(points4.at(i).y, points1.at(i).y);
+        QCOMPARE(points4.at(i).done, points1.at(i).done);
+    }
+}
+
+void HiddenLinesTests::benchmarkSurface_data() {
+    QTest::addColumn<int>("grid");
+    QTest::newRow("50x50") << 50;
+    QTest::newRow("100x100") << 100;
+    QTest::newRow("200x200") << 200;
+    QTest::newRow("500x500") << 500;
+}
+
+// a redraw of a surface plot, grid size against time
+void HiddenLinesTests::benchmarkSurface() {
+    QFETCH(int, grid);
+    QBENCHMARK {
+        QVector<tPoint3D> points;
+        HiddenLines hidden(600, 400);
+        makeSurface(grid, 600, 400, points, hidden);
+        hidden.run(points);
+    }
+}
+
+QTEST_MAIN(HiddenLinesTests)
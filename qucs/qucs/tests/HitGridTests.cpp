@@ -0,0 +1,137 @@
+/*
+ * HitGridTests.cpp - Unit tests for the HitGrid class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "diagrams/hitgrid.h"
+
+#include <QVector>
+#include <QTest>
+
+#include "HitGridTests.h"
+
+struct Box {
+  int x1, y1, x2, y2;
+};
+
+static Box box(int x1, int y1, int x2, int y2)
+{
+  Box b = { x1, y1, x2, y2 };
+  return b;
+}
+
+// the boxes containing (x,y), as found by checking all of them in turn
+static QVector<int> linearHits(const QVector<Box>& boxes, int x, int y)
+{
+  QVector<int> ids;
+  for(int i = 0; i < boxes.size(); i++) {
+    const Box& b = boxes.at(i);
+    if((x >= qMin(b.x1, b.x2)) && (x <= qMax(b.x1, b.x2)) &&
+       (y >= qMin(b.y1, b.y2)) && (y <= qMax(b.y1, b.y2)))
+      ids.append(i);
+  }
+  return ids;
+}
+
+// the candidates of the grid that really contain (x,y)
+static QVector<int> gridHits(const HitGrid& grid, const QVector<Box>& boxes,
+                             int x, int y)
+{
+  QVector<int> ids, all;
+  grid.candidates(x, y, all);
+  for(int i = 0; i < all.size(); i++) {
+    if(i > 0 && all.at(i-1) >= all.at(i))
+      return QVector<int>() << -1;   // not in the order of adding
+    const Box& b = boxes.at(all.at(i));
+    if((x >= qMin(b.x1, b.x2)) && (x <= qMax(b.x1, b.x2)) &&
+       (y >= qMin(b.y1, b.y2)) && (y <= qMax(b.y1, b.y2)))
+      ids.append(all.at(i));
+  }
+  return ids;
+}
+
+void HitGridTests::testEmpty() {
+    HitGrid grid;
+    QVector<int> ids;
+    grid.candidates(0, 0, ids);
+    QVERIFY(ids.isEmpty());
+
+    grid.build();
+    QVERIFY(grid.isBuilt());
+    grid.candidates(10, 10, ids);
+    QVERIFY(ids.isEmpty());
+}
+
+void HitGridTests::testCandidates() {
+    QVector<Box> boxes;
+    boxes << box(0, 0, 10, 10)
+          << box(10, 10, 0, 0)        // same, corners swapped
+          << box(5, 5, 5, 5)          // a single point
+          << box(-5000, 0, 5000, 0)   // covers very many cells
+          << box(100, 100, 120, 140);
+
+    HitGrid grid;
+    foreach(const Box& b, boxes)
+      grid.add(b.x1, b.y1, b.x2, b.y2);
+    QCOMPARE(grid.countBoxes(), boxes.size());
+    QVERIFY(!grid.isBuilt());
+    grid.build();
+
+    QCOMPARE(gridHits(grid, boxes, 5, 5), QVector<int>() << 0 << 1 << 2);
+    QCOMPARE(gridHits(grid, boxes, 0, 0), QVector<int>() << 0 << 1 << 3);
+    QCOMPARE(gridHits(grid, boxes, 4000, 0), QVector<int>() << 3);
+    QCOMPARE(gridHits(grid, boxes, 120, 140), QVector<int>() << 4);
+    QCOMPARE(gridHits(grid, boxes, 121, 140), QVector<int>());
+    QCOMPARE(gridHits(grid, boxes, -9000, 9000), QVector<int>());
+
+    grid.add(0, 0, 1, 1);
+    QVERIFY(!grid.isBuilt());
+    grid.clear();
+    QCOMPARE(grid.countBoxes(), 0);
+}
+
+// the same boxes as the linear walk, in the same order, also for points
+// outside the grid and boxes far outside the screen
+void HitGridTests::testRandom() {
+    qsrand(1);
+    for(int n = 0; n < 50; n++) {
+        QVector<Box> boxes;
+        int count = qrand() % 300;
+        for(int i = 0; i < count; i++) {
+            int x = qrand() % 2000 - 500, y = qrand() % 2000 - 500;
+            int w = qrand() % 8 ? qrand() % 60 : qrand() % 100000 - 50000;
+            int h = qrand() % 8 ? qrand() % 60 : qrand() % 100000 - 50000;
+            boxes << box(x, y, x + w, y + h);
+        }
+
+        HitGrid grid;
+        foreach(const Box& b, boxes)
+            grid.add(b.x1, b.y1, b.x2, b.y2);
+        grid.build();
+
+        for(int i = 0; i < 500; i++) {
+            int x = qrand() % 4000 - 1500, y = qrand() % 4000 - 1500;
+            QCOMPARE(gridHits(grid, boxes, x, y), linearHits(boxes, x, y));
+        }
+    }
+}
+
+QTEST_MAIN(HitGridTests)
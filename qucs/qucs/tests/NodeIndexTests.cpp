@@ -0,0 +1,161 @@
+/*
+ * NodeIndexTests.cpp - Unit tests for the NodeIndex class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nodeindex.h"
+#include "node.h"
+#include "schematic.h"
+
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QTest>
+
+#include "NodeIndexTests.h"
+
+// the walks through the node list the index replaces
+static Node* findLinear(Q3PtrList<Node>& nodes, int x, int y)
+{
+    for(Node *pn = nodes.first(); pn != 0; pn = nodes.next())
+        if(pn->cx == x && pn->cy == y)
+            return pn;
+    return 0;
+}
+
+static Node* selectedLinear(Q3PtrList<Node>& nodes, int x, int y)
+{
+    for(Node *pn = nodes.first(); pn != 0; pn = nodes.next())
+        if(pn->getSelected(x, y))
+            return pn;
+    return 0;
+}
+
+void NodeIndexTests::testFind() {
+    Node a(0, 0), b(10, 0), c(0, 0), d(20, 5), e(10, 0);
+    Q3PtrList<Node> nodes;
+    nodes.append(&a);
+    nodes.append(&b);
+    nodes.append(&c);   // same position as a
+
+    NodeIndex index;
+    QVERIFY(index.find(0, 0) == 0);   // not built
+    index.build(&nodes);
+    QVERIFY(index.isBuilt());
+    QCOMPARE(index.size(), 3);
+    QVERIFY(index.find(0, 0) == &a);
+    QVERIFY(index.find(10, 0) == &b);
+    QVERIFY(index.find(5, 5) == 0);
+
+    nodes.append(&d);
+    index.insert(&d);
+    nodes.append(&e);   // behind b
+    index.insert(&e);
+    QVERIFY(index.find(20, 5) == &d);
+    QVERIFY(index.find(10, 0) == &b);
+
+    index.remove(&a);
+    nodes.removeRef(&a);
+    QVERIFY(index.find(0, 0) == &c);
+    index.remove(&b);
+    nodes.removeRef(&b);
+    QVERIFY(index.find(10, 0) == &e);
+    index.remove(&b);   // not indexed anymore
+    QCOMPARE(index.size(), 3);
+
+    index.clear();
+    QVERIFY(!index.isBuilt());
+    QVERIFY(index.find(0, 0) == 0);
+}
+
+// clicks near several nodes hit the first one of the list, as before
+void NodeIndexTests::testSelected() {
+    Q3PtrList<Node> nodes;
+    nodes.setAutoDelete(true);
+    qsrand(1);
+    for(int i = 0; i < 2000; i++)
+        nodes.append(new Node(qrand() % 200, qrand() % 200));
+
+    NodeIndex index;
+    index.build(&nodes);
+    for(int i = 0; i < 5000; i++) {
+        int x = qrand() % 220 - 10, y = qrand() % 220 - 10;
+        QVERIFY(index.selected(x, y) == selectedLinear(nodes, x, y));
+        QVERIFY(index.find(x, y) == findLinear(nodes, x, y));
+    }
+
+    Node *pn = nodes.at(0);
+    QVERIFY(index.selected(pn->cx + 5, pn->cy - 5) != 0);
+    QVERIFY(index.selected(pn->cx + 6, pn->cy) != pn);
+}
+
+// the nodes of a large schematic, on a grid of 10 pixels
+void NodeIndexTests::benchmarkLarge() {
+    const int n = 50000;
+    Q3PtrList<Node> nodes;
+    nodes.setAutoDelete(true);
+    for(int i = 0; i < n; i++)
+        nodes.append(new Node(10*(i % 250), 10*(i / 250)));
+
+    NodeIndex index;
+    int found = 0;
+    QBENCHMARK {
+        index.build(&nodes);
+        found = 0;
+        for(int i = 0; i < n; i++)
+            if(index.find(10*(i % 250), 10*(i / 250)))  found++;
+        for(int i = 0; i < n; i++)
+            if(index.selected(10*(i % 250) + 3, 10*(i / 250) - 4))  found++;
+    }
+    QCOMPARE(found, 2*n);
+
+    for(int i = 0; i < n; i += 997) {
+        int x = 10*(i % 250) + 3, y = 10*(i / 250) - 4;
+        QVERIFY(index.selected(x, y) == selectedLinear(nodes, x, y));
+    }
+}
+
+// loading a schematic of 50000 wires, 250 rows of 200 wires each. every
+// wire end looks up the node it shares with its neighbour.
+void NodeIndexTests::benchmarkLoad() {
+    const int rows = 250, columns = 200;
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QTextStream stream(&file);
+    stream << "<Qucs Schematic 0.0.0>\n<Wires>\n";
+    for(int r = 0; r < rows; r++)
+        for(int c = 0; c < columns; c++)
+            stream << "<" << 10*c << " " << 20*r << " " << 10*(c+1) << " "
+                   << 20*r << " \"\" 0 0 0 \"\">\n";
+    stream << "</Wires>\n";
+    stream.flush();
+    file.close();
+
+    int nodes = 0, wires = 0;
+    QBENCHMARK {
+        Schematic sch(0, file.fileName());
+        QVERIFY(sch.loadDocument());
+        nodes = sch.DocNodes.count();
+        wires = sch.DocWires.count();
+    }
+    QCOMPARE(wires, rows*columns);
+    QCOMPARE(nodes, rows*(columns+1));
+}
+
+QTEST_MAIN(NodeIndexTests)
@@ -0,0 +1,80 @@
+/*
+ * UndoStateTests.cpp - Unit tests for the UndoState class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "schematic.h"
+
+#include <QVector>
+#include <QTest>
+
+#include "UndoStateTests.h"
+
+// a document of "n" lines, line "changed" differing from the others
+static QString document(char op, int n, int changed)
+{
+  QString s = QChar(op);
+  s += " \n";
+  for(int i = 0; i < n; i++)
+    s += (i == changed) ? QString("<changed %1>\n").arg(n)
+                        : QString("<line %1>\n").arg(i);
+  return s;
+}
+
+// every state gives back its text, however many states follow it
+void UndoStateTests::testText() {
+    QVector<UndoState*> stack;
+    QStringList texts;
+    for(int i = 0; i < 20; i++) {
+        texts << document(i % 2 ? 'm' : 'c', 50 + i, i);
+        stack.append(new UndoState(texts.last(),
+                                   stack.isEmpty() ? 0 : stack.last()));
+    }
+    texts[0][1] = 'i';
+    stack.first()->setUnchanged(true);
+
+    for(int i = 0; i < stack.size(); i++)
+        QCOMPARE(stack.at(i)->text(), texts.at(i));
+    QCOMPARE(stack.at(3)->op(), QChar('m'));
+    QVERIFY(stack.first()->isUnchanged());
+    qDeleteAll(stack);
+}
+
+// like a second marker move replacing the first one: the predecessor is
+// expanded before the last state is deleted
+void UndoStateTests::testDropLast() {
+    QString a = document('c', 10, 1), b = document('m', 10, 2);
+    QString c = document('m', 10, 3);
+    UndoState *sa = new UndoState(a);
+    UndoState *sb = new UndoState(b, sa);
+
+    sa->expand();
+    delete sb;
+    QCOMPARE(sa->text(), a);
+
+    UndoState *sc = new UndoState(c, sa);
+    QCOMPARE(sa->text(), a);
+    QCOMPARE(sc->text(), c);
+    delete sc;
+    delete sa;
+}
+
+QTEST_MAIN(UndoStateTests)
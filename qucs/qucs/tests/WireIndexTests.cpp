@@ -0,0 +1,174 @@
+/*
+ * WireIndexTests.cpp - Unit tests for the NodeIndex class
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "wireindex.h"
+#include "wire.h"
+
+#include <QTest>
+
+#include "WireIndexTests.h"
+
+// the walks through the wire list the index replaces
+static Wire* findLinear(Q3PtrList<Wire>& wires, int x, int y)
+{
+    for(Wire *pw = wires.first(); pw != 0; pw = wires.next()) {
+        if(pw->x1 == x) {
+            if(pw->y1 > y) continue;
+            if(pw->y2 < y) continue;
+        }
+        else if(pw->y1 == y) {
+            if(pw->x1 > x) continue;
+            if(pw->x2 < x) continue;
+        }
+        else continue;
+        return pw;
+    }
+    return 0;
+}
+
+static Wire* selectedLinear(Q3PtrList<Wire>& wires, int x, int y)
+{
+    for(Wire *pw = wires.first(); pw != 0; pw = wires.next())
+        if(pw->getSelected(x, y))
+            return pw;
+    return 0;
+}
+
+static Wire* randomWire()
+{
+    int x = 10*(qrand() % 30), y = 10*(qrand() % 30), l = 10*(qrand() % 8);
+    if(qrand() & 1)
+        return new Wire(x, y, x+l, y);
+    return new Wire(x, y, x, y+l);
+}
+
+void WireIndexTests::testFind() {
+    Wire a(0, 0, 50, 0), b(20, 0, 20, 40), c(0, 0, 30, 0), d(60, 10, 60, 10);
+    Q3PtrList<Wire> wires;
+    wires.append(&a);
+    wires.append(&b);
+    wires.append(&c);   // on top of a
+
+    WireIndex index;
+    QVERIFY(index.find(0, 0) == 0);   // not built
+    index.build(&wires);
+    QVERIFY(index.isBuilt());
+    QCOMPARE(index.size(), 3);
+    QVERIFY(index.find(10, 0) == &a);
+    QVERIFY(index.find(20, 0) == &a);   // crossing b, a comes first
+    QVERIFY(index.find(20, 40) == &b);
+    QVERIFY(index.find(50, 0) == &a);   // ends included
+    QVERIFY(index.find(51, 0) == 0);
+    QVERIFY(index.selected(25, 5) == &a);
+    QVERIFY(index.selected(25, 6) == &b);
+
+    wires.append(&d);
+    index.insert(&d);
+    QVERIFY(index.find(60, 10) == &d);
+
+    index.remove(&a);
+    wires.removeRef(&a);
+    QVERIFY(index.find(20, 0) == &b);
+    QVERIFY(index.find(10, 0) == &c);
+
+    // wires may change their length while listed
+    c.x2 = 10;
+    QVERIFY(index.find(20, 0) == &b);
+    QVERIFY(index.find(25, 0) == 0);
+    b.y2 = b.y1;   // shortened to a point
+    index.remove(&b);
+    wires.removeRef(&b);
+    QCOMPARE(index.size(), 2);
+
+    index.clear();
+    QVERIFY(!index.isBuilt());
+    QVERIFY(index.find(10, 0) == 0);
+}
+
+// inserting, removing and resizing wires, the index must find what the
+// walks find
+void WireIndexTests::testRandom() {
+    Q3PtrList<Wire> wires;
+    wires.setAutoDelete(true);
+    qsrand(1);
+    for(int i = 0; i < 300; i++)
+        wires.append(randomWire());
+
+    WireIndex index;
+    index.build(&wires);
+    for(int i = 0; i < 5000; i++) {
+        int op = qrand() % 3;
+        if(op == 0) {
+            Wire *pw = randomWire();
+            wires.append(pw);
+            index.insert(pw);
+        }
+        else if((op == 1) && !wires.isEmpty()) {
+            Wire *pw = wires.at(qrand() % wires.count());
+            index.remove(pw);
+            wires.removeRef(pw);
+        }
+        else if(!wires.isEmpty()) {
+            Wire *pw = wires.at(qrand() % wires.count());
+            int d = 10*(qrand() % 5 - 2);   // no wire turns into a point
+            if(pw->x1 < pw->x2)
+                pw->x2 = qMax(pw->x1 + 10, pw->x2 + d);
+            else if(pw->y1 < pw->y2)
+                pw->y2 = qMax(pw->y1 + 10, pw->y2 + d);
+        }
+
+        int x = qrand() % 320 - 10, y = qrand() % 320 - 10;
+        QVERIFY(index.find(x, y) == findLinear(wires, x, y));
+        QVERIFY(index.selected(x, y) == selectedLinear(wires, x, y));
+    }
+    QCOMPARE(index.size(), int(wires.count()));
+}
+
+// the wires of a large schematic, rows of short wires on a 10 pixel grid
+void WireIndexTests::benchmarkLarge() {
+    const int n = 50000;
+    Q3PtrList<Wire> wires;
+    wires.setAutoDelete(true);
+    for(int i = 0; i < n; i++) {
+        int x = 20*(i % 250), y = 10*(i / 250);
+        wires.append(new Wire(x, y, x+10, y));
+    }
+
+    WireIndex index;
+    int found = 0;
+    QBENCHMARK {
+        index.build(&wires);
+        found = 0;
+        for(int i = 0; i < n; i++)
+            if(index.find(20*(i % 250) + 5, 10*(i / 250)))  found++;
+        for(int i = 0; i < n; i++)
+            if(index.selected(20*(i % 250) + 13, 10*(i / 250) + 4))  found++;
+    }
+    QCOMPARE(found, 2*n);
+
+    for(int i = 0; i < n; i += 997) {
+        int x = 20*(i % 250) + 13, y = 10*(i / 250) + 4;
+        QVERIFY(index.selected(x, y) == selectedLinear(wires, x, y));
+    }
+}
+
+QTEST_MAIN(WireIndexTests)
@@ -0,0 +1,138 @@
+/*
+ * wireindex.cpp - finding the wires of a schematic by position
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "wireindex.h"
+#include "wire.h"
+
+void WireIndex::clear()
+{
+  Horizontal.clear();
+  Vertical.clear();
+  Built = false;
+  Count = 0;
+}
+
+// ---------------------------------------------------------------------
+// indexes all wires of the list, in the order of the list.
+void WireIndex::build(Q3PtrList<Wire> *Wires)
+{
+  clear();
+  Built = true;
+  Q3PtrListIterator<Wire> it(*Wires);
+  for(Wire *pw; (pw = it.current()) != 0; ++it)
+    insert(pw);
+}
+
+// ---------------------------------------------------------------------
+// a wire appended to the list. does nothing before build().
+void WireIndex::insert(Wire *pw)
+{
+  if(!Built)  return;
+  Entry e;
+  e.pw = pw;
+  e.Order = Count++;
+  if(pw->isHorizontal())
+    Horizontal.insert(pw->y1, e);
+  else
+    Vertical.insert(pw->x1, e);
+}
+
+// ---------------------------------------------------------------------
+bool WireIndex::remove(Line& l, int key, Wire *pw)
+{
+  Line::iterator it = l.find(key);
+  for( ; (it != l.end()) && (it.key() == key); ++it)
+    if(it.value().pw == pw) {
+      l.erase(it);
+      return true;
+    }
+  return false;
+}
+
+// ---------------------------------------------------------------------
+// a wire about to be removed from the list. unknown wires are ignored.
+// both lines are searched, a wire shortened to a single point may not
+// tell its direction anymore.
+void WireIndex::remove(Wire *pw)
+{
+  if(!remove(Horizontal, pw->y1, pw))
+    remove(Vertical, pw->x1, pw);
+}
+
+// ---------------------------------------------------------------------
+// updates "First" with the earliest wire of the lines "from" to "to"
+// that passes "test".
+void WireIndex::first(Line const& l, int from, int to,
+                      bool (*test)(Wire*, int, int), int x, int y,
+                      const Entry*& First)
+{
+  Line::const_iterator it = l.lowerBound(from);
+  for( ; (it != l.constEnd()) && (it.key() <= to); ++it)
+    if(!First || (it.value().Order < First->Order))
+      if(test(it.value().pw, x, y))
+        First = &it.value();
+}
+
+// ---------------------------------------------------------------------
+// the test of Schematic::insertNode() whether a new node splits a wire
+static bool liesOn(Wire *pw, int x, int y)
+{
+  if(pw->x1 == x) {
+    if(pw->y1 > y) return false;
+    if(pw->y2 < y) return false;
+  }
+  else if(pw->y1 == y) {
+    if(pw->x1 > x) return false;
+    if(pw->x2 < x) return false;
+  }
+  else return false;
+  return true;
+}
+
+// ---------------------------------------------------------------------
+// the first wire x/y lies on, ends included. 0 if there is none.
+Wire* WireIndex::find(int x, int y) const
+{
+  const Entry *First = 0;
+  first(Horizontal, y, y, liesOn, x, y, First);
+  first(Vertical, x, x, liesOn, x, y, First);
+  return First ? First->pw : 0;
+}
+
+// ---------------------------------------------------------------------
+static bool hits(Wire *pw, int x, int y)
+{
+  return pw->getSelected(x, y);
+}
+
+// ---------------------------------------------------------------------
+// the first wire hit by a click at x/y (see Wire::getSelected()), 0 if
+// there is none.
+Wire* WireIndex::selected(int x, int y) const
+{
+  const Entry *First = 0;
+  first(Horizontal, y-5, y+5, hits, x, y, First);
+  first(Vertical, x-5, x+5, hits, x, y, First);
+  return First ? First->pw : 0;
+}
+
+// vim:ts=8:sw=2:et
@@ -0,0 +1,71 @@
+/*
+ * wireindex.h - finding the wires of a schematic by position
+ *
+ * Copyright (C) 2017, Qucs team (see AUTHORS file)
+ *
+ * This file is part of Qucs
+ *
+ * Qucs is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Qucs.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef WIREINDEX_H_
+#define WIREINDEX_H_ value
+
+#include <QMap>
+
+#include <Q3PtrList>
+
+class Wire;
+
+/*!
+ * the wires of a list by position, horizontal ones by their y and
+ * vertical ones by their x coordinate. wires are expected to be appended
+ * to the list only. while listed, they may become longer or shorter
+ * (splitting and joining wires does so), but must not move sideways. if
+ * several wires match, the first one in the list is found, as by a walk
+ * through the list.
+ */
+class WireIndex {
+public:
+  WireIndex() : Built(false), Count(0) {}
+
+  void clear();
+  bool isBuilt() const { return Built; }
+  void build(Q3PtrList<Wire>*);
+  void insert(Wire*);
+  void remove(Wire*);
+  int  size() const { return Horizontal.size() + Vertical.size(); }
+
+  Wire* find(int x, int y) const;
+  Wire* selected(int x, int y) const;
+
+private:
+  struct Entry {
+    Wire *pw;
+    int Order;   // position in the list, growing with every insert()
+  };
+  typedef QMultiMap<int, Entry> Line;
+
+  static bool remove(Line&, int, Wire*);
+  static void first(Line const&, int, int, bool (*)(Wire*, int, int),
+                    int, int, const Entry*&);
+
+  Line Horizontal;   // by y
+  Line Vertical;     // by x
+  bool Built;
+  int  Count;
+};
+
+#endif